@@ -0,0 +1,268 @@
+/*
+  ==============================================================================
+
+   BackgroundSTFT - STFT на отдельном потоке с фиксированной задержкой
+   Аудио-поток только кладёт вход в lock-free FIFO и забирает готовый выход,
+   кадры FFT считает worker. Не успел к сроку - на выходе dry
+
+  ==============================================================================
+*/
+
+#include "BackgroundSTFT.h"
+#include <algorithm>
+
+//==============================================================================
+template <typename SampleType>
+BackgroundSTFT<SampleType>::BackgroundSTFT()
+    : juce::Thread ("VOID Spectral STFT")
+{
+}
+
+template <typename SampleType>
+BackgroundSTFT<SampleType>::~BackgroundSTFT()
+{
+    release();
+}
+
+//==============================================================================
+template <typename SampleType>
+void BackgroundSTFT<SampleType>::prepare (StreamingSTFT<SampleType>& newStft, int numChannels,
+                                          int maximumBlockSize, double sampleRate)
+{
+    release();
+
+    // Бюджет worker-а: не меньше двух буферов хоста (вход блока k нужен на выходе блока k + 2)
+    // и не меньше MIN_BUDGET_SEC - на малых буферах поток не успеет даже проснуться
+    budgetSamples = juce::jmax (2 * maximumBlockSize, (int) std::ceil (MIN_BUDGET_SEC * sampleRate));
+    latencySamples = newStft.getLatencySamples() + budgetSamples;
+
+    const auto fifoSize = budgetSamples + maximumBlockSize + (int) std::ceil (FIFO_HEADROOM_SEC * sampleRate) + 1;
+    inputFifo.setTotalSize (fifoSize);
+    outputFifo.setTotalSize (fifoSize);
+    inputRing.setSize (numChannels, fifoSize);
+    outputRing.setSize (numChannels, fifoSize);
+    workBuffer.setSize (numChannels, maximumBlockSize);
+    dryDelay.setSize (numChannels, latencySamples);
+
+    inputRing.clear();
+    outputRing.clear();
+    dryDelay.clear();
+    dryDelayPosition = 0;
+
+    outputCredit = budgetSamples;
+    outputDebt = 0;
+    flushing = false;
+    flushRequested.store (false);
+    missedSamples.store (0);
+
+    newStft.reset();
+    stft = &newStft;
+
+    startThread (juce::Thread::Priority::high);
+}
+
+template <typename SampleType>
+void BackgroundSTFT<SampleType>::release()
+{
+    stopThread (1000);
+    stft = nullptr;
+}
+
+template <typename SampleType>
+void BackgroundSTFT<SampleType>::reset() noexcept
+{
+    if (stft == nullptr)
+        return;
+
+    dryDelay.clear();
+    dryDelayPosition = 0;
+    requestFlush();
+}
+
+template <typename SampleType>
+void BackgroundSTFT<SampleType>::requestFlush() noexcept
+{
+    // Worker опустошит вход и сбросит STFT; до подтверждения на выходе только dry
+    flushing = true;
+    outputCredit = 0;
+    outputDebt = 0;
+    flushRequested.store (true, std::memory_order_release);
+}
+
+//==============================================================================
+template <typename SampleType>
+void BackgroundSTFT<SampleType>::process (juce::AudioBuffer<SampleType>& buffer, FrameProcessor* processor) noexcept
+{
+    auto numSamples = buffer.getNumSamples();
+    auto numChannels = juce::jmin (buffer.getNumChannels(), dryDelay.getNumChannels());
+
+    if (stft == nullptr || numSamples == 0)
+        return;
+
+    frameProcessor.store (processor, std::memory_order_release);
+
+    if (flushing)
+    {
+        discardOutput (outputFifo.getNumReady());
+
+        if (nonRealtime)
+            while (flushRequested.load (std::memory_order_acquire) && isThreadRunning() && ! threadShouldExit())
+                juce::Thread::yield();
+
+        // Сброс подтверждён: вход пуст, STFT чистый - всё, что ещё лежит в выходе, устарело.
+        // Первые fftSize семплов чистого STFT - тишина, а dry в кольце настоящий: их заменяет dry
+        if (! flushRequested.load (std::memory_order_acquire))
+        {
+            discardOutput (outputFifo.getNumReady());
+            flushing = false;
+            outputCredit = latencySamples;
+            outputDebt = stft->getLatencySamples();
+        }
+    }
+
+    if (! flushing)
+    {
+        if (inputFifo.getFreeSpace() >= numSamples)
+            writeToFifo (inputFifo, inputRing, buffer, numSamples);
+        else
+            requestFlush();  // worker безнадёжно отстал
+    }
+
+    // buffer -> dry с полной задержкой (обмен с кольцом, как MixStage::delayDry)
+    for (int start = 0; start < numSamples;)
+    {
+        auto count = juce::jmin (numSamples - start, latencySamples - dryDelayPosition);
+
+        for (int ch = 0; ch < numChannels; ++ch)
+        {
+            auto* data = buffer.getWritePointer (ch, start);
+            std::swap_ranges (data, data + count, dryDelay.getWritePointer (ch, dryDelayPosition));
+        }
+
+        start += count;
+        dryDelayPosition = (dryDelayPosition + count) % latencySamples;
+    }
+
+    if (flushing)
+    {
+        missedSamples.fetch_add (numSamples, std::memory_order_relaxed);
+        return;
+    }
+
+    // Начальный бюджет: wet для этих семплов ещё и не должен был прийти
+    auto position = juce::jmin (outputCredit, numSamples);
+    outputCredit -= position;
+
+    // Offline рендер идёт быстрее реального времени - срока нет, ждём worker
+    if (nonRealtime && position < numSamples)
+        while (outputFifo.getNumReady() < outputDebt + numSamples - position && isThreadRunning() && ! threadShouldExit())
+            juce::Thread::yield();
+
+    if (outputDebt > 0)
+        outputDebt -= discardOutput (outputDebt);
+
+    if (outputDebt == 0)
+    {
+        auto available = juce::jmin (outputFifo.getNumReady(), numSamples - position);
+        readFromFifo (outputFifo, outputRing, buffer, position, available);
+        position += available;
+    }
+
+    // Не успел к сроку - остаётся dry, опоздавший wet будет выброшен
+    if (position < numSamples)
+        fallBackToDry (numSamples - position);
+}
+
+template <typename SampleType>
+void BackgroundSTFT<SampleType>::fallBackToDry (int numSamples) noexcept
+{
+    outputDebt += numSamples;
+    missedSamples.fetch_add (numSamples, std::memory_order_relaxed);
+}
+
+template <typename SampleType>
+int BackgroundSTFT<SampleType>::discardOutput (int numSamples) noexcept
+{
+    int start1, size1, start2, size2;
+    outputFifo.prepareToRead (numSamples, start1, size1, start2, size2);
+    outputFifo.finishedRead (size1 + size2);
+    return size1 + size2;
+}
+
+//==============================================================================
+template <typename SampleType>
+void BackgroundSTFT<SampleType>::run()
+{
+    juce::ScopedNoDenormals noDenormals;
+    int idlePolls = 0;
+
+    while (! threadShouldExit())
+    {
+        if (flushRequested.load (std::memory_order_acquire))
+        {
+            inputFifo.finishedRead (inputFifo.getNumReady());
+            stft->reset();
+            flushRequested.store (false, std::memory_order_release);
+            idlePolls = 0;
+            continue;
+        }
+
+        const auto count = juce::jmin (inputFifo.getNumReady(), outputFifo.getFreeSpace(), workBuffer.getNumSamples());
+
+        // Аудио-поток worker не будит (никаких мьютексов и системных вызовов на его стороне).
+        // Долго без входа (стадия спит, транспорт стоит) - опрос реже; после сна стадия
+        // просыпается через reset(), а до подтверждения сброса на выходе и так dry
+        if (count == 0)
+        {
+            if (idlePolls < IDLE_POLLS_BEFORE_BACKOFF)
+                ++idlePolls;
+
+            wait (idlePolls < IDLE_POLLS_BEFORE_BACKOFF ? POLL_INTERVAL_MS : IDLE_POLL_INTERVAL_MS);
+            continue;
+        }
+
+        idlePolls = 0;
+
+        juce::AudioBuffer<SampleType> chunk (workBuffer.getArrayOfWritePointers(), workBuffer.getNumChannels(), count);
+        readFromFifo (inputFifo, inputRing, chunk, 0, count);
+        stft->process (chunk, frameProcessor.load (std::memory_order_acquire));
+        writeToFifo (outputFifo, outputRing, chunk, count);
+    }
+}
+
+//==============================================================================
+template <typename SampleType>
+void BackgroundSTFT<SampleType>::writeToFifo (juce::AbstractFifo& fifo, juce::AudioBuffer<SampleType>& ring,
+                                              const juce::AudioBuffer<SampleType>& source, int numSamples) noexcept
+{
+    int start1, size1, start2, size2;
+    fifo.prepareToWrite (numSamples, start1, size1, start2, size2);
+
+    for (int ch = 0; ch < juce::jmin (ring.getNumChannels(), source.getNumChannels()); ++ch)
+    {
+        if (size1 > 0)  ring.copyFrom (ch, start1, source, ch, 0, size1);
+        if (size2 > 0)  ring.copyFrom (ch, start2, source, ch, size1, size2);
+    }
+
+    fifo.finishedWrite (size1 + size2);
+}
+
+template <typename SampleType>
+void BackgroundSTFT<SampleType>::readFromFifo (juce::AbstractFifo& fifo, const juce::AudioBuffer<SampleType>& ring,
+                                               juce::AudioBuffer<SampleType>& dest, int destStart, int numSamples) noexcept
+{
+    int start1, size1, start2, size2;
+    fifo.prepareToRead (numSamples, start1, size1, start2, size2);
+
+    for (int ch = 0; ch < juce::jmin (ring.getNumChannels(), dest.getNumChannels()); ++ch)
+    {
+        if (size1 > 0)  dest.copyFrom (ch, destStart, ring, ch, start1, size1);
+        if (size2 > 0)  dest.copyFrom (ch, destStart + size1, ring, ch, start2, size2);
+    }
+
+    fifo.finishedRead (size1 + size2);
+}
+
+//==============================================================================
+template class BackgroundSTFT<float>;
+template class BackgroundSTFT<double>;
@@ -0,0 +1,119 @@
+/*
+  ==============================================================================
+
+   BackgroundSTFT - STFT на отдельном потоке с фиксированной задержкой
+   Аудио-поток только кладёт вход в lock-free FIFO и забирает готовый выход,
+   кадры FFT считает worker. Не успел к сроку - на выходе dry
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <juce_audio_processors/juce_audio_processors.h>
+#include <atomic>
+#include "StreamingSTFT.h"
+
+//==============================================================================
+/** Runs a StreamingSTFT on a worker thread.
+
+    With large frames the synchronous STFT does all of a hop's work in the one
+    callback where the hop completes, so the per-block cost is spiky. Here the
+    audio thread only copies samples: input goes into a FIFO, the worker
+    drains it through the STFT, and the result comes back through a second
+    FIFO.
+
+    The worker gets a fixed budget (getBudgetSamples(), at least two host
+    buffers) to deliver each sample. The total latency is therefore the
+    STFT's plus the budget, and it never changes while running. A sample
+    that is not ready when it is due is replaced by the input delayed by
+    the same total latency (dry, still aligned). The late wet sample is
+    dropped when it arrives. When the worker falls so far behind that the
+    input FIFO overflows, both sides flush and restart in sync.
+
+    The audio thread never wakes the worker; it polls every millisecond
+    and, after about 0.2 s without input, every 10 ms until input returns.
+
+    Offline (setNonRealtime) there is no deadline and the audio side waits
+    for the worker, so a render is always fully wet with the same latency.
+
+    The STFT belongs to the worker between prepare() and release(). The
+    FrameProcessor is called on the worker thread, so anything it reads
+    from the audio thread must be atomic.
+*/
+template <typename SampleType>
+class BackgroundSTFT : private juce::Thread
+{
+public:
+    using FrameProcessor = typename StreamingSTFT<SampleType>::FrameProcessor;
+
+    BackgroundSTFT();
+    ~BackgroundSTFT() override;
+
+    /** Starts the worker. stft must already be prepared for numChannels. */
+    void prepare (StreamingSTFT<SampleType>& stft, int numChannels, int maximumBlockSize, double sampleRate);
+
+    /** Stops the worker and hands the STFT back. */
+    void release();
+
+    bool isRunning() const noexcept  { return stft != nullptr; }
+
+    /** Clears the delay lines and asks the worker to flush. Safe on the audio thread. */
+    void reset() noexcept;
+
+    /** Audio thread: buffer is replaced by the processed signal, delayed by getLatencySamples(). */
+    void process (juce::AudioBuffer<SampleType>& buffer, FrameProcessor* processor) noexcept;
+
+    int getLatencySamples() const noexcept  { return latencySamples; }
+    int getBudgetSamples() const noexcept   { return budgetSamples; }
+
+    /** Offline rendering has no deadline: process() waits for the worker instead of falling back to dry. */
+    void setNonRealtime (bool isNonRealtime) noexcept  { nonRealtime = isNonRealtime; }
+
+    /** Output samples that fell back to dry since prepare() (worker missed its deadline). */
+    int getNumMissedSamples() const noexcept  { return missedSamples.load (std::memory_order_relaxed); }
+
+private:
+    void run() override;
+
+    void fallBackToDry (int numSamples) noexcept;
+    int discardOutput (int numSamples) noexcept;
+    void requestFlush() noexcept;
+
+    static void writeToFifo (juce::AbstractFifo& fifo, juce::AudioBuffer<SampleType>& ring,
+                             const juce::AudioBuffer<SampleType>& source, int numSamples) noexcept;
+    static void readFromFifo (juce::AbstractFifo& fifo, const juce::AudioBuffer<SampleType>& ring,
+                              juce::AudioBuffer<SampleType>& dest, int destStart, int numSamples) noexcept;
+
+    StreamingSTFT<SampleType>* stft = nullptr;
+    std::atomic<FrameProcessor*> frameProcessor { nullptr };
+
+    // SPSC: вход пишет аудио-поток, читает worker; выход - наоборот
+    juce::AbstractFifo inputFifo { 1 }, outputFifo { 1 };
+    juce::AudioBuffer<SampleType> inputRing, outputRing;
+    juce::AudioBuffer<SampleType> workBuffer;  // кусок, который worker прогоняет через STFT
+
+    // Dry с той же полной задержкой - подмена пропущенных семплов
+    juce::AudioBuffer<SampleType> dryDelay;
+    int dryDelayPosition = 0;
+
+    // Состояние аудио-потока
+    int outputCredit = 0;   // семплов dry до первого ожидаемого wet (начальный бюджет)
+    int outputDebt = 0;     // опоздавших wet семплов, которые надо выбросить
+    bool flushing = false;
+    bool nonRealtime = false;
+
+    std::atomic<bool> flushRequested { false };
+    std::atomic<int> missedSamples { 0 };
+
+    int budgetSamples = 0;
+    int latencySamples = 0;
+
+    static constexpr double MIN_BUDGET_SEC = 0.01;     // worker будится опросом раз в миллисекунду
+    static constexpr double FIFO_HEADROOM_SEC = 0.5;   // отставание, после которого - сброс
+    static constexpr int POLL_INTERVAL_MS = 1;
+    static constexpr int IDLE_POLL_INTERVAL_MS = 10;
+    static constexpr int IDLE_POLLS_BEFORE_BACKOFF = 200;  // ~0.2 с без входа - дольше любого буфера хоста
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (BackgroundSTFT)
+};
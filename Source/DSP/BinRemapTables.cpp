@@ -0,0 +1,153 @@
+/*
+  ==============================================================================
+
+   BinRemapTables - готовые таблицы перемаппирования бинов для формант-шифта
+   Индексы и доли интерполяции считаются в prepare() на сетке сдвигов,
+   в аудио-потоке остаётся только gather + lerp по таблице
+
+  ==============================================================================
+*/
+
+#include "BinRemapTables.h"
+
+#if JUCE_INTEL
+ #if JUCE_MSVC
+  #include <intrin.h>
+  #define VOID_TARGET_AVX2
+ #else
+  #include <immintrin.h>
+  #define VOID_TARGET_AVX2 __attribute__ ((target ("avx2")))
+ #endif
+#endif
+
+//==============================================================================
+void BinRemapTables::prepare (int newNumBins, float maxShiftSemitones, float semitoneStep)
+{
+    jassert (newNumBins > 0 && maxShiftSemitones >= 0.0f && semitoneStep > 0.0f);
+
+    numBins = newNumBins;
+    step = semitoneStep;
+    numTables = 2 * (int) std::ceil (maxShiftSemitones / semitoneStep) + 1;
+    maxShift = step * (float) (numTables / 2);
+
+    lowBins.resize ((size_t) (numTables * numBins));
+    fractions.resize ((size_t) (numTables * numBins));
+
+    for (int table = 0; table < numTables; ++table)
+    {
+        const auto semitones = (double) (step * (float) table - maxShift);
+        const auto inverseRatio = std::pow (2.0, -semitones / 12.0);
+
+        for (int bin = 0; bin < numBins; ++bin)
+        {
+            const auto sourceBin = bin * inverseRatio;
+            auto low = (int) sourceBin;
+            auto fraction = (float) (sourceBin - low);
+
+            // Выше Найквиста - пара нулей в конце source
+            if (low >= numBins)
+            {
+                low = numBins;
+                fraction = 0.0f;
+            }
+
+            lowBins[(size_t) (table * numBins + bin)] = low;
+            fractions[(size_t) (table * numBins + bin)] = fraction;
+        }
+    }
+}
+
+//==============================================================================
+void BinRemapTables::remap (const float* source, float semitones, float* dest, float* scratch) const noexcept
+{
+    // Позиция на сетке таблиц: целая часть - таблица, дробная - доля следующей
+    const auto position = juce::jlimit (0.0f, (float) (numTables - 1), (semitones + maxShift) / step);
+    const auto table = juce::jmin ((int) position, numTables - 2);
+    const auto blend = position - (float) table;
+
+    if (numTables == 1 || blend <= 0.0f)
+    {
+        const auto offset = (size_t) (juce::jmax (0, table) * numBins);
+        gatherLerp (source, lowBins.data() + offset, fractions.data() + offset, dest, numBins);
+        return;
+    }
+
+    const auto offset = (size_t) (table * numBins);
+    const auto nextOffset = offset + (size_t) numBins;
+
+    gatherLerp (source, lowBins.data() + offset, fractions.data() + offset, dest, numBins);
+    gatherLerp (source, lowBins.data() + nextOffset, fractions.data() + nextOffset, scratch, numBins);
+
+    juce::FloatVectorOperations::multiply (dest, 1.0f - blend, numBins);
+    juce::FloatVectorOperations::addWithMultiply (dest, scratch, blend, numBins);
+}
+
+//==============================================================================
+namespace
+{
+   #if JUCE_INTEL
+    // Собирается с AVX2 независимо от флагов сборки, вызывается только если CPU их умеет
+    VOID_TARGET_AVX2 void gatherLerpAvx2 (const float* source, const int* index, const float* fraction,
+                                          float* dest, int num) noexcept
+    {
+        int i = 0;
+
+        for (; i + 8 <= num; i += 8)
+        {
+            const auto indices = _mm256_loadu_si256 (reinterpret_cast<const __m256i*> (index + i));
+            const auto low = _mm256_i32gather_ps (source, indices, 4);
+            const auto high = _mm256_i32gather_ps (source + 1, indices, 4);
+            const auto t = _mm256_loadu_ps (fraction + i);
+
+            _mm256_storeu_ps (dest + i, _mm256_add_ps (low, _mm256_mul_ps (_mm256_sub_ps (high, low), t)));
+        }
+
+        for (; i < num; ++i)
+        {
+            const auto low = source[index[i]];
+            dest[i] = low + (source[index[i] + 1] - low) * fraction[i];
+        }
+    }
+
+    // Проверка CPU - один раз при загрузке плагина, не в аудио-потоке
+    const bool cpuHasAvx2 = juce::SystemStats::hasAVX2();
+   #endif
+}
+
+void BinRemapTables::gatherLerp (const float* source, const int* index, const float* fraction,
+                                 float* dest, int num) noexcept
+{
+   #if JUCE_INTEL
+    if (cpuHasAvx2)
+    {
+        gatherLerpAvx2 (source, index, fraction, dest, num);
+        return;
+    }
+   #endif
+
+    gatherLerpPairs (source, index, fraction, dest, num);
+}
+
+void BinRemapTables::gatherLerpPairs (const float* source, const int* index, const float* fraction,
+                                      float* dest, int num) noexcept
+{
+    constexpr int blockSize = 64;
+    float low[blockSize], high[blockSize];
+
+    for (int start = 0; start < num; start += blockSize)
+    {
+        const auto length = juce::jmin (blockSize, num - start);
+        const auto* blockIndex = index + start;
+
+        for (int i = 0; i < length; ++i)
+        {
+            low[i] = source[blockIndex[i]];
+            high[i] = source[blockIndex[i] + 1];
+        }
+
+        // dest = low + (high - low) * fraction
+        juce::FloatVectorOperations::subtract (high, low, length);
+        juce::FloatVectorOperations::multiply (high, fraction + start, length);
+        juce::FloatVectorOperations::add (dest + start, low, high, length);
+    }
+}
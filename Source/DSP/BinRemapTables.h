@@ -0,0 +1,68 @@
+/*
+  ==============================================================================
+
+   BinRemapTables - готовые таблицы перемаппирования бинов для формант-шифта
+   Индексы и доли интерполяции считаются в prepare() на сетке сдвигов,
+   в аудио-потоке остаётся только gather + lerp по таблице
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <juce_audio_processors/juce_audio_processors.h>
+#include <vector>
+
+//==============================================================================
+/** Spectral warp dest[b] = source[b / 2^(semitones / 12)], linearly interpolated.
+
+    One table of (low bin, fraction) pairs per point of a semitone grid covers
+    -maxShift..+maxShift. The high bin is always low + 1. Shifts between grid
+    points blend the results of the two neighbouring tables, so a modulated
+    shift (formant LFO) moves continuously without computing a single index
+    on the audio thread.
+
+    The map only depends on the shift and the number of bins, not on the
+    sample rate: a ratio moves bin b to bin b * ratio at any rate.
+*/
+class BinRemapTables
+{
+public:
+    BinRemapTables() = default;
+
+    /** Allocates and fills every table. */
+    void prepare (int numBins, float maxShiftSemitones, float semitoneStep);
+
+    /** source must hold getSourceSize() values: numBins magnitudes plus two zeros
+        (bins shifted in from above Nyquist read silence). scratch needs numBins floats.
+    */
+    void remap (const float* source, float semitones, float* dest, float* scratch) const noexcept;
+
+    int getNumBins() const noexcept     { return numBins; }
+    int getSourceSize() const noexcept  { return numBins + 2; }
+    int getNumTables() const noexcept   { return numTables; }
+
+    /** dest[i] = source[index[i]] + (source[index[i] + 1] - source[index[i]]) * fraction[i].
+        On x86 the CPU is checked once at startup: AVX2 gathers when it has them
+        (whatever the build targets), gatherLerpPairs() otherwise.
+    */
+    static void gatherLerp (const float* source, const int* index, const float* fraction,
+                            float* dest, int num) noexcept;
+
+    /** Same result without AVX2: the low / high pairs are gathered into a block
+        on the stack, the lerp runs over it with FloatVectorOperations (SSE / NEON).
+    */
+    static void gatherLerpPairs (const float* source, const int* index, const float* fraction,
+                                 float* dest, int num) noexcept;
+
+private:
+    std::vector<int> lowBins;      // numTables * numBins
+    std::vector<float> fractions;  // numTables * numBins
+
+    int numBins = 0;
+    int numTables = 0;
+    float maxShift = 0.0f;
+    float step = 1.0f;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (BinRemapTables)
+};
@@ -11,7 +11,8 @@
 #include <algorithm>
 
 //==============================================================================
-BinauralFlow::BinauralFlow()
+template <typename SampleType>
+BinauralFlow<SampleType>::BinauralFlow()
     : randomGenerator (std::random_device{}()),
       jitterDistribution (-MAX_JITTER_MS, MAX_JITTER_MS)
 {
@@ -35,7 +36,8 @@ BinauralFlow::BinauralFlow()
 }
 
 //==============================================================================
-void BinauralFlow::prepare (const juce::dsp::ProcessSpec& spec)
+template <typename SampleType>
+void BinauralFlow<SampleType>::prepare (const juce::dsp::ProcessSpec& spec)
 {
     sampleRate = spec.sampleRate;
     blockSize = (int) spec.maximumBlockSize;
@@ -45,10 +47,11 @@ void BinauralFlow::prepare (const juce::dsp::ProcessSpec& spec)
     // Используем два фильтра (L и R) для независимой обработки
     auto highPassCoeffs = Coeffs::makeHighPass (
         sampleRate, HIGH_PASS_FREQ, HIGH_PASS_Q);
-    *highPassChain.get<0>().state = *highPassCoeffs;
-    *highPassChain.get<1>().state = *highPassCoeffs;
+    *highPassChain.template get<0>().state = *highPassCoeffs;
+    *highPassChain.template get<1>().state = *highPassCoeffs;
     
     highPassChain.prepare (spec);
+    highBandBuffer.setSize (2, juce::jmax (1, blockSize));
     
     // Reset delay buffers
     delayBufferL.clear();
@@ -65,7 +68,8 @@ void BinauralFlow::prepare (const juce::dsp::ProcessSpec& spec)
 }
 
 //==============================================================================
-void BinauralFlow::reset()
+template <typename SampleType>
+void BinauralFlow<SampleType>::reset()
 {
     delayBufferL.clear();
     delayBufferR.clear();
@@ -88,26 +92,30 @@ void BinauralFlow::reset()
 }
 
 //==============================================================================
-void BinauralFlow::setFlow (float flow)
+template <typename SampleType>
+void BinauralFlow<SampleType>::setFlow (float flow)
 {
     flowParam = juce::jlimit (0.0f, 1.0f, flow);
     flowSmoother.setTargetValue (flowParam);
 }
 
-void BinauralFlow::setDepth (float depth)
+template <typename SampleType>
+void BinauralFlow<SampleType>::setDepth (float depth)
 {
     depthParam = juce::jlimit (0.0f, 1.0f, depth);
     depthSmoother.setTargetValue (depthParam);
 }
 
-void BinauralFlow::setGhost (float ghost)
+template <typename SampleType>
+void BinauralFlow<SampleType>::setGhost (float ghost)
 {
     ghostParam = juce::jlimit (0.0f, 1.0f, ghost);
     ghostSmoother.setTargetValue (ghostParam);
 }
 
 //==============================================================================
-float BinauralFlow::getDelayedSample (float* delayBuffer, int writePos, float delaySamples, int bufferSize)
+template <typename SampleType>
+SampleType BinauralFlow<SampleType>::getDelayedSample (SampleType* delayBuffer, int writePos, float delaySamples, int bufferSize)
 {
     // КРИТИЧНО: writePos указывает на позицию, куда мы ЗАПИШЕМ следующий семпл
     // Значит, последний записанный семпл находится в (writePos - 1 + bufferSize) % bufferSize
@@ -131,31 +139,38 @@ float BinauralFlow::getDelayedSample (float* delayBuffer, int writePos, float de
     int readPosNext = (readPosInt + 1) % bufferSize;
     
     // Безопасное чтение с проверкой границ
-    float sample1 = delayBuffer[readPosInt];
-    float sample2 = delayBuffer[readPosNext];
+    SampleType sample1 = delayBuffer[readPosInt];
+    SampleType sample2 = delayBuffer[readPosNext];
     
     // Линейная интерполяция
-    return sample1 + (sample2 - sample1) * fraction;
+    return sample1 + (sample2 - sample1) * static_cast<SampleType> (fraction);
 }
 
 //==============================================================================
-void BinauralFlow::applyPhaseModulation (float* leftChannel, float* rightChannel, int numSamples)
+template <typename SampleType>
+void BinauralFlow<SampleType>::applyPhaseModulation (SampleType* leftChannel, SampleType* rightChannel, int numSamples)
 {
     // Фазовая модуляция применяется только к верхам (5-12 кГц)
-    // Создаём временные буферы для фильтрованных верхов
-    juce::AudioBuffer<float> tempBuffer (2, numSamples);
-    tempBuffer.clear();
-    
-    // Копируем входной сигнал
-    for (int i = 0; i < numSamples; ++i)
+    // Верха фильтруются в буфер из prepare() - в аудио-потоке без аллокаций
+    const auto capacity = highBandBuffer.getNumSamples();
+    jassert (numSamples <= capacity);
+
+    if (numSamples > capacity)
     {
-        tempBuffer.setSample (0, i, leftChannel[i]);
-        tempBuffer.setSample (1, i, rightChannel[i]);
+        for (int start = 0; start < numSamples; start += capacity)
+            applyPhaseModulation (leftChannel + start, rightChannel + start, juce::jmin (capacity, numSamples - start));
+
+        return;
     }
+
+    // Копируем входной сигнал (view на preallocated буфер)
+    juce::AudioBuffer<SampleType> tempBuffer (highBandBuffer.getArrayOfWritePointers(), 2, numSamples);
+    tempBuffer.copyFrom (0, 0, leftChannel, numSamples);
+    tempBuffer.copyFrom (1, 0, rightChannel, numSamples);
     
     // Применяем high-pass фильтр (только верха проходят)
-    juce::dsp::AudioBlock<float> block (tempBuffer);
-    juce::dsp::ProcessContextReplacing<float> context (block);
+    juce::dsp::AudioBlock<SampleType> block (tempBuffer);
+    juce::dsp::ProcessContextReplacing<SampleType> context (block);
     highPassChain.process (context);
     
     // Получаем отфильтрованные верха
@@ -186,13 +201,13 @@ void BinauralFlow::applyPhaseModulation (float* leftChannel, float* rightChannel
         // Применяем к верхам (смешиваем с задержанной версией)
         if (delaySamplesL != 0 && sample >= std::abs (delaySamplesL))
         {
-            float delayedL = filteredL[sample - delaySamplesL];
+            auto delayedL = filteredL[sample - delaySamplesL];
             leftChannel[sample] = leftChannel[sample] - filteredL[sample] + delayedL * 0.3f;  // 30% смешивание
         }
         
         if (delaySamplesR != 0 && sample >= std::abs (delaySamplesR))
         {
-            float delayedR = filteredR[sample - delaySamplesR];
+            auto delayedR = filteredR[sample - delaySamplesR];
             rightChannel[sample] = rightChannel[sample] - filteredR[sample] + delayedR * 0.3f;
         }
         
@@ -204,7 +219,8 @@ void BinauralFlow::applyPhaseModulation (float* leftChannel, float* rightChannel
 }
 
 //==============================================================================
-void BinauralFlow::updateRandomJitter()
+template <typename SampleType>
+void BinauralFlow<SampleType>::updateRandomJitter()
 {
     // Обновляем случайный джиттер для естественности
     randomJitterL = jitterDistribution (randomGenerator);
@@ -212,7 +228,8 @@ void BinauralFlow::updateRandomJitter()
 }
 
 //==============================================================================
-void BinauralFlow::process (juce::AudioBuffer<float>& buffer)
+template <typename SampleType>
+void BinauralFlow<SampleType>::process (juce::AudioBuffer<SampleType>& buffer)
 {
     auto numSamples = buffer.getNumSamples();
     
@@ -310,13 +327,13 @@ void BinauralFlow::process (juce::AudioBuffer<float>& buffer)
         {
             if (delaySamplesL != 0)
             {
-                float delayedL = leftChannel[sample - delaySamplesL];
+                auto delayedL = leftChannel[sample - delaySamplesL];
                 leftChannel[sample] = leftChannel[sample] * 0.7f + delayedL * 0.3f;  // Смешивание для фазового сдвига
             }
             
             if (delaySamplesR != 0)
             {
-                float delayedR = rightChannel[sample - delaySamplesR];
+                auto delayedR = rightChannel[sample - delaySamplesR];
                 rightChannel[sample] = rightChannel[sample] * 0.7f + delayedR * 0.3f;
             }
         }
@@ -329,3 +346,14 @@ void BinauralFlow::process (juce::AudioBuffer<float>& buffer)
     }
 }
 
+//==============================================================================
+template <typename SampleType>
+bool BinauralFlow<SampleType>::isActive() const noexcept
+{
+    // При Flow = 0 process() пропускает сигнал без изменений
+    return flowParam >= 0.001f || flowSmoother.getCurrentValue() >= 0.001f;
+}
+
+//==============================================================================
+template class BinauralFlow<float>;
+template class BinauralFlow<double>;
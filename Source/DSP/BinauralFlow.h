@@ -22,6 +22,7 @@
 #include <random>
 
 //==============================================================================
+template <typename SampleType>
 class BinauralFlow
 {
 public:
@@ -30,7 +31,10 @@ public:
 
     void prepare (const juce::dsp::ProcessSpec& spec);
     void reset();
-    void process (juce::AudioBuffer<float>& buffer);
+    void process (juce::AudioBuffer<SampleType>& buffer);
+
+    // true, если process() сейчас меняет сигнал (иначе планировщик процессора пропускает модуль)
+    bool isActive() const noexcept;
 
     // Parameter control (normalized 0.0-1.0)
     void setFlow (float flow);        // 0.0 = static, 1.0 = full movement
@@ -39,10 +43,10 @@ public:
 
 private:
     // Fractional delay line с линейной интерполяцией
-    float getDelayedSample (float* delayBuffer, int writePos, float delaySamples, int bufferSize);
+    SampleType getDelayedSample (SampleType* delayBuffer, int writePos, float delaySamples, int bufferSize);
     
     // Фазовая модуляция для верхов (5-12 кГц)
-    void applyPhaseModulation (float* leftChannel, float* rightChannel, int numSamples);
+    void applyPhaseModulation (SampleType* leftChannel, SampleType* rightChannel, int numSamples);
     
     // Обновление случайного джиттера
     void updateRandomJitter();
@@ -50,7 +54,7 @@ private:
     // Delay buffers для L и R каналов
     // Размер: достаточно для максимальной задержки (1 мс при 48 кГц = 48 семплов)
     static constexpr int MAX_DELAY_SAMPLES = 64;  // 1.45 мс при 44.1 кГц
-    juce::AudioBuffer<float> delayBufferL, delayBufferR;
+    juce::AudioBuffer<SampleType> delayBufferL, delayBufferR;
     int writePosL = 0, writePosR = 0;
     
     // LFO для модуляции задержки
@@ -62,10 +66,11 @@ private:
     float phaseModPhase = 0.0f;
     
     // High-pass фильтр для фазовой модуляции (только верха 5-12 кГц)
-    using IIR = juce::dsp::IIR::Filter<float>;
-    using Coeffs = juce::dsp::IIR::Coefficients<float>;
+    using IIR = juce::dsp::IIR::Filter<SampleType>;
+    using Coeffs = juce::dsp::IIR::Coefficients<SampleType>;
     template<typename F> using Dup = juce::dsp::ProcessorDuplicator<F, Coeffs>;
     juce::dsp::ProcessorChain<Dup<IIR>, Dup<IIR>> highPassChain;  // L и R
+    juce::AudioBuffer<SampleType> highBandBuffer;  // Верха для фазовой модуляции (размер из prepare)
     
     // Случайный джиттер (обновляется раз в несколько секунд)
     float randomJitterL = 0.0f;
@@ -0,0 +1,254 @@
+/*
+  ==============================================================================
+
+   BiquadCascade - несколько биквадов последовательно за один проход
+   Все секции на семпл подряд, состояние в регистрах; стерео - L и R
+   в двух полосах одного SIMD регистра
+
+  ==============================================================================
+*/
+
+#include "BiquadCascade.h"
+
+#if JUCE_USE_SSE_INTRINSICS
+ #include <emmintrin.h>
+#elif JUCE_USE_ARM_NEON
+ #include <arm_neon.h>
+#endif
+
+namespace
+{
+    //==============================================================================
+    /** Пара (L, R) в одном регистре. Без SIMD - два скаляра, компилятор разложит сам. */
+    template <typename SampleType>
+    struct StereoLanes
+    {
+        struct Vector { SampleType l, r; };
+
+        static Vector set (SampleType l, SampleType r) noexcept   { return { l, r }; }
+        static Vector expand (SampleType x) noexcept              { return { x, x }; }
+        static Vector add (Vector a, Vector b) noexcept           { return { a.l + b.l, a.r + b.r }; }
+        static Vector sub (Vector a, Vector b) noexcept           { return { a.l - b.l, a.r - b.r }; }
+        static Vector mul (Vector a, Vector b) noexcept           { return { a.l * b.l, a.r * b.r }; }
+        static SampleType left (Vector v) noexcept                { return v.l; }
+        static SampleType right (Vector v) noexcept               { return v.r; }
+    };
+
+   #if JUCE_USE_SSE_INTRINSICS
+    template <>
+    struct StereoLanes<float>
+    {
+        // Заняты две нижние полосы из четырёх
+        using Vector = __m128;
+
+        static Vector set (float l, float r) noexcept   { return _mm_setr_ps (l, r, 0.0f, 0.0f); }
+        static Vector expand (float x) noexcept         { return _mm_set1_ps (x); }
+        static Vector add (Vector a, Vector b) noexcept { return _mm_add_ps (a, b); }
+        static Vector sub (Vector a, Vector b) noexcept { return _mm_sub_ps (a, b); }
+        static Vector mul (Vector a, Vector b) noexcept { return _mm_mul_ps (a, b); }
+        static float left (Vector v) noexcept           { return _mm_cvtss_f32 (v); }
+        static float right (Vector v) noexcept          { return _mm_cvtss_f32 (_mm_shuffle_ps (v, v, _MM_SHUFFLE (1, 1, 1, 1))); }
+    };
+
+    template <>
+    struct StereoLanes<double>
+    {
+        using Vector = __m128d;
+
+        static Vector set (double l, double r) noexcept { return _mm_setr_pd (l, r); }
+        static Vector expand (double x) noexcept        { return _mm_set1_pd (x); }
+        static Vector add (Vector a, Vector b) noexcept { return _mm_add_pd (a, b); }
+        static Vector sub (Vector a, Vector b) noexcept { return _mm_sub_pd (a, b); }
+        static Vector mul (Vector a, Vector b) noexcept { return _mm_mul_pd (a, b); }
+        static double left (Vector v) noexcept          { return _mm_cvtsd_f64 (v); }
+        static double right (Vector v) noexcept         { return _mm_cvtsd_f64 (_mm_unpackhi_pd (v, v)); }
+    };
+   #elif JUCE_USE_ARM_NEON
+    template <>
+    struct StereoLanes<float>
+    {
+        using Vector = float32x2_t;
+
+        static Vector set (float l, float r) noexcept   { return vset_lane_f32 (r, vdup_n_f32 (l), 1); }
+        static Vector expand (float x) noexcept         { return vdup_n_f32 (x); }
+        static Vector add (Vector a, Vector b) noexcept { return vadd_f32 (a, b); }
+        static Vector sub (Vector a, Vector b) noexcept { return vsub_f32 (a, b); }
+        static Vector mul (Vector a, Vector b) noexcept { return vmul_f32 (a, b); }
+        static float left (Vector v) noexcept           { return vget_lane_f32 (v, 0); }
+        static float right (Vector v) noexcept          { return vget_lane_f32 (v, 1); }
+    };
+
+    #if defined (__aarch64__) || defined (_M_ARM64)
+    template <>
+    struct StereoLanes<double>
+    {
+        using Vector = float64x2_t;
+
+        static Vector set (double l, double r) noexcept { return vsetq_lane_f64 (r, vdupq_n_f64 (l), 1); }
+        static Vector expand (double x) noexcept        { return vdupq_n_f64 (x); }
+        static Vector add (Vector a, Vector b) noexcept { return vaddq_f64 (a, b); }
+        static Vector sub (Vector a, Vector b) noexcept { return vsubq_f64 (a, b); }
+        static Vector mul (Vector a, Vector b) noexcept { return vmulq_f64 (a, b); }
+        static double left (Vector v) noexcept          { return vgetq_lane_f64 (v, 0); }
+        static double right (Vector v) noexcept         { return vgetq_lane_f64 (v, 1); }
+    };
+    #endif
+   #endif
+
+    // Как JUCE_SNAP_TO_ZERO в IIR::Filter: затухшее состояние не уходит в денормалы
+    template <typename SampleType>
+    void snapToZero (SampleType& x) noexcept
+    {
+        if (! (x < SampleType (-1.0e-8) || x > SampleType (1.0e-8)))
+            x = SampleType (0);
+    }
+}
+
+//==============================================================================
+template <typename SampleType, int NumSections>
+BiquadCascade<SampleType, NumSections>::BiquadCascade()
+{
+    // Пока коэффициенты не заданы - единичные секции
+    b0.fill (SampleType (1));
+    b1.fill (SampleType (0));
+    b2.fill (SampleType (0));
+    a1.fill (SampleType (0));
+    a2.fill (SampleType (0));
+}
+
+template <typename SampleType, int NumSections>
+void BiquadCascade<SampleType, NumSections>::prepare (int newNumChannels)
+{
+    numChannels = juce::jmax (0, newNumChannels);
+    state1.assign ((size_t) (numChannels * NumSections), SampleType (0));
+    state2.assign ((size_t) (numChannels * NumSections), SampleType (0));
+}
+
+template <typename SampleType, int NumSections>
+void BiquadCascade<SampleType, NumSections>::reset() noexcept
+{
+    std::fill (state1.begin(), state1.end(), SampleType (0));
+    std::fill (state2.begin(), state2.end(), SampleType (0));
+}
+
+template <typename SampleType, int NumSections>
+void BiquadCascade<SampleType, NumSections>::setCoefficients (int section, const Coefficients& c) noexcept
+{
+    jassert (juce::isPositiveAndBelow (section, NumSections));
+
+    const auto a0Inverse = SampleType (1) / c[3];
+    b0[(size_t) section] = c[0] * a0Inverse;
+    b1[(size_t) section] = c[1] * a0Inverse;
+    b2[(size_t) section] = c[2] * a0Inverse;
+    a1[(size_t) section] = c[4] * a0Inverse;
+    a2[(size_t) section] = c[5] * a0Inverse;
+}
+
+//==============================================================================
+template <typename SampleType, int NumSections>
+void BiquadCascade<SampleType, NumSections>::process (const juce::dsp::AudioBlock<SampleType>& block) noexcept
+{
+    const auto numSamples = (int) block.getNumSamples();
+    const auto channelsToProcess = juce::jmin ((int) block.getNumChannels(), numChannels);
+
+    if (channelsToProcess == 2)
+    {
+        processStereo (block.getChannelPointer (0), block.getChannelPointer (1), numSamples);
+    }
+    else
+    {
+        for (int ch = 0; ch < channelsToProcess; ++ch)
+            processMono (block.getChannelPointer ((size_t) ch), ch, numSamples);
+    }
+
+    for (auto& s : state1)
+        snapToZero (s);
+
+    for (auto& s : state2)
+        snapToZero (s);
+}
+
+template <typename SampleType, int NumSections>
+void BiquadCascade<SampleType, NumSections>::processStereo (SampleType* left, SampleType* right, int numSamples) noexcept
+{
+    using Lanes = StereoLanes<SampleType>;
+    using Vector = typename Lanes::Vector;
+
+    // Коэффициенты и состояние всех секций - локальные массивы фиксированного размера,
+    // после разворачивания циклов по секциям компилятор держит их в регистрах
+    Vector c0[NumSections], c1[NumSections], c2[NumSections], d1[NumSections], d2[NumSections];
+    Vector s1[NumSections], s2[NumSections];
+
+    for (int s = 0; s < NumSections; ++s)
+    {
+        c0[s] = Lanes::expand (b0[(size_t) s]);
+        c1[s] = Lanes::expand (b1[(size_t) s]);
+        c2[s] = Lanes::expand (b2[(size_t) s]);
+        d1[s] = Lanes::expand (a1[(size_t) s]);
+        d2[s] = Lanes::expand (a2[(size_t) s]);
+        s1[s] = Lanes::set (state1[(size_t) s], state1[(size_t) (NumSections + s)]);
+        s2[s] = Lanes::set (state2[(size_t) s], state2[(size_t) (NumSections + s)]);
+    }
+
+    for (int i = 0; i < numSamples; ++i)
+    {
+        auto x = Lanes::set (left[i], right[i]);
+
+        for (int s = 0; s < NumSections; ++s)
+        {
+            // Порядок операций как в IIR::Filter::processSample
+            const auto y = Lanes::add (Lanes::mul (c0[s], x), s1[s]);
+            s1[s] = Lanes::add (Lanes::sub (Lanes::mul (c1[s], x), Lanes::mul (d1[s], y)), s2[s]);
+            s2[s] = Lanes::sub (Lanes::mul (c2[s], x), Lanes::mul (d2[s], y));
+            x = y;
+        }
+
+        left[i] = Lanes::left (x);
+        right[i] = Lanes::right (x);
+    }
+
+    for (int s = 0; s < NumSections; ++s)
+    {
+        state1[(size_t) s] = Lanes::left (s1[s]);
+        state1[(size_t) (NumSections + s)] = Lanes::right (s1[s]);
+        state2[(size_t) s] = Lanes::left (s2[s]);
+        state2[(size_t) (NumSections + s)] = Lanes::right (s2[s]);
+    }
+}
+
+template <typename SampleType, int NumSections>
+void BiquadCascade<SampleType, NumSections>::processMono (SampleType* data, int channel, int numSamples) noexcept
+{
+    SampleType s1[NumSections], s2[NumSections];
+
+    for (int s = 0; s < NumSections; ++s)
+    {
+        s1[s] = state1[(size_t) (channel * NumSections + s)];
+        s2[s] = state2[(size_t) (channel * NumSections + s)];
+    }
+
+    for (int i = 0; i < numSamples; ++i)
+    {
+        auto x = data[i];
+
+        for (int s = 0; s < NumSections; ++s)
+        {
+            const auto y = b0[(size_t) s] * x + s1[s];
+            s1[s] = b1[(size_t) s] * x - a1[(size_t) s] * y + s2[s];
+            s2[s] = b2[(size_t) s] * x - a2[(size_t) s] * y;
+            x = y;
+        }
+
+        data[i] = x;
+    }
+
+    for (int s = 0; s < NumSections; ++s)
+    {
+        state1[(size_t) (channel * NumSections + s)] = s1[s];
+        state2[(size_t) (channel * NumSections + s)] = s2[s];
+    }
+}
+
+//==============================================================================
+template class BiquadCascade<float, 5>;
+template class BiquadCascade<double, 5>;
@@ -0,0 +1,59 @@
+/*
+  ==============================================================================
+
+   BiquadCascade - несколько биквадов последовательно за один проход
+   Все секции на семпл подряд, состояние в регистрах; стерео - L и R
+   в двух полосах одного SIMD регистра
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <juce_audio_processors/juce_audio_processors.h>
+#include <juce_dsp/juce_dsp.h>
+#include <array>
+#include <vector>
+
+//==============================================================================
+/** NumSections second-order sections in series, transposed direct form II.
+
+    Same arithmetic as a chain of juce::dsp::IIR::Filter (one per section and
+    channel), but fused: every sample runs through all sections before the
+    next one is read, so the signal makes a single pass over memory and the
+    filter state stays in registers for the whole block.
+
+    Two channels are processed together, L and R side by side in one SSE2 /
+    NEON register; other channel counts take the scalar path, one channel
+    at a time.
+*/
+template <typename SampleType, int NumSections>
+class BiquadCascade
+{
+public:
+    /** b0, b1, b2, a0, a1, a2 - the juce::dsp::IIR::ArrayCoefficients layout. */
+    using Coefficients = std::array<SampleType, 6>;
+
+    BiquadCascade();
+
+    void prepare (int numChannels);
+    void reset() noexcept;
+
+    /** Normalises by a0. Takes effect from the next processed sample; state is kept. */
+    void setCoefficients (int section, const Coefficients& coefficients) noexcept;
+
+    void process (const juce::dsp::AudioBlock<SampleType>& block) noexcept;
+
+private:
+    void processStereo (SampleType* left, SampleType* right, int numSamples) noexcept;
+    void processMono (SampleType* data, int channel, int numSamples) noexcept;
+
+    // По секциям: b0, b1, b2, a1, a2 (a0 = 1)
+    std::array<SampleType, NumSections> b0, b1, b2, a1, a2;
+
+    // TDF2: два элемента состояния на секцию и канал, [channel * NumSections + section]
+    std::vector<SampleType> state1, state2;
+    int numChannels = 0;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (BiquadCascade)
+};
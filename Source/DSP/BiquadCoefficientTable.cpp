@@ -0,0 +1,59 @@
+/*
+  ==============================================================================
+
+   BiquadCoefficientTable - готовые коэффициенты биквада на сетке параметра
+   Расчёт (тригонометрия, pow) - в prepare(), в аудио-потоке только
+   линейная интерполяция между соседними точками сетки
+
+  ==============================================================================
+*/
+
+#include "BiquadCoefficientTable.h"
+
+//==============================================================================
+template <typename SampleType>
+void BiquadCoefficientTable<SampleType>::prepare (float newMinValue, float maxValue, int numPoints, const Design& design)
+{
+    jassert (numPoints >= 2 && maxValue > newMinValue);
+
+    minValue = newMinValue;
+    pointsPerUnit = (float) (numPoints - 1) / (maxValue - newMinValue);
+    points.resize ((size_t) numPoints);
+
+    for (int i = 0; i < numPoints; ++i)
+    {
+        auto coefficients = design (minValue + (float) i / pointsPerUnit);
+
+        // Нормировка a0 = 1 до интерполяции: смешивать ненормированные наборы нельзя
+        const auto a0Inverse = SampleType (1) / coefficients[3];
+
+        for (auto& c : coefficients)
+            c *= a0Inverse;
+
+        points[(size_t) i] = coefficients;
+    }
+}
+
+//==============================================================================
+template <typename SampleType>
+typename BiquadCoefficientTable<SampleType>::Coefficients BiquadCoefficientTable<SampleType>::lookup (float value) const noexcept
+{
+    const auto lastPoint = (int) points.size() - 1;
+    const auto position = juce::jlimit (0.0f, (float) lastPoint, (value - minValue) * pointsPerUnit);
+    const auto index = juce::jmin ((int) position, lastPoint - 1);
+    const auto fraction = (SampleType) (position - (float) index);
+
+    const auto& low = points[(size_t) index];
+    const auto& high = points[(size_t) index + 1];
+
+    Coefficients result;
+
+    for (size_t i = 0; i < result.size(); ++i)
+        result[i] = low[i] + (high[i] - low[i]) * fraction;
+
+    return result;
+}
+
+//==============================================================================
+template class BiquadCoefficientTable<float>;
+template class BiquadCoefficientTable<double>;
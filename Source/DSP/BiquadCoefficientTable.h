@@ -0,0 +1,57 @@
+/*
+  ==============================================================================
+
+   BiquadCoefficientTable - готовые коэффициенты биквада на сетке параметра
+   Расчёт (тригонометрия, pow) - в prepare(), в аудио-потоке только
+   линейная интерполяция между соседними точками сетки
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <juce_audio_processors/juce_audio_processors.h>
+#include <array>
+#include <functional>
+#include <vector>
+
+//==============================================================================
+/** Coefficients of one biquad sampled over a parameter range.
+
+    prepare() runs the design function once per grid point and normalises
+    every result to a0 = 1. lookup() interpolates linearly between the two
+    neighbouring points, so a parameter sweep costs a handful of
+    multiply-adds per coefficient set and never allocates.
+
+    Interpolated filters are always stable: the stable (a1, a2) region is a
+    triangle, and a point between two stable filters stays inside it.
+
+    The table depends on the sample rate through the design function, so it
+    is rebuilt in every prepare() of its owner.
+*/
+template <typename SampleType>
+class BiquadCoefficientTable
+{
+public:
+    /** b0, b1, b2, a0, a1, a2 - the juce::dsp::IIR::ArrayCoefficients layout. */
+    using Coefficients = std::array<SampleType, 6>;
+    using Design = std::function<Coefficients (float)>;
+
+    BiquadCoefficientTable() = default;
+
+    /** Evaluates design at numPoints evenly spaced values from minValue to maxValue. */
+    void prepare (float minValue, float maxValue, int numPoints, const Design& design);
+
+    /** Coefficients for value, clamped to the table range. a0 is 1. */
+    Coefficients lookup (float value) const noexcept;
+
+    int getNumPoints() const noexcept  { return (int) points.size(); }
+
+private:
+    std::vector<Coefficients> points;
+
+    float minValue = 0.0f;
+    float pointsPerUnit = 0.0f;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (BiquadCoefficientTable)
+};
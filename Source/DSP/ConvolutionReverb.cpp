@@ -0,0 +1,251 @@
+/*
+  ==============================================================================
+
+   ConvolutionReverb - режим SpaceEngine с измеренным пространством (IR)
+   IR грузится и разбивается вне аудио-потока, аудио-поток забирает
+   готовую свёртку атомарной заменой указателя и делает кроссфейд
+
+  ==============================================================================
+*/
+
+#include "ConvolutionReverb.h"
+#include <cmath>
+
+//==============================================================================
+template <typename SampleType>
+ConvolutionReverb<SampleType>::~ConvolutionReverb()
+{
+    delete pending.exchange (nullptr);
+    delete retired.exchange (nullptr);
+}
+
+//==============================================================================
+template <typename SampleType>
+void ConvolutionReverb<SampleType>::prepare (const juce::dsp::ProcessSpec& spec)
+{
+    const juce::ScopedLock sl (loadLock);
+
+    sampleRate = spec.sampleRate;
+    isPrepared = true;
+    maximumBlockSize = juce::jmax (1, (int) spec.maximumBlockSize);
+    fadeBuffer.setSize (2, maximumBlockSize);
+    crossfadeSamples = juce::jmax (1, (int) std::lround (CROSSFADE_SEC * sampleRate));
+
+    const auto rampSamples = rampLengthSamples > 0 ? rampLengthSamples
+                                                   : juce::jmax (1, (int) std::lround (SMOOTH_TIME_SEC * sampleRate));
+    wetGain1.reset (rampSamples);
+    wetGain2.reset (rampSamples);
+
+    // Готовое для прежней частоты больше не годится - пересобираем из исходной IR
+    delete pending.exchange (nullptr);
+    delete retired.exchange (nullptr);
+    fadingOut.reset();
+    crossfadeRemaining = 0;
+
+    active = sourceIR.getNumSamples() > 0 ? createConvolver (sourceIR, sourceSampleRate) : nullptr;
+}
+
+template <typename SampleType>
+void ConvolutionReverb<SampleType>::release()
+{
+    const juce::ScopedLock sl (loadLock);
+
+    isPrepared = false;
+    delete pending.exchange (nullptr);
+    delete retired.exchange (nullptr);
+    fadingOut.reset();
+    active.reset();
+    crossfadeRemaining = 0;
+}
+
+template <typename SampleType>
+void ConvolutionReverb<SampleType>::reset()
+{
+    if (active != nullptr)
+        active->reset();
+
+    // Кроссфейд обрывается: хвост прежней IR сброшен вместе со всем остальным
+    if (fadingOut != nullptr && retired.load (std::memory_order_acquire) == nullptr)
+    {
+        retired.store (fadingOut.release(), std::memory_order_release);
+        crossfadeRemaining = 0;
+    }
+}
+
+template <typename SampleType>
+void ConvolutionReverb<SampleType>::setParameters (const Parameters& newParams)
+{
+    // Те же wet / width, что у FdnReverb: режимы переключаются без скачка громкости
+    const float wet = newParams.wetLevel * 3.0f;
+    wetGain1.setTargetValue (static_cast<SampleType> (0.5f * wet * (1.0f + newParams.width)));
+    wetGain2.setTargetValue (static_cast<SampleType> (0.5f * wet * (1.0f - newParams.width)));
+}
+
+//==============================================================================
+template <typename SampleType>
+void ConvolutionReverb<SampleType>::loadImpulseResponse (const juce::AudioBuffer<float>& ir, double irSampleRate)
+{
+    jassert (irSampleRate > 0.0);
+
+    const juce::ScopedLock sl (loadLock);
+
+    // Отыгравшая свёртка удаляется здесь, не в аудио-потоке
+    delete retired.exchange (nullptr);
+
+    sourceIR.makeCopyOf (ir);
+    sourceSampleRate = irSampleRate;
+
+    if (! isPrepared)
+        return;
+
+    // Не забранная аудио-потоком прежняя загрузка просто заменяется
+    delete pending.exchange (createConvolver (sourceIR, sourceSampleRate).release(), std::memory_order_acq_rel);
+}
+
+template <typename SampleType>
+void ConvolutionReverb<SampleType>::releaseRetired()
+{
+    // Без loadLock: слот забирается атомарно, аудио-поток кладёт в него только когда он пуст
+    delete retired.exchange (nullptr, std::memory_order_acq_rel);
+}
+
+template <typename SampleType>
+std::unique_ptr<PartitionedConvolution<SampleType>>
+ConvolutionReverb<SampleType>::createConvolver (const juce::AudioBuffer<float>& ir, double irSampleRate) const
+{
+    const auto numChannels = juce::jmin (2, ir.getNumChannels());
+
+    if (numChannels == 0 || ir.getNumSamples() == 0)
+        return nullptr;
+
+    // Пересчёт на текущую частоту (Lagrange), не длиннее MAX_IR_SECONDS
+    const auto ratio = irSampleRate / sampleRate;
+    const auto length = juce::jmin ((int) std::ceil (ir.getNumSamples() / ratio), (int) (MAX_IR_SECONDS * sampleRate));
+    juce::AudioBuffer<float> resampled (numChannels, juce::jmax (1, length));
+
+    for (int ch = 0; ch < numChannels; ++ch)
+    {
+        if (std::abs (ratio - 1.0) < 1.0e-9)
+        {
+            resampled.copyFrom (ch, 0, ir, ch, 0, juce::jmin (length, ir.getNumSamples()));
+        }
+        else
+        {
+            juce::LagrangeInterpolator interpolator;
+            interpolator.process (ratio, ir.getReadPointer (ch), resampled.getWritePointer (ch), length,
+                                  ir.getNumSamples(), 0);
+        }
+    }
+
+    // Тишина в конце IR - только лишние разбиения: обрезаем ниже -120 дБ от пика
+    const auto peak = resampled.getMagnitude (0, resampled.getNumSamples());
+    auto end = resampled.getNumSamples();
+
+    while (end > 1 && resampled.getMagnitude (end - 1, 1) <= peak * 1.0e-6f)
+        --end;
+
+    // Единичная энергия (в среднем по каналам): громкость не зависит от записи IR
+    double energy = 0.0;
+
+    for (int ch = 0; ch < numChannels; ++ch)
+        for (int i = 0; i < end; ++i)
+            energy += (double) resampled.getSample (ch, i) * resampled.getSample (ch, i);
+
+    juce::AudioBuffer<float> trimmed (numChannels, end);
+
+    for (int ch = 0; ch < numChannels; ++ch)
+        trimmed.copyFrom (ch, 0, resampled, ch, 0, end);
+
+    if (energy > 0.0)
+        trimmed.applyGain ((float) (1.0 / std::sqrt (energy / numChannels)));
+
+    return std::make_unique<Convolver> (trimmed);
+}
+
+//==============================================================================
+template <typename SampleType>
+double ConvolutionReverb<SampleType>::getTailLengthSeconds() const noexcept
+{
+    return active != nullptr ? active->getLengthSamples() / sampleRate : 0.0;
+}
+
+template <typename SampleType>
+void ConvolutionReverb<SampleType>::processStereo (SampleType* left, SampleType* right, int numSamples) noexcept
+{
+    // Новая IR - только когда прежний кроссфейд закончен и его свёртку загрузчик уже забрал:
+    // тогда место в retired к концу нового кроссфейда гарантированно свободно
+    if (fadingOut == nullptr && retired.load (std::memory_order_acquire) == nullptr)
+    {
+        if (auto* next = pending.exchange (nullptr, std::memory_order_acq_rel))
+        {
+            fadingOut = std::move (active);
+            active.reset (next);
+            crossfadeRemaining = fadingOut != nullptr ? crossfadeSamples : 0;
+        }
+    }
+
+    if (fadingOut != nullptr)
+        fadingOut->setNonRealtime (nonRealtime);
+
+    if (active == nullptr)
+    {
+        std::fill (left, left + numSamples, SampleType (0));
+        std::fill (right, right + numSamples, SampleType (0));
+        wetGain1.skip (numSamples);
+        wetGain2.skip (numSamples);
+        return;
+    }
+
+    active->setNonRealtime (nonRealtime);
+
+    for (int start = 0; start < numSamples; start += maximumBlockSize)
+    {
+        const auto length = juce::jmin (maximumBlockSize, numSamples - start);
+        auto* l = left + start;
+        auto* r = right + start;
+
+        if (fadingOut != nullptr)
+        {
+            auto* fadeL = fadeBuffer.getWritePointer (0);
+            auto* fadeR = fadeBuffer.getWritePointer (1);
+            std::copy (l, l + length, fadeL);
+            std::copy (r, r + length, fadeR);
+            fadingOut->processStereo (fadeL, fadeR, length);
+            active->processStereo (l, r, length);
+
+            // Линейный кроссфейд прежней IR в новую
+            for (int i = 0; i < length; ++i)
+            {
+                const auto oldGain = (SampleType) juce::jmax (0, crossfadeRemaining - i) / (SampleType) crossfadeSamples;
+                l[i] += (fadeL[i] - l[i]) * oldGain;
+                r[i] += (fadeR[i] - r[i]) * oldGain;
+            }
+
+            crossfadeRemaining -= length;
+
+            if (crossfadeRemaining <= 0)
+            {
+                crossfadeRemaining = 0;
+                retired.store (fadingOut.release(), std::memory_order_release);
+            }
+        }
+        else
+        {
+            active->processStereo (l, r, length);
+        }
+
+        for (int i = 0; i < length; ++i)
+        {
+            const auto wet1 = wetGain1.getNextValue();
+            const auto wet2 = wetGain2.getNextValue();
+            const auto outL = l[i], outR = r[i];
+
+            l[i] = outL * wet1 + outR * wet2;
+            r[i] = outR * wet1 + outL * wet2;
+        }
+    }
+}
+
+//==============================================================================
+template class ConvolutionReverb<float>;
+template class ConvolutionReverb<double>;
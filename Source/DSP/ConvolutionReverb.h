@@ -0,0 +1,118 @@
+/*
+  ==============================================================================
+
+   ConvolutionReverb - режим SpaceEngine с измеренным пространством (IR)
+   IR грузится и разбивается вне аудио-потока, аудио-поток забирает
+   готовую свёртку атомарной заменой указателя и делает кроссфейд
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <juce_audio_processors/juce_audio_processors.h>
+#include <juce_dsp/juce_dsp.h>
+#include <atomic>
+#include <memory>
+#include "PartitionedConvolution.h"
+
+//==============================================================================
+/** Convolution reverb with impulse responses swapped in lock-free.
+
+    loadImpulseResponse() (any thread but the audio thread) resamples the IR
+    to the current rate, normalises it to unit energy, builds a complete
+    PartitionedConvolution and publishes it through an atomic pointer. The
+    audio thread picks it up at the start of a block and crossfades from the
+    previous one over CROSSFADE_SEC; the previous one is then parked in a
+    second atomic slot and deleted by releaseRetired() (the processor's
+    timer), the next load or the destructor - the audio thread never
+    allocates or frees, nor starts or stops the convolution's late-tail
+    worker.
+
+    Output is 100% wet, with the same wet level / width mixing as FdnReverb.
+*/
+template <typename SampleType>
+class ConvolutionReverb
+{
+public:
+    struct Parameters
+    {
+        float wetLevel = 0.33f;
+        float width    = 1.0f;
+    };
+
+    ConvolutionReverb() = default;
+    ~ConvolutionReverb();
+
+    /** Audio stopped: rebuilds the current IR for the new rate and block size. */
+    void prepare (const juce::dsp::ProcessSpec& spec);
+    void reset();
+
+    /** Audio stopped: frees every built convolution (and its worker) but keeps the IR;
+        until the next prepare() loads only store it again.
+    */
+    void release();
+
+    void setParameters (const Parameters& newParams);
+
+    /** Ramp length of setParameters() in samples (0 - SMOOTH_TIME_SEC), as FdnReverb::setRampLength(). */
+    void setRampLength (int numSamples) noexcept  { rampLengthSamples = juce::jmax (0, numSamples); }
+
+    /** Not on the audio thread. ir: one or two channels at irSampleRate.
+        Before the first prepare() the IR is only kept - prepare() builds it.
+    */
+    void loadImpulseResponse (const juce::AudioBuffer<float>& ir, double irSampleRate);
+
+    /** Not on the audio thread: deletes the convolution that finished its crossfade
+        (and stops its worker). Call it periodically, e.g. from a message-thread timer.
+    */
+    void releaseRetired();
+
+    /** Audio thread: an IR is playing or waiting to be picked up by the next block. */
+    bool hasImpulseResponse() const noexcept
+    {
+        return active != nullptr || pending.load (std::memory_order_acquire) != nullptr;
+    }
+
+    /** Audio thread: length of the playing IR - the tail after the input goes silent. */
+    double getTailLengthSeconds() const noexcept;
+
+    void processStereo (SampleType* left, SampleType* right, int numSamples) noexcept;
+
+    /** Offline rendering: the late stage of the convolution is waited for, never dropped. */
+    void setNonRealtime (bool isNonRealtime) noexcept  { nonRealtime = isNonRealtime; }
+
+    static constexpr double MAX_IR_SECONDS = 30.0;
+
+private:
+    using Convolver = PartitionedConvolution<SampleType>;
+
+    std::unique_ptr<Convolver> createConvolver (const juce::AudioBuffer<float>& ir, double irSampleRate) const;
+
+    // Загрузчик (под loadLock): исходная IR - для пересборки при смене частоты
+    juce::CriticalSection loadLock;
+    juce::AudioBuffer<float> sourceIR;
+    double sourceSampleRate = 0.0;
+    bool isPrepared = false;  // до prepare() (и после release()) свёртку не строим
+
+    // Передача: загрузчик кладёт в pending, аудио-поток забирает; отыгравшая свёртка - в retired
+    std::atomic<Convolver*> pending { nullptr };
+    std::atomic<Convolver*> retired { nullptr };
+
+    // Аудио-поток
+    std::unique_ptr<Convolver> active, fadingOut;
+    juce::AudioBuffer<SampleType> fadeBuffer;  // выход fadingOut на время кроссфейда
+    int crossfadeSamples = 1, crossfadeRemaining = 0;
+    bool nonRealtime = false;
+
+    juce::LinearSmoothedValue<SampleType> wetGain1, wetGain2;
+    int rampLengthSamples = 0;  // 0 - SMOOTH_TIME_SEC
+
+    double sampleRate = 44100.0;
+    int maximumBlockSize = 512;
+
+    static constexpr double CROSSFADE_SEC = 0.05;
+    static constexpr double SMOOTH_TIME_SEC = 0.01;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (ConvolutionReverb)
+};
@@ -10,12 +10,14 @@
 #include "DynamicLayer.h"
 
 //==============================================================================
-DynamicLayer::DynamicLayer()
+template <typename SampleType>
+DynamicLayer<SampleType>::DynamicLayer()
 {
 }
 
 //==============================================================================
-void DynamicLayer::prepare (const juce::dsp::ProcessSpec& spec)
+template <typename SampleType>
+void DynamicLayer<SampleType>::prepare (const juce::dsp::ProcessSpec& spec)
 {
     sampleRate = spec.sampleRate;
     blockSize = (int) spec.maximumBlockSize;
@@ -23,16 +25,29 @@ void DynamicLayer::prepare (const juce::dsp::ProcessSpec& spec)
 }
 
 //==============================================================================
-void DynamicLayer::reset()
+template <typename SampleType>
+void DynamicLayer<SampleType>::reset()
 {
     // TODO: Reset compressors, saturators, limiters, etc.
 }
 
 //==============================================================================
-void DynamicLayer::process (juce::AudioBuffer<float>& buffer)
+template <typename SampleType>
+void DynamicLayer<SampleType>::process (juce::AudioBuffer<SampleType>& buffer)
 {
     // TODO: Implement dynamic processing (compression, saturation, soft distortion)
     // For now, pass through unchanged
     juce::ignoreUnused (buffer);
 }
 
+//==============================================================================
+template <typename SampleType>
+bool DynamicLayer<SampleType>::isActive() const noexcept
+{
+    // Заглушка - сигнал не меняется
+    return false;
+}
+
+//==============================================================================
+template class DynamicLayer<float>;
+template class DynamicLayer<double>;
@@ -0,0 +1,454 @@
+/*
+  ==============================================================================
+
+   FdnReverb - реверб на сети задержек с обратной связью (FDN) для SpaceEngine
+   16 линий, ортогональная матрица смешивания (Hadamard x Householder),
+   линии обновляются в SIMD регистрах
+
+  ==============================================================================
+*/
+
+#include "FdnReverb.h"
+#include <cmath>
+
+#if JUCE_USE_SSE_INTRINSICS
+ #include <emmintrin.h>
+#elif JUCE_USE_ARM_NEON
+ #include <arm_neon.h>
+#endif
+
+namespace
+{
+    //==============================================================================
+    /** Несколько соседних линий в одном регистре. Без SIMD - по одной, компилятор разложит сам. */
+    template <typename SampleType>
+    struct LineLanes
+    {
+        using Vector = SampleType;
+        static constexpr int width = 1;
+
+        static Vector load (const SampleType* p) noexcept     { return *p; }
+        static void store (SampleType* p, Vector v) noexcept  { *p = v; }
+        static Vector expand (SampleType x) noexcept          { return x; }
+        static Vector add (Vector a, Vector b) noexcept       { return a + b; }
+        static Vector sub (Vector a, Vector b) noexcept       { return a - b; }
+        static Vector mul (Vector a, Vector b) noexcept       { return a * b; }
+        static SampleType sum (Vector v) noexcept             { return v; }
+    };
+
+   #if JUCE_USE_SSE_INTRINSICS
+    template <>
+    struct LineLanes<float>
+    {
+        using Vector = __m128;
+        static constexpr int width = 4;
+
+        static Vector load (const float* p) noexcept      { return _mm_load_ps (p); }
+        static void store (float* p, Vector v) noexcept   { _mm_store_ps (p, v); }
+        static Vector expand (float x) noexcept           { return _mm_set1_ps (x); }
+        static Vector add (Vector a, Vector b) noexcept   { return _mm_add_ps (a, b); }
+        static Vector sub (Vector a, Vector b) noexcept   { return _mm_sub_ps (a, b); }
+        static Vector mul (Vector a, Vector b) noexcept   { return _mm_mul_ps (a, b); }
+
+        static float sum (Vector v) noexcept
+        {
+            const auto pairs = _mm_add_ps (v, _mm_movehl_ps (v, v));
+            return _mm_cvtss_f32 (_mm_add_ss (pairs, _mm_shuffle_ps (pairs, pairs, _MM_SHUFFLE (1, 1, 1, 1))));
+        }
+    };
+
+    template <>
+    struct LineLanes<double>
+    {
+        using Vector = __m128d;
+        static constexpr int width = 2;
+
+        static Vector load (const double* p) noexcept     { return _mm_load_pd (p); }
+        static void store (double* p, Vector v) noexcept  { _mm_store_pd (p, v); }
+        static Vector expand (double x) noexcept          { return _mm_set1_pd (x); }
+        static Vector add (Vector a, Vector b) noexcept   { return _mm_add_pd (a, b); }
+        static Vector sub (Vector a, Vector b) noexcept   { return _mm_sub_pd (a, b); }
+        static Vector mul (Vector a, Vector b) noexcept   { return _mm_mul_pd (a, b); }
+        static double sum (Vector v) noexcept             { return _mm_cvtsd_f64 (_mm_add_sd (v, _mm_unpackhi_pd (v, v))); }
+    };
+   #elif JUCE_USE_ARM_NEON
+    template <>
+    struct LineLanes<float>
+    {
+        using Vector = float32x4_t;
+        static constexpr int width = 4;
+
+        static Vector load (const float* p) noexcept      { return vld1q_f32 (p); }
+        static void store (float* p, Vector v) noexcept   { vst1q_f32 (p, v); }
+        static Vector expand (float x) noexcept           { return vdupq_n_f32 (x); }
+        static Vector add (Vector a, Vector b) noexcept   { return vaddq_f32 (a, b); }
+        static Vector sub (Vector a, Vector b) noexcept   { return vsubq_f32 (a, b); }
+        static Vector mul (Vector a, Vector b) noexcept   { return vmulq_f32 (a, b); }
+
+        static float sum (Vector v) noexcept
+        {
+            const auto pairs = vadd_f32 (vget_low_f32 (v), vget_high_f32 (v));
+            return vget_lane_f32 (vpadd_f32 (pairs, pairs), 0);
+        }
+    };
+
+    #if defined (__aarch64__) || defined (_M_ARM64)
+    template <>
+    struct LineLanes<double>
+    {
+        using Vector = float64x2_t;
+        static constexpr int width = 2;
+
+        static Vector load (const double* p) noexcept     { return vld1q_f64 (p); }
+        static void store (double* p, Vector v) noexcept  { vst1q_f64 (p, v); }
+        static Vector expand (double x) noexcept          { return vdupq_n_f64 (x); }
+        static Vector add (Vector a, Vector b) noexcept   { return vaddq_f64 (a, b); }
+        static Vector sub (Vector a, Vector b) noexcept   { return vsubq_f64 (a, b); }
+        static Vector mul (Vector a, Vector b) noexcept   { return vmulq_f64 (a, b); }
+        static double sum (Vector v) noexcept             { return vaddvq_f64 (v); }
+    };
+    #endif
+   #endif
+
+    bool isPrime (int n) noexcept
+    {
+        if (n < 2)
+            return false;
+
+        for (int d = 2; d * d <= n; ++d)
+            if (n % d == 0)
+                return false;
+
+        return true;
+    }
+
+    // Знак строки row матрицы Адамара (Sylvester) в столбце column
+    int hadamardSign (int row, int column) noexcept
+    {
+        int bits = row & column, parity = 0;
+
+        for (; bits != 0; bits &= bits - 1)
+            parity ^= 1;
+
+        return parity != 0 ? -1 : 1;
+    }
+
+    // Длины линий: геометрически от 23 до 89 мс, каждая - следующее простое число семплов
+    constexpr double SHORTEST_LINE_MS = 23.0;
+    constexpr double LONGEST_LINE_MS = 89.0;
+
+    // Уровень wet примерно как у FreeverbCore при тех же wetLevel и времени спада
+    constexpr double INPUT_GAIN = 1.0;
+}
+
+//==============================================================================
+template <typename SampleType>
+FdnReverb<SampleType>::FdnReverb()
+{
+    // Вход: L - в чётные линии, R - в нечётные, знаки чередуются парами; нормы по 1
+    // Выход: две ортогональные строки Адамара - L и R хвоста не коррелированы
+    const auto inputNorm = 1.0 / std::sqrt (NUM_LINES / 2.0);
+    const auto outputNorm = 1.0 / std::sqrt ((double) NUM_LINES);
+
+    for (int i = 0; i < NUM_LINES; ++i)
+    {
+        const auto sign = (i / 2) % 2 == 0 ? 1.0 : -1.0;
+        inputLeft[(size_t) i]   = (SampleType) (i % 2 == 0 ? sign * inputNorm : 0.0);
+        inputRight[(size_t) i]  = (SampleType) (i % 2 == 1 ? sign * inputNorm : 0.0);
+        outputLeft[(size_t) i]  = (SampleType) (hadamardSign (5, i) * outputNorm);
+        outputRight[(size_t) i] = (SampleType) (hadamardSign (10, i) * outputNorm);
+    }
+
+    setParameters (Parameters());
+    setSampleRate (44100.0);
+}
+
+//==============================================================================
+template <typename SampleType>
+void FdnReverb<SampleType>::prepare (const juce::dsp::ProcessSpec& spec)
+{
+    setSampleRate (spec.sampleRate);
+    reset();
+}
+
+template <typename SampleType>
+void FdnReverb<SampleType>::reset()
+{
+    std::fill (delayMemory.begin(), delayMemory.end(), SampleType (0));
+    lowpassState.fill (SampleType (0));
+    linePositions.fill (0);
+}
+
+//==============================================================================
+template <typename SampleType>
+void FdnReverb<SampleType>::setSampleRate (double newSampleRate)
+{
+    jassert (newSampleRate > 0);
+    sampleRate = newSampleRate;
+
+    int totalLength = 0;
+
+    for (int i = 0; i < NUM_LINES; ++i)
+    {
+        const auto ms = SHORTEST_LINE_MS * std::pow (LONGEST_LINE_MS / SHORTEST_LINE_MS, (double) i / (NUM_LINES - 1));
+        auto length = juce::jmax (2, (int) std::lround (ms * 0.001 * sampleRate));
+
+        while (! isPrime (length))
+            ++length;
+
+        lineLengths[(size_t) i] = length;
+        lineOffsets[(size_t) i] = totalLength;
+        totalLength += length;
+    }
+
+    delayMemory.assign ((size_t) totalLength, SampleType (0));
+    linePositions.fill (0);
+
+    // Одна длина рампы на все параметры - усиления линий идут вместе с damping и wet
+    gainRampSamples = rampLengthSamples > 0 ? rampLengthSamples
+                                            : juce::jmax (1, (int) std::lround (SMOOTH_TIME_SEC * newSampleRate));
+    damping .reset (gainRampSamples);
+    dryGain .reset (gainRampSamples);
+    wetGain1.reset (gainRampSamples);
+    wetGain2.reset (gainRampSamples);
+
+    // Новые длины линий и частота: усиления и damping пересчитываются сразу, без рампы
+    setParameters (parameters);
+    damping.setCurrentAndTargetValue (damping.getTargetValue());
+    updateLineGains();
+    lineGains = lineGainTargets;
+    gainRampRemaining = 0;
+}
+
+//==============================================================================
+template <typename SampleType>
+void FdnReverb<SampleType>::setParameters (const Parameters& newParams)
+{
+    const float wetScaleFactor = 3.0f;
+    const float dryScaleFactor = 2.0f;
+
+    const float wet = newParams.wetLevel * wetScaleFactor;
+    dryGain .setTargetValue (static_cast<SampleType> (newParams.dryLevel * dryScaleFactor));
+    wetGain1.setTargetValue (static_cast<SampleType> (0.5f * wet * (1.0f + newParams.width)));
+    wetGain2.setTargetValue (static_cast<SampleType> (0.5f * wet * (1.0f - newParams.width)));
+
+    // Коэффициент однополюсника как у Freeverb (damping * 0.4) при 44.1 кГц; на других
+    // частотах - тот же срез: d^(44100 / fs)
+    const auto damp = std::pow ((double) juce::jlimit (0.0f, 1.0f, newParams.damping) * 0.4, REFERENCE_RATE / sampleRate);
+    damping.setTargetValue (static_cast<SampleType> (damp));
+
+    const bool decayChanged = newParams.decaySeconds != parameters.decaySeconds;
+    parameters = newParams;
+
+    if (decayChanged)
+        updateLineGains();
+}
+
+template <typename SampleType>
+void FdnReverb<SampleType>::updateLineGains() noexcept
+{
+    // -60 дБ за decaySeconds: за один проход линии длиной L - 10^(-3 L / (T fs)) = exp (L * logGain)
+    const auto decaySamples = juce::jmax (1.0e-3, (double) parameters.decaySeconds) * sampleRate;
+    const auto logGain = -3.0 * std::log (10.0) / decaySamples;
+
+    for (int i = 0; i < NUM_LINES; ++i)
+    {
+        lineGainTargets[(size_t) i] = (SampleType) std::exp (lineLengths[(size_t) i] * logGain);
+        lineGainSteps[(size_t) i] = (lineGainTargets[(size_t) i] - lineGains[(size_t) i]) / (SampleType) gainRampSamples;
+    }
+
+    gainRampRemaining = gainRampSamples;
+}
+
+//==============================================================================
+template <typename SampleType>
+double FdnReverb<SampleType>::getDecayTimeSeconds (double decayDb) const noexcept
+{
+    // Все линии затухают одинаково: decaySeconds на 60 дБ
+    return decayDb / 60.0 * (double) parameters.decaySeconds;
+}
+
+template <typename SampleType>
+double FdnReverb<SampleType>::getPeakGainDb() const noexcept
+{
+    // Верхняя оценка: матрица ортогональна, поэтому петля усиливает не больше 1 / (1 - g),
+    // g - наибольшее усиление линии. Вход (L, R) на линиях - норма до sqrt 2, выход - норма 1
+    const auto longest = (double) lineLengths[(size_t) NUM_LINES - 1];
+    const auto maxGain = std::pow (10.0, -3.0 * longest / (juce::jmax (1.0e-3, (double) parameters.decaySeconds) * sampleRate));
+    const auto loopGain = std::sqrt (2.0) * INPUT_GAIN / (1.0 - maxGain);
+    const auto wetGain = juce::jmax (1.0e-6, 3.0 * (double) parameters.wetLevel);
+    return 20.0 * std::log10 (loopGain * wetGain);
+}
+
+//==============================================================================
+template <typename SampleType>
+void FdnReverb<SampleType>::processStereo (SampleType* left, SampleType* right, int numSamples) noexcept
+{
+    jassert (left != nullptr && right != nullptr);
+    juce::ScopedNoDenormals noDenormals;
+
+    // Линия, записанная в момент t, читается не раньше t + shortest: в пределах куска
+    // короче самой короткой линии чтения не зависят от записей. Поэтому выходы линий
+    // читаются кусками подряд, а не по семплу с проверкой позиции
+    const auto chunkLength = juce::jmin (MAX_CHUNK, lineLengths[0]);
+
+    for (int start = 0; start < numSamples; start += chunkLength)
+    {
+        const auto length = juce::jmin (chunkLength, numSamples - start);
+
+        transferLines<true> (length);
+        processChunk (left + start, right + start, length);
+        transferLines<false> (length);
+
+        for (int j = 0; j < NUM_LINES; ++j)
+        {
+            auto& position = linePositions[(size_t) j];
+            position += length;
+
+            if (position >= lineLengths[(size_t) j])
+                position -= lineLengths[(size_t) j];
+        }
+    }
+}
+
+template <typename SampleType>
+template <bool read>
+void FdnReverb<SampleType>::transferLines (int length) noexcept
+{
+    // frames[t * NUM_LINES + j] <-> линия j; кольцо разрезается максимум на два куска
+    for (int j = 0; j < NUM_LINES; ++j)
+    {
+        auto* line = delayMemory.data() + lineOffsets[(size_t) j];
+        const auto position = linePositions[(size_t) j];
+        const auto firstPart = juce::jmin (length, lineLengths[(size_t) j] - position);
+        auto* frame = frames.data() + j;
+
+        auto copy = [&frame] (SampleType* run, int count)
+        {
+            for (int t = 0; t < count; ++t, frame += NUM_LINES)
+            {
+                if constexpr (read)
+                    *frame = run[t];
+                else
+                    run[t] = *frame;
+            }
+        };
+
+        copy (line + position, firstPart);
+        copy (line, length - firstPart);
+    }
+}
+
+template <typename SampleType>
+void FdnReverb<SampleType>::processChunk (SampleType* left, SampleType* right, int length) noexcept
+{
+    using Lanes = LineLanes<SampleType>;
+    using Vector = typename Lanes::Vector;
+    constexpr int width = Lanes::width;
+    constexpr int numVectors = NUM_LINES / width;
+    constexpr int vectorsPerGroup = 4 / width;  // группа Адамара - 4 соседние линии
+
+    static_assert (NUM_LINES == 16 && 4 % width == 0, "Hadamard 4 x 4 over groups of 4 lines");
+
+    const auto half = Lanes::expand (SampleType (0.5));
+    const auto inputGain = (SampleType) INPUT_GAIN;
+    const auto householderScale = SampleType (-2.0 / NUM_LINES);
+
+    // Состояние - в регистрах на весь кусок
+    Vector state[numVectors], gains[numVectors], steps[numVectors];
+    Vector inLeft[numVectors], inRight[numVectors], outLeft[numVectors], outRight[numVectors];
+
+    for (int v = 0; v < numVectors; ++v)
+    {
+        state[v]    = Lanes::load (lowpassState.data() + v * width);
+        gains[v]    = Lanes::load (lineGains.data() + v * width);
+        steps[v]    = Lanes::load (lineGainSteps.data() + v * width);
+        inLeft[v]   = Lanes::load (inputLeft.data() + v * width);
+        inRight[v]  = Lanes::load (inputRight.data() + v * width);
+        outLeft[v]  = Lanes::load (outputLeft.data() + v * width);
+        outRight[v] = Lanes::load (outputRight.data() + v * width);
+    }
+
+    for (int i = 0; i < length; ++i)
+    {
+        auto* frame = frames.data() + i * NUM_LINES;
+
+        if (gainRampRemaining > 0)
+        {
+            if (--gainRampRemaining == 0)
+                for (int v = 0; v < numVectors; ++v)
+                    gains[v] = Lanes::load (lineGainTargets.data() + v * width);
+            else
+                for (int v = 0; v < numVectors; ++v)
+                    gains[v] = Lanes::add (gains[v], steps[v]);
+        }
+
+        const auto damp = Lanes::expand (damping.getNextValue());
+        auto tailL = Lanes::expand (SampleType (0)), tailR = tailL;
+        Vector x[numVectors];
+
+        // Выход хвоста, однополюсный ФНЧ и усиление линии
+        for (int v = 0; v < numVectors; ++v)
+        {
+            const auto y = Lanes::load (frame + v * width);
+            tailL = Lanes::add (tailL, Lanes::mul (y, outLeft[v]));
+            tailR = Lanes::add (tailR, Lanes::mul (y, outRight[v]));
+
+            state[v] = Lanes::add (y, Lanes::mul (damp, Lanes::sub (state[v], y)));
+            x[v] = Lanes::mul (state[v], gains[v]);
+        }
+
+        // Адамар 4 x 4 между группами: линия 4g + k смешивается с 4g' + k
+        for (int k = 0; k < vectorsPerGroup; ++k)
+        {
+            auto& a = x[k];
+            auto& b = x[vectorsPerGroup + k];
+            auto& c = x[2 * vectorsPerGroup + k];
+            auto& d = x[3 * vectorsPerGroup + k];
+
+            const auto s1 = Lanes::add (a, b), d1 = Lanes::sub (a, b);
+            const auto s2 = Lanes::add (c, d), d2 = Lanes::sub (c, d);
+            a = Lanes::mul (Lanes::add (s1, s2), half);
+            b = Lanes::mul (Lanes::add (d1, d2), half);
+            c = Lanes::mul (Lanes::sub (s1, s2), half);
+            d = Lanes::mul (Lanes::sub (d1, d2), half);
+        }
+
+        // Householder I - 2/N * 1 1^T: одна горизонтальная сумма на все линии
+        auto total = x[0];
+        for (int v = 1; v < numVectors; ++v)
+            total = Lanes::add (total, x[v]);
+
+        const auto reflection = Lanes::expand (Lanes::sum (total) * householderScale);
+        const auto inL = Lanes::expand (left[i] * inputGain);
+        const auto inR = Lanes::expand (right[i] * inputGain);
+
+        // Вход линий пишется на место их выхода - transferLines<false> унесёт его в линии
+        for (int v = 0; v < numVectors; ++v)
+        {
+            auto feedback = Lanes::add (x[v], reflection);
+            feedback = Lanes::add (feedback, Lanes::mul (inL, inLeft[v]));
+            feedback = Lanes::add (feedback, Lanes::mul (inR, inRight[v]));
+            Lanes::store (frame + v * width, feedback);
+        }
+
+        const auto outL = Lanes::sum (tailL);
+        const auto outR = Lanes::sum (tailR);
+        const auto dry  = dryGain.getNextValue();
+        const auto wet1 = wetGain1.getNextValue();
+        const auto wet2 = wetGain2.getNextValue();
+
+        left[i]  = outL * wet1 + outR * wet2 + left[i]  * dry;
+        right[i] = outR * wet1 + outL * wet2 + right[i] * dry;
+    }
+
+    for (int v = 0; v < numVectors; ++v)
+    {
+        Lanes::store (lowpassState.data() + v * width, state[v]);
+        Lanes::store (lineGains.data() + v * width, gains[v]);
+    }
+}
+
+//==============================================================================
+template class FdnReverb<float>;
+template class FdnReverb<double>;
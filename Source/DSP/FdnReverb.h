@@ -0,0 +1,117 @@
+/*
+  ==============================================================================
+
+   FdnReverb - реверб на сети задержек с обратной связью (FDN) для SpaceEngine
+   16 линий, ортогональная матрица смешивания (Hadamard x Householder),
+   линии обновляются в SIMD регистрах
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <juce_audio_processors/juce_audio_processors.h>
+#include <juce_dsp/juce_dsp.h>
+#include <array>
+#include <vector>
+
+//==============================================================================
+/** Stereo feedback delay network reverb.
+
+    Sixteen delay lines of prime lengths (23-89 ms) feed back into
+    each other through an orthogonal matrix: a 4x4 Hadamard across groups of
+    four lines, then a 16x16 Householder reflection. Both need only vector
+    adds and one horizontal sum, so the loop runs four (float) or two
+    (double) lines per SSE2 / NEON register. Each line has a one-pole
+    lowpass (damping) and a gain set from its length, so every line - and
+    the whole tail - falls by 60 dB in exactly decaySeconds at low
+    frequencies, up to 20 s and beyond.
+
+    Samples are processed in chunks shorter than the shortest line: a line
+    written at t is not read before t + its length, so each chunk first
+    copies the line outputs out in one run per line, runs the loop on the
+    copy, and writes the new inputs back the same way.
+
+    The matrix is the same for every register width, so float and double
+    produce the same reverb. Output is 100% wet plus the dry level.
+*/
+template <typename SampleType>
+class FdnReverb
+{
+public:
+    struct Parameters
+    {
+        float decaySeconds = 2.0f;  // RT60 на низких частотах
+        float damping      = 0.5f;  // 0 - без фильтра, 1 - самый тёмный хвост
+        float wetLevel     = 0.33f;
+        float dryLevel     = 0.4f;
+        float width        = 1.0f;
+    };
+
+    static constexpr int NUM_LINES = 16;
+
+    FdnReverb();
+    ~FdnReverb() = default;
+
+    void prepare (const juce::dsp::ProcessSpec& spec);
+    void reset();
+
+    /** Every parameter - decay (line gains), damping, wet, dry, width - ramps
+        linearly to the new value over the ramp length, one step per sample.
+    */
+    void setParameters (const Parameters& newParams);
+    const Parameters& getParameters() const noexcept { return parameters; }
+
+    /** Ramp length in samples (0 - SMOOTH_TIME_SEC), applied by the next prepare().
+        A caller that sets parameters every N samples sets N: the ramps then join
+        into one continuous per-sample curve instead of lagging behind it.
+    */
+    void setRampLength (int numSamples) noexcept  { rampLengthSamples = juce::jmax (0, numSamples); }
+
+    /** Time for the reverb tail to fall by decayDb at the current settings. */
+    double getDecayTimeSeconds (double decayDb) const noexcept;
+
+    /** Upper bound of the input-to-output gain (build-up of the loop times the wet gain). */
+    double getPeakGainDb() const noexcept;
+
+    void processStereo (SampleType* left, SampleType* right, int numSamples) noexcept;
+
+private:
+    void setSampleRate (double newSampleRate);
+    void updateLineGains() noexcept;
+
+    /** read: выходы линий -> frames, иначе frames -> линии; позиции не сдвигает. */
+    template <bool read>
+    void transferLines (int length) noexcept;
+
+    /** Петля FDN по frames: на входе выходы линий, на выходе - их новые входы. */
+    void processChunk (SampleType* left, SampleType* right, int length) noexcept;
+
+    Parameters parameters;
+    double sampleRate = 44100.0;
+
+    // Все линии в одном буфере: линия i - [lineOffsets[i], lineOffsets[i] + lineLengths[i])
+    std::vector<SampleType> delayMemory;
+    std::array<int, NUM_LINES> lineOffsets {}, lineLengths {}, linePositions {};
+
+    // Векторы по линиям - выровнены под SIMD загрузку
+    alignas (16) std::array<SampleType, NUM_LINES> lineGains {};       // текущие, идут к lineGainTargets
+    alignas (16) std::array<SampleType, NUM_LINES> lineGainSteps {};
+    alignas (16) std::array<SampleType, NUM_LINES> lineGainTargets {};
+    alignas (16) std::array<SampleType, NUM_LINES> lowpassState {};
+    alignas (16) std::array<SampleType, NUM_LINES> inputLeft {}, inputRight {};
+    alignas (16) std::array<SampleType, NUM_LINES> outputLeft {}, outputRight {};
+    int gainRampSamples = 0, gainRampRemaining = 0;
+    int rampLengthSamples = 0;  // 0 - SMOOTH_TIME_SEC
+
+    // Кусок обработки: [семпл][линия], строка - NUM_LINES подряд для SIMD загрузки
+    static constexpr int MAX_CHUNK = 64;
+    alignas (16) std::array<SampleType, MAX_CHUNK * NUM_LINES> frames {};
+
+    juce::LinearSmoothedValue<SampleType> damping, dryGain, wetGain1, wetGain2;
+
+    static constexpr double SMOOTH_TIME_SEC = 0.01;
+    static constexpr double REFERENCE_RATE = 44100.0;  // damping задан при этой частоте (как в Freeverb)
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (FdnReverb)
+};
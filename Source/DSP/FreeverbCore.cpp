@@ -0,0 +1,268 @@
+/*
+  ==============================================================================
+
+   FreeverbCore - шаблонный Freeverb (comb + allpass), прежний реверб SpaceEngine
+   (сейчас FdnReverb); остаётся эталоном для сравнения в тестах
+   Повторяет алгоритм juce::Reverb, но работает и во float, и в double
+   (juce::dsp::Reverb поддерживает только float)
+
+   Денормалы гасятся через ScopedNoDenormals, а не JUCE_UNDENORMALISE:
+   трюк +0.1f/-0.1f квантует состояние comb'ов, и во float хвост застревает
+   около -105 dBFS вместо того, чтобы затухать до -120 dBFS
+
+  ==============================================================================
+*/
+
+#include "FreeverbCore.h"
+#include <cmath>
+#include <limits>
+
+//==============================================================================
+template <typename SampleType>
+void FreeverbCore<SampleType>::CombFilter::setSize (int size)
+{
+    buffer.assign (static_cast<size_t> (juce::jmax (1, size)), SampleType (0));
+    bufferIndex = 0;
+    last = 0;
+}
+
+template <typename SampleType>
+void FreeverbCore<SampleType>::CombFilter::clear() noexcept
+{
+    std::fill (buffer.begin(), buffer.end(), SampleType (0));
+    last = 0;
+}
+
+template <typename SampleType>
+SampleType FreeverbCore<SampleType>::CombFilter::process (SampleType input, SampleType damp, SampleType feedbackLevel) noexcept
+{
+    auto output = buffer[(size_t) bufferIndex];
+    last = (output * (SampleType (1) - damp)) + (last * damp);
+
+    auto temp = input + (last * feedbackLevel);
+    buffer[(size_t) bufferIndex] = temp;
+    bufferIndex = (bufferIndex + 1) % (int) buffer.size();
+    return output;
+}
+
+//==============================================================================
+template <typename SampleType>
+void FreeverbCore<SampleType>::AllPassFilter::setSize (int size)
+{
+    buffer.assign (static_cast<size_t> (juce::jmax (1, size)), SampleType (0));
+    bufferIndex = 0;
+}
+
+template <typename SampleType>
+void FreeverbCore<SampleType>::AllPassFilter::clear() noexcept
+{
+    std::fill (buffer.begin(), buffer.end(), SampleType (0));
+}
+
+template <typename SampleType>
+SampleType FreeverbCore<SampleType>::AllPassFilter::process (SampleType input) noexcept
+{
+    auto bufferedValue = buffer[(size_t) bufferIndex];
+    auto temp = input + (bufferedValue * SampleType (0.5));
+    buffer[(size_t) bufferIndex] = temp;
+    bufferIndex = (bufferIndex + 1) % (int) buffer.size();
+    return bufferedValue - input;
+}
+
+//==============================================================================
+template <typename SampleType>
+FreeverbCore<SampleType>::FreeverbCore()
+{
+    setParameters (Parameters());
+    setSampleRate (44100.0);
+}
+
+//==============================================================================
+template <typename SampleType>
+void FreeverbCore<SampleType>::prepare (const juce::dsp::ProcessSpec& spec)
+{
+    setSampleRate (spec.sampleRate);
+    reset();
+}
+
+template <typename SampleType>
+void FreeverbCore<SampleType>::reset()
+{
+    for (int j = 0; j < numStereoChannels; ++j)
+    {
+        for (int i = 0; i < numCombs; ++i)
+            comb[j][i].clear();
+
+        for (int i = 0; i < numAllPasses; ++i)
+            allPass[j][i].clear();
+    }
+}
+
+//==============================================================================
+template <typename SampleType>
+void FreeverbCore<SampleType>::setSampleRate (double newSampleRate)
+{
+    jassert (newSampleRate > 0);
+    sampleRate = newSampleRate;
+
+    // Классические настройки Freeverb (в семплах при 44.1 кГц)
+    static const short combTunings[] = { 1116, 1188, 1277, 1356, 1422, 1491, 1557, 1617 };
+    static const short allPassTunings[] = { 556, 441, 341, 225 };
+    const int stereoSpread = 23;
+    const int intSampleRate = (int) newSampleRate;
+
+    for (int i = 0; i < numCombs; ++i)
+    {
+        comb[0][i].setSize ((intSampleRate * combTunings[i]) / 44100);
+        comb[1][i].setSize ((intSampleRate * (combTunings[i] + stereoSpread)) / 44100);
+    }
+
+    for (int i = 0; i < numAllPasses; ++i)
+    {
+        allPass[0][i].setSize ((intSampleRate * allPassTunings[i]) / 44100);
+        allPass[1][i].setSize ((intSampleRate * (allPassTunings[i] + stereoSpread)) / 44100);
+    }
+
+    const double smoothTime = 0.01;
+    damping .reset (newSampleRate, smoothTime);
+    feedback.reset (newSampleRate, smoothTime);
+    dryGain .reset (newSampleRate, smoothTime);
+    wetGain1.reset (newSampleRate, smoothTime);
+    wetGain2.reset (newSampleRate, smoothTime);
+}
+
+//==============================================================================
+template <typename SampleType>
+void FreeverbCore<SampleType>::setParameters (const Parameters& newParams)
+{
+    const float wetScaleFactor = 3.0f;
+    const float dryScaleFactor = 2.0f;
+
+    const float wet = newParams.wetLevel * wetScaleFactor;
+    dryGain .setTargetValue (static_cast<SampleType> (newParams.dryLevel * dryScaleFactor));
+    wetGain1.setTargetValue (static_cast<SampleType> (0.5f * wet * (1.0f + newParams.width)));
+    wetGain2.setTargetValue (static_cast<SampleType> (0.5f * wet * (1.0f - newParams.width)));
+
+    parameters = newParams;
+    gain = isFrozen() ? SampleType (0) : SampleType (0.015f);
+    updateDamping();
+}
+
+template <typename SampleType>
+void FreeverbCore<SampleType>::updateDamping() noexcept
+{
+    const float roomScaleFactor = 0.28f;
+    const float roomOffset = 0.7f;
+    const float dampScaleFactor = 0.4f;
+
+    if (isFrozen())
+    {
+        damping.setTargetValue (SampleType (0));
+        feedback.setTargetValue (SampleType (1));
+    }
+    else
+    {
+        damping.setTargetValue (static_cast<SampleType> (parameters.damping * dampScaleFactor));
+        feedback.setTargetValue (static_cast<SampleType> (parameters.roomSize * roomScaleFactor + roomOffset));
+    }
+}
+
+//==============================================================================
+template <typename SampleType>
+double FreeverbCore<SampleType>::getDecayTimeSeconds (double decayDb) const noexcept
+{
+    if (isFrozen())
+        return std::numeric_limits<double>::infinity();
+
+    // Comb: за каждый проход по линии сигнал умножается на feedback
+    // (на низких частотах демпфер не ослабляет), медленнее всех затухает самый длинный comb
+    const double feedbackLevel = parameters.roomSize * 0.28 + 0.7;
+    const double longestComb = comb[1][numCombs - 1].getSize() / sampleRate;
+    const double combSeconds = decayDb / (-20.0 * std::log10 (feedbackLevel)) * longestComb;
+
+    // Allpass: 0.5 за проход, последовательно - добавляется к хвосту comb'ов
+    const double longestAllPass = allPass[1][0].getSize() / sampleRate;
+    const double allPassSeconds = decayDb / (-20.0 * std::log10 (0.5)) * longestAllPass;
+
+    return combSeconds + allPassSeconds;
+}
+
+template <typename SampleType>
+double FreeverbCore<SampleType>::getPeakGainDb() const noexcept
+{
+    if (isFrozen())
+        return std::numeric_limits<double>::infinity();
+
+    // Верхняя оценка: все comb'ы на резонансе 1 / (1 - feedback), вход (L+R) * gain, выход wet1 + wet2
+    const double feedbackLevel = parameters.roomSize * 0.28 + 0.7;
+    const double combGain = numCombs * 2.0 * 0.015 / (1.0 - feedbackLevel);
+    const double wetGain = juce::jmax (1.0e-6, 3.0 * (double) parameters.wetLevel);
+    return 20.0 * std::log10 (combGain * wetGain);
+}
+
+//==============================================================================
+template <typename SampleType>
+void FreeverbCore<SampleType>::processStereo (SampleType* left, SampleType* right, int numSamples) noexcept
+{
+    jassert (left != nullptr && right != nullptr);
+    juce::ScopedNoDenormals noDenormals;
+
+    for (int i = 0; i < numSamples; ++i)
+    {
+        const auto input = (left[i] + right[i]) * gain;
+        SampleType outL = 0, outR = 0;
+
+        const auto damp = damping.getNextValue();
+        const auto feedbck = feedback.getNextValue();
+
+        for (int j = 0; j < numCombs; ++j)  // accumulate the comb filters in parallel
+        {
+            outL += comb[0][j].process (input, damp, feedbck);
+            outR += comb[1][j].process (input, damp, feedbck);
+        }
+
+        for (int j = 0; j < numAllPasses; ++j)  // run the allpass filters in series
+        {
+            outL = allPass[0][j].process (outL);
+            outR = allPass[1][j].process (outR);
+        }
+
+        const auto dry  = dryGain.getNextValue();
+        const auto wet1 = wetGain1.getNextValue();
+        const auto wet2 = wetGain2.getNextValue();
+
+        left[i]  = outL * wet1 + outR * wet2 + left[i]  * dry;
+        right[i] = outR * wet1 + outL * wet2 + right[i] * dry;
+    }
+}
+
+template <typename SampleType>
+void FreeverbCore<SampleType>::processMono (SampleType* samples, int numSamples) noexcept
+{
+    jassert (samples != nullptr);
+    juce::ScopedNoDenormals noDenormals;
+
+    for (int i = 0; i < numSamples; ++i)
+    {
+        const auto input = samples[i] * gain;
+        SampleType output = 0;
+
+        const auto damp = damping.getNextValue();
+        const auto feedbck = feedback.getNextValue();
+
+        for (int j = 0; j < numCombs; ++j)
+            output += comb[0][j].process (input, damp, feedbck);
+
+        for (int j = 0; j < numAllPasses; ++j)
+            output = allPass[0][j].process (output);
+
+        const auto dry  = dryGain.getNextValue();
+        const auto wet1 = wetGain1.getNextValue();
+
+        samples[i] = output * wet1 + samples[i] * dry;
+    }
+}
+
+//==============================================================================
+template class FreeverbCore<float>;
+template class FreeverbCore<double>;
@@ -0,0 +1,102 @@
+/*
+  ==============================================================================
+
+   FreeverbCore - шаблонный Freeverb (comb + allpass), прежний реверб SpaceEngine
+   (сейчас FdnReverb); остаётся эталоном для сравнения в тестах
+   Повторяет алгоритм juce::Reverb, но работает и во float, и в double
+   (juce::dsp::Reverb поддерживает только float)
+
+   Денормалы гасятся через ScopedNoDenormals, а не JUCE_UNDENORMALISE:
+   трюк +0.1f/-0.1f квантует состояние comb'ов, и во float хвост застревает
+   около -105 dBFS вместо того, чтобы затухать до -120 dBFS
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <juce_audio_processors/juce_audio_processors.h>
+#include <juce_dsp/juce_dsp.h>
+#include <vector>
+
+//==============================================================================
+template <typename SampleType>
+class FreeverbCore
+{
+public:
+    /** Те же поля и значения по умолчанию, что и у juce::Reverb::Parameters */
+    struct Parameters
+    {
+        float roomSize   = 0.5f;
+        float damping    = 0.5f;
+        float wetLevel   = 0.33f;
+        float dryLevel   = 0.4f;
+        float width      = 1.0f;
+        float freezeMode = 0.0f;
+    };
+
+    FreeverbCore();
+    ~FreeverbCore() = default;
+
+    void prepare (const juce::dsp::ProcessSpec& spec);
+    void reset();
+
+    void setParameters (const Parameters& newParams);
+    const Parameters& getParameters() const noexcept { return parameters; }
+
+    /** Time for the reverb tail to fall by decayDb at the current settings. */
+    double getDecayTimeSeconds (double decayDb) const noexcept;
+
+    /** Upper bound of the input-to-output gain (resonant build-up of the combs times the wet gain). */
+    double getPeakGainDb() const noexcept;
+
+    void processStereo (SampleType* left, SampleType* right, int numSamples) noexcept;
+    void processMono (SampleType* samples, int numSamples) noexcept;
+
+private:
+    //==============================================================================
+    class CombFilter
+    {
+    public:
+        void setSize (int size);
+        void clear() noexcept;
+        SampleType process (SampleType input, SampleType damp, SampleType feedbackLevel) noexcept;
+        int getSize() const noexcept { return (int) buffer.size(); }
+
+    private:
+        std::vector<SampleType> buffer;
+        int bufferIndex = 0;
+        SampleType last = 0;
+    };
+
+    class AllPassFilter
+    {
+    public:
+        void setSize (int size);
+        void clear() noexcept;
+        SampleType process (SampleType input) noexcept;
+        int getSize() const noexcept { return (int) buffer.size(); }
+
+    private:
+        std::vector<SampleType> buffer;
+        int bufferIndex = 0;
+    };
+
+    //==============================================================================
+    void setSampleRate (double newSampleRate);
+    void updateDamping() noexcept;
+    bool isFrozen() const noexcept { return parameters.freezeMode >= 0.5f; }
+
+    static constexpr int numCombs = 8, numAllPasses = 4, numStereoChannels = 2;
+
+    Parameters parameters;
+    SampleType gain = 0;
+    double sampleRate = 44100.0;
+
+    CombFilter comb[numStereoChannels][numCombs];
+    AllPassFilter allPass[numStereoChannels][numAllPasses];
+
+    juce::LinearSmoothedValue<SampleType> damping, feedback, dryGain, wetGain1, wetGain2;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (FreeverbCore)
+};
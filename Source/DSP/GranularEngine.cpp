@@ -10,12 +10,14 @@
 #include "GranularEngine.h"
 
 //==============================================================================
-GranularEngine::GranularEngine()
+template <typename SampleType>
+GranularEngine<SampleType>::GranularEngine()
 {
 }
 
 //==============================================================================
-void GranularEngine::prepare (const juce::dsp::ProcessSpec& spec)
+template <typename SampleType>
+void GranularEngine<SampleType>::prepare (const juce::dsp::ProcessSpec& spec)
 {
     sampleRate = spec.sampleRate;
     blockSize = (int) spec.maximumBlockSize;
@@ -23,16 +25,29 @@ void GranularEngine::prepare (const juce::dsp::ProcessSpec& spec)
 }
 
 //==============================================================================
-void GranularEngine::reset()
+template <typename SampleType>
+void GranularEngine<SampleType>::reset()
 {
     // TODO: Reset granular buffers, grains, etc.
 }
 
 //==============================================================================
-void GranularEngine::process (juce::AudioBuffer<float>& buffer)
+template <typename SampleType>
+void GranularEngine<SampleType>::process (juce::AudioBuffer<SampleType>& buffer)
 {
     // TODO: Implement granular processing
     // For now, pass through unchanged
     juce::ignoreUnused (buffer);
 }
 
+//==============================================================================
+template <typename SampleType>
+bool GranularEngine<SampleType>::isActive() const noexcept
+{
+    // Заглушка - сигнал не меняется
+    return false;
+}
+
+//==============================================================================
+template class GranularEngine<float>;
+template class GranularEngine<double>;
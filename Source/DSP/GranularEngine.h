@@ -13,6 +13,7 @@
 #include <juce_dsp/juce_dsp.h>
 
 //==============================================================================
+template <typename SampleType>
 class GranularEngine
 {
 public:
@@ -21,7 +22,10 @@ public:
 
     void prepare (const juce::dsp::ProcessSpec& spec);
     void reset();
-    void process (juce::AudioBuffer<float>& buffer);
+    void process (juce::AudioBuffer<SampleType>& buffer);
+
+    // true, если process() сейчас меняет сигнал (иначе планировщик процессора пропускает модуль)
+    bool isActive() const noexcept;
 
 private:
     double sampleRate = 44100.0;
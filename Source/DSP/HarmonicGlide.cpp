@@ -10,7 +10,8 @@
 #include "HarmonicGlide.h"
 
 //==============================================================================
-HarmonicGlide::HarmonicGlide()
+template <typename SampleType>
+HarmonicGlide<SampleType>::HarmonicGlide()
 {
     // Инициализация delay buffers
     delayBufferL.resize (MAX_DELAY_SAMPLES, 0.0f);
@@ -36,7 +37,8 @@ HarmonicGlide::HarmonicGlide()
 }
 
 //==============================================================================
-void HarmonicGlide::prepare (const juce::dsp::ProcessSpec& spec)
+template <typename SampleType>
+void HarmonicGlide<SampleType>::prepare (const juce::dsp::ProcessSpec& spec)
 {
     sampleRate = spec.sampleRate;
     blockSize = (int) spec.maximumBlockSize;
@@ -62,7 +64,8 @@ void HarmonicGlide::prepare (const juce::dsp::ProcessSpec& spec)
 }
 
 //==============================================================================
-void HarmonicGlide::reset()
+template <typename SampleType>
+void HarmonicGlide<SampleType>::reset()
 {
     std::fill (delayBufferL.begin(), delayBufferL.end(), 0.0f);
     std::fill (delayBufferR.begin(), delayBufferR.end(), 0.0f);
@@ -83,20 +86,23 @@ void HarmonicGlide::reset()
 }
 
 //==============================================================================
-void HarmonicGlide::setEnergy (float energy)
+template <typename SampleType>
+void HarmonicGlide<SampleType>::setEnergy (float energy)
 {
     energyParam = juce::jlimit (0.0f, 1.0f, energy);
     energySmoother.setTargetValue (energyParam);
 }
 
-void HarmonicGlide::setFlow (float flow)
+template <typename SampleType>
+void HarmonicGlide<SampleType>::setFlow (float flow)
 {
     flowParam = juce::jlimit (0.0f, 1.0f, flow);
     flowSmoother.setTargetValue (flowParam);
 }
 
 //==============================================================================
-float HarmonicGlide::calculateRMS (const juce::AudioBuffer<float>& buffer)
+template <typename SampleType>
+float HarmonicGlide<SampleType>::calculateRMS (const juce::AudioBuffer<SampleType>& buffer)
 {
     auto numSamples = buffer.getNumSamples();
     auto numCh = buffer.getNumChannels();
@@ -104,7 +110,7 @@ float HarmonicGlide::calculateRMS (const juce::AudioBuffer<float>& buffer)
     if (numSamples == 0 || numCh == 0)
         return 0.0f;
     
-    float sumSquared = 0.0f;
+    SampleType sumSquared = 0;
     int totalSamples = 0;
     
     for (int ch = 0; ch < numCh; ++ch)
@@ -120,11 +126,12 @@ float HarmonicGlide::calculateRMS (const juce::AudioBuffer<float>& buffer)
     if (totalSamples == 0)
         return 0.0f;
     
-    return std::sqrt (sumSquared / totalSamples);
+    return static_cast<float> (std::sqrt (sumSquared / totalSamples));
 }
 
 //==============================================================================
-float HarmonicGlide::centsToDelaySamples (float cents)
+template <typename SampleType>
+float HarmonicGlide<SampleType>::centsToDelaySamples (float cents)
 {
     // Конвертируем центы в коэффициент изменения частоты
     // cents = 1200 * log2(f_new / f_old)
@@ -154,7 +161,8 @@ float HarmonicGlide::centsToDelaySamples (float cents)
 }
 
 //==============================================================================
-float HarmonicGlide::getDelayedSample (const std::vector<float>& delayBuffer, int writePos, float delaySamples)
+template <typename SampleType>
+SampleType HarmonicGlide<SampleType>::getDelayedSample (const std::vector<SampleType>& delayBuffer, int writePos, float delaySamples)
 {
     // Вычисляем позицию чтения (назад от writePos)
     float readPos = writePos - delaySamples;
@@ -171,14 +179,15 @@ float HarmonicGlide::getDelayedSample (const std::vector<float>& delayBuffer, in
     
     int readPosNext = (readPosInt + 1) % MAX_DELAY_SAMPLES;
     
-    float sample1 = delayBuffer[readPosInt];
-    float sample2 = delayBuffer[readPosNext];
+    SampleType sample1 = delayBuffer[readPosInt];
+    SampleType sample2 = delayBuffer[readPosNext];
     
-    return sample1 + fraction * (sample2 - sample1);
+    return sample1 + static_cast<SampleType> (fraction) * (sample2 - sample1);
 }
 
 //==============================================================================
-void HarmonicGlide::process (juce::AudioBuffer<float>& buffer)
+template <typename SampleType>
+void HarmonicGlide<SampleType>::process (juce::AudioBuffer<SampleType>& buffer)
 {
     juce::ScopedNoDenormals noDenormals;
     
@@ -277,15 +286,15 @@ void HarmonicGlide::process (juce::AudioBuffer<float>& buffer)
         for (int i = 0; i < numSamples; ++i)
         {
             // Читаем задержанный семпл (для питч-шифта)
-            float delayedSample = getDelayedSample (delayBuffer, writePos, delaySamples);
+            SampleType delayedSample = getDelayedSample (delayBuffer, writePos, delaySamples);
             
             // Записываем текущий семпл в delay buffer
             delayBuffer[writePos] = channelData[i];
             
             // Применяем питч-шифт: смешиваем оригинал с задержанной версией
             // Для микро-сдвига используем лёгкое смешивание
-            float mixAmount = std::abs (currentPitchShiftCents) / MAX_SHIFT_CENTS * 0.3f;  // Макс 30% смешивания
-            channelData[i] = channelData[i] * (1.0f - mixAmount) + delayedSample * mixAmount;
+            auto mixAmount = static_cast<SampleType> (std::abs (currentPitchShiftCents) / MAX_SHIFT_CENTS * 0.3f);  // Макс 30% смешивания
+            channelData[i] = channelData[i] * (static_cast<SampleType> (1) - mixAmount) + delayedSample * mixAmount;
             
             // Обновляем позицию записи
             writePos = (writePos + 1) % MAX_DELAY_SAMPLES;
@@ -293,3 +302,14 @@ void HarmonicGlide::process (juce::AudioBuffer<float>& buffer)
     }
 }
 
+//==============================================================================
+template <typename SampleType>
+bool HarmonicGlide<SampleType>::isActive() const noexcept
+{
+    // При Energy = 0 process() пропускает сигнал без изменений
+    return energyParam >= 0.001f || energySmoother.getCurrentValue() >= 0.001f;
+}
+
+//==============================================================================
+template class HarmonicGlide<float>;
+template class HarmonicGlide<double>;
@@ -15,6 +15,7 @@
 #include <vector>
 
 //==============================================================================
+template <typename SampleType>
 class HarmonicGlide
 {
 public:
@@ -23,7 +24,10 @@ public:
 
     void prepare (const juce::dsp::ProcessSpec& spec);
     void reset();
-    void process (juce::AudioBuffer<float>& buffer);
+    void process (juce::AudioBuffer<SampleType>& buffer);
+
+    // true, если process() сейчас меняет сигнал (иначе планировщик процессора пропускает модуль)
+    bool isActive() const noexcept;
 
     // Parameter control (normalized 0.0-1.0)
     void setEnergy (float energy);    // Чувствительность к громкости (0.0 = выкл, 1.0 = макс)
@@ -42,8 +46,8 @@ private:
     
     // Delay line для питч-шифта (микро-сдвиг через задержку с интерполяцией)
     static constexpr int MAX_DELAY_SAMPLES = 512;           // Максимальная задержка для питч-шифта
-    std::vector<float> delayBufferL;
-    std::vector<float> delayBufferR;
+    std::vector<SampleType> delayBufferL;
+    std::vector<SampleType> delayBufferR;
     int delayWritePosL = 0;
     int delayWritePosR = 0;
     
@@ -71,9 +75,9 @@ private:
     int numChannels = 2;
     
     // Вспомогательные функции
-    float calculateRMS (const juce::AudioBuffer<float>& buffer);
+    float calculateRMS (const juce::AudioBuffer<SampleType>& buffer);
     float centsToDelaySamples (float cents);
-    float getDelayedSample (const std::vector<float>& delayBuffer, int writePos, float delaySamples);
+    SampleType getDelayedSample (const std::vector<SampleType>& delayBuffer, int writePos, float delaySamples);
     
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (HarmonicGlide)
 };
@@ -10,7 +10,8 @@
 #include "MotionMod.h"
 
 //==============================================================================
-MotionMod::MotionMod()
+template <typename SampleType>
+MotionMod<SampleType>::MotionMod()
 {
     // Initialize smoothers (30ms smoothing)
     flowSmoother.reset (44100.0, 0.03f);
@@ -21,7 +22,8 @@ MotionMod::MotionMod()
 }
 
 //==============================================================================
-void MotionMod::prepare (const juce::dsp::ProcessSpec& spec)
+template <typename SampleType>
+void MotionMod<SampleType>::prepare (const juce::dsp::ProcessSpec& spec)
 {
     sampleRate = spec.sampleRate;
     blockSize = (int) spec.maximumBlockSize;
@@ -35,7 +37,8 @@ void MotionMod::prepare (const juce::dsp::ProcessSpec& spec)
 }
 
 //==============================================================================
-void MotionMod::reset()
+template <typename SampleType>
+void MotionMod<SampleType>::reset()
 {
     lfoPhasePan = 0.0f;
     lfoPhaseGain = 0.5f;  // 90° offset for anti-phase
@@ -44,20 +47,23 @@ void MotionMod::reset()
 }
 
 //==============================================================================
-void MotionMod::setFlow (float flow)
+template <typename SampleType>
+void MotionMod<SampleType>::setFlow (float flow)
 {
     flowParam = juce::jlimit (0.0f, 1.0f, flow);
     flowSmoother.setTargetValue (flowParam);
 }
 
-void MotionMod::setEnergy (float energy)
+template <typename SampleType>
+void MotionMod<SampleType>::setEnergy (float energy)
 {
     energyParam = juce::jlimit (0.0f, 1.0f, energy);
     energySmoother.setTargetValue (energyParam);
 }
 
 //==============================================================================
-void MotionMod::process (juce::AudioBuffer<float>& buffer)
+template <typename SampleType>
+void MotionMod<SampleType>::process (juce::AudioBuffer<SampleType>& buffer)
 {
     auto numSamples = buffer.getNumSamples();
     
@@ -112,7 +118,7 @@ void MotionMod::process (juce::AudioBuffer<float>& buffer)
     {
         // Update envelope follower for transient detection
         // Use average of L+R channels to detect signal level
-        auto signalLevel = std::abs (leftChannel[sample]) + std::abs (rightChannel[sample]);
+        auto signalLevel = static_cast<float> (std::abs (leftChannel[sample]) + std::abs (rightChannel[sample]));
         signalLevel *= 0.5f;  // Average
         
         // Envelope follower: fast attack, slow release
@@ -169,8 +175,21 @@ void MotionMod::process (juce::AudioBuffer<float>& buffer)
         gainMod = std::tanh (gainMod * 2.2f) * 0.1f + 1.0f;  // Smooth curve, map to 0.9-1.1 range
         
         // Apply both pan and gain modulation
-        leftChannel[sample] *= leftGain * gainMod;
-        rightChannel[sample] *= rightGain * gainMod;
+        leftChannel[sample] *= static_cast<SampleType> (leftGain * gainMod);
+        rightChannel[sample] *= static_cast<SampleType> (rightGain * gainMod);
     }
 }
 
+//==============================================================================
+template <typename SampleType>
+bool MotionMod<SampleType>::isActive() const noexcept
+{
+    // Нужны и Flow, и Energy - без любого из них process() ничего не делает
+    auto flowActive = flowParam >= 0.001f || flowSmoother.getCurrentValue() >= 0.001f;
+    auto energyActive = energyParam >= 0.001f || energySmoother.getCurrentValue() >= 0.001f;
+    return flowActive && energyActive;
+}
+
+//==============================================================================
+template class MotionMod<float>;
+template class MotionMod<double>;
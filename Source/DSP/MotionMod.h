@@ -14,6 +14,7 @@
 #include <cmath>
 
 //==============================================================================
+template <typename SampleType>
 class MotionMod
 {
 public:
@@ -22,7 +23,10 @@ public:
 
     void prepare (const juce::dsp::ProcessSpec& spec);
     void reset();
-    void process (juce::AudioBuffer<float>& buffer);
+    void process (juce::AudioBuffer<SampleType>& buffer);
+
+    // true, если process() сейчас меняет сигнал (иначе планировщик процессора пропускает модуль)
+    bool isActive() const noexcept;
 
     // Parameter control (normalized 0.0-1.0)
     void setFlow (float flow);        // 0.0 = static, 1.0 = moving
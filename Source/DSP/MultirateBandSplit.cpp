@@ -0,0 +1,234 @@
+/*
+  ==============================================================================
+
+   MultirateBandSplit - нижняя полоса на пониженной частоте для формант-шифта
+   Децимация линейно-фазовым FIR, обработка на rate / factor, обратно -
+   интерполяция только разницы (обработанное - исходное)
+
+  ==============================================================================
+*/
+
+#include "MultirateBandSplit.h"
+
+namespace
+{
+    // Четыре независимые суммы: цепочка зависимостей сложений в 4 раза короче
+    template <typename SampleType>
+    SampleType dotProduct (const SampleType* a, const SampleType* b, int num) noexcept
+    {
+        SampleType sum0 = 0, sum1 = 0, sum2 = 0, sum3 = 0;
+        int i = 0;
+
+        for (; i + 4 <= num; i += 4)
+        {
+            sum0 += a[i] * b[i];
+            sum1 += a[i + 1] * b[i + 1];
+            sum2 += a[i + 2] * b[i + 2];
+            sum3 += a[i + 3] * b[i + 3];
+        }
+
+        for (; i < num; ++i)
+            sum0 += a[i] * b[i];
+
+        return (sum0 + sum1) + (sum2 + sum3);
+    }
+}
+
+//==============================================================================
+template <typename SampleType>
+void MultirateBandSplit<SampleType>::prepare (int numChannels, int newFactor, int maximumBlockSize, int newLowBandLatency)
+{
+    jassert (newFactor >= 2 && juce::isPowerOfTwo (newFactor) && newLowBandLatency > 0);
+
+    factor = newFactor;
+    lowBandLatency = newLowBandLatency;
+    numTaps = TAPS_PER_PHASE * factor + 1;
+    tapsPerPhase = (numTaps + factor - 1) / factor;
+    maxLowBlockSize = maximumBlockSize / factor + 1;
+
+    // Windowed sinc (Blackman): срез CUTOFF пониженной частоты, единичное усиление на DC
+    const auto centre = (numTaps - 1) / 2;
+    const auto cutoff = CUTOFF / factor;  // в долях частоты хоста
+    const auto pi = juce::MathConstants<double>::pi;
+
+    std::vector<double> design ((size_t) numTaps);
+    double sum = 0.0;
+
+    for (int k = 0; k < numTaps; ++k)
+    {
+        const auto offset = (double) (k - centre);
+        const auto sinc = k == centre ? 2.0 * cutoff : std::sin (2.0 * pi * cutoff * offset) / (pi * offset);
+        const auto window = 0.42 - 0.5 * std::cos (2.0 * pi * k / (numTaps - 1)) + 0.08 * std::cos (4.0 * pi * k / (numTaps - 1));
+        design[(size_t) k] = sinc * window;
+        sum += design[(size_t) k];
+    }
+
+    kernel.resize ((size_t) numTaps);
+
+    for (int k = 0; k < numTaps; ++k)
+        kernel[(size_t) k] = (SampleType) (design[(size_t) k] / sum);
+
+    // Фаза q интерполятора: отвод i семплов назад по пониженной частоте - kernel[q + i * factor].
+    // Нули между семплами не хранятся, отсюда множитель factor
+    polyphaseKernel.assign ((size_t) (factor * tapsPerPhase), SampleType (0));
+
+    for (int q = 0; q < factor; ++q)
+        for (int i = 0; i < tapsPerPhase; ++i)
+            if (q + i * factor < numTaps)
+                polyphaseKernel[(size_t) (q * tapsPerPhase + tapsPerPhase - 1 - i)] = (SampleType) (factor * design[(size_t) (q + i * factor)] / sum);
+
+    channels.resize ((size_t) juce::jmax (0, numChannels));
+
+    for (auto& channel : channels)
+    {
+        channel.inputHistory.resize ((size_t) (2 * numTaps));
+        channel.lowDelay.resize ((size_t) juce::jmax (1, lowBandLatency));
+        channel.lowReference.resize ((size_t) maxLowBlockSize);
+        channel.changeHistory.resize ((size_t) (2 * tapsPerPhase));
+        channel.dryDelay.resize ((size_t) getLatencySamples());
+    }
+
+    reset();
+}
+
+template <typename SampleType>
+void MultirateBandSplit<SampleType>::reset() noexcept
+{
+    for (auto& channel : channels)
+    {
+        std::fill (channel.inputHistory.begin(), channel.inputHistory.end(), SampleType (0));
+        std::fill (channel.lowDelay.begin(), channel.lowDelay.end(), SampleType (0));
+        std::fill (channel.lowReference.begin(), channel.lowReference.end(), SampleType (0));
+        std::fill (channel.changeHistory.begin(), channel.changeHistory.end(), SampleType (0));
+        std::fill (channel.dryDelay.begin(), channel.dryDelay.end(), SampleType (0));
+    }
+
+    phase = 0;
+    blockStartPhase = 0;
+    numLowSamples = 0;
+    historyPosition = 0;
+    lowDelayPosition = 0;
+    changePosition = 0;
+    dryDelayPosition = 0;
+}
+
+//==============================================================================
+template <typename SampleType>
+int MultirateBandSplit<SampleType>::decimate (const juce::AudioBuffer<SampleType>& buffer,
+                                              juce::AudioBuffer<SampleType>& low) noexcept
+{
+    const auto numSamples = buffer.getNumSamples();
+    const auto numChannels = juce::jmin (buffer.getNumChannels(), low.getNumChannels(), (int) channels.size());
+
+    jassert (numSamples / factor + 1 <= juce::jmin (maxLowBlockSize, low.getNumSamples()));
+
+    blockStartPhase = phase;
+    numLowSamples = 0;
+
+    if (numChannels == 0)
+        return 0;
+
+    // Позиции общие: каждый канал проходит блок с одних и тех же стартовых значений
+    int endPhase = phase, endHistoryPosition = historyPosition, endLowDelayPosition = lowDelayPosition;
+
+    for (int ch = 0; ch < numChannels; ++ch)
+    {
+        auto& channel = channels[(size_t) ch];
+        const auto* input = buffer.getReadPointer (ch);
+        auto* output = low.getWritePointer (ch);
+        auto* history = channel.inputHistory.data();
+
+        auto samplePhase = blockStartPhase;
+        auto position = historyPosition;
+        auto delayPosition = lowDelayPosition;
+        int count = 0;
+
+        for (int i = 0; i < numSamples; ++i)
+        {
+            position = position + 1 == numTaps ? 0 : position + 1;
+            history[position] = history[position + numTaps] = input[i];
+
+            if (++samplePhase < factor)
+                continue;
+
+            // FIR считается только там, где нужен выход: раз в factor семплов.
+            // Ядро симметрично - порядок отводов не важен
+            samplePhase = 0;
+            const auto value = dotProduct (kernel.data(), history + position + 1, numTaps);
+
+            output[count] = value;
+            channel.lowReference[(size_t) count] = channel.lowDelay[(size_t) delayPosition];
+            channel.lowDelay[(size_t) delayPosition] = value;
+            delayPosition = delayPosition + 1 == (int) channel.lowDelay.size() ? 0 : delayPosition + 1;
+            ++count;
+        }
+
+        numLowSamples = count;
+        endPhase = samplePhase;
+        endHistoryPosition = position;
+        endLowDelayPosition = delayPosition;
+    }
+
+    phase = endPhase;
+    historyPosition = endHistoryPosition;
+    lowDelayPosition = endLowDelayPosition;
+
+    return numLowSamples;
+}
+
+template <typename SampleType>
+void MultirateBandSplit<SampleType>::recombine (juce::AudioBuffer<SampleType>& buffer,
+                                                const juce::AudioBuffer<SampleType>& processed) noexcept
+{
+    const auto numSamples = buffer.getNumSamples();
+    const auto numChannels = juce::jmin (buffer.getNumChannels(), processed.getNumChannels(), (int) channels.size());
+    const auto dryDelayLength = getLatencySamples();
+
+    jassert (processed.getNumSamples() >= numLowSamples);
+
+    int endChangePosition = changePosition, endDryDelayPosition = dryDelayPosition;
+
+    for (int ch = 0; ch < numChannels; ++ch)
+    {
+        auto& channel = channels[(size_t) ch];
+        auto* data = buffer.getWritePointer (ch);
+        const auto* lowProcessed = processed.getReadPointer (ch);
+        auto* history = channel.changeHistory.data();
+
+        auto samplePhase = blockStartPhase;
+        auto position = changePosition;
+        auto delayPosition = dryDelayPosition;
+        int lowIndex = 0;
+
+        for (int i = 0; i < numSamples; ++i)
+        {
+            // Новый семпл разницы - ровно там, где decimate() выдал семпл нижней полосы
+            if (++samplePhase == factor)
+            {
+                samplePhase = 0;
+                position = position + 1 == tapsPerPhase ? 0 : position + 1;
+                history[position] = history[position + tapsPerPhase]
+                    = lowProcessed[lowIndex] - channel.lowReference[(size_t) lowIndex];
+                ++lowIndex;
+            }
+
+            const auto change = dotProduct (polyphaseKernel.data() + samplePhase * tapsPerPhase,
+                                            history + position + 1, tapsPerPhase);
+
+            const auto input = data[i];
+            data[i] = channel.dryDelay[(size_t) delayPosition] + change;
+            channel.dryDelay[(size_t) delayPosition] = input;
+            delayPosition = delayPosition + 1 == dryDelayLength ? 0 : delayPosition + 1;
+        }
+
+        endChangePosition = position;
+        endDryDelayPosition = delayPosition;
+    }
+
+    changePosition = endChangePosition;
+    dryDelayPosition = endDryDelayPosition;
+}
+
+//==============================================================================
+template class MultirateBandSplit<float>;
+template class MultirateBandSplit<double>;
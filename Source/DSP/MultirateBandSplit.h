@@ -0,0 +1,100 @@
+/*
+  ==============================================================================
+
+   MultirateBandSplit - нижняя полоса на пониженной частоте для формант-шифта
+   Децимация линейно-фазовым FIR, обработка на rate / factor, обратно -
+   интерполяция только разницы (обработанное - исходное)
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <juce_audio_processors/juce_audio_processors.h>
+#include <vector>
+
+//==============================================================================
+/** Splits off the low band, runs it at sampleRate / factor and puts it back.
+
+    decimate() low-passes the block with a linear-phase windowed-sinc FIR and
+    keeps every factor-th sample. The caller processes that low-rate signal
+    with any fixed-latency process (the formant STFT). recombine() then
+    interpolates only the change the process made (processed minus the
+    decimated signal delayed by the same latency) with the same FIR and adds
+    it to the full-band input, delayed to match.
+
+    The high band is therefore never filtered: crossover and resampling
+    phase cancel exactly, and with an untouched low band the output is the
+    input delayed by getLatencySamples(), bit for bit up to rounding.
+    Changes above the FIR passband (about 0.26 * low rate) fade out, which
+    is where the formant regions end anyway.
+
+    Cost per host sample and channel: numTaps / factor multiply-adds for
+    each of the decimator and the interpolator (polyphase).
+*/
+template <typename SampleType>
+class MultirateBandSplit
+{
+public:
+    MultirateBandSplit() = default;
+
+    /** factor must be a power of two, >= 2. lowBandLatency (> 0) is the delay (in low-rate
+        samples) of the process that runs between decimate() and recombine().
+    */
+    void prepare (int numChannels, int factor, int maximumBlockSize, int lowBandLatency);
+    void reset() noexcept;
+
+    int getFactor() const noexcept           { return factor; }
+    int getMaxLowBlockSize() const noexcept  { return maxLowBlockSize; }
+
+    /** Decimator + interpolator group delay plus the low-band process, in host samples. */
+    int getLatencySamples() const noexcept   { return numTaps - 1 + lowBandLatency * factor; }
+
+    /** Writes the low band of buffer at rate / factor into low and returns how many
+        samples that is (0 or more, depending on the block size and phase). buffer is
+        not changed. Call recombine() with the same buffer before the next decimate().
+    */
+    int decimate (const juce::AudioBuffer<SampleType>& buffer, juce::AudioBuffer<SampleType>& low) noexcept;
+
+    /** processed: the samples from decimate() after the low-band process.
+        buffer becomes the delayed input plus the interpolated change.
+    */
+    void recombine (juce::AudioBuffer<SampleType>& buffer, const juce::AudioBuffer<SampleType>& processed) noexcept;
+
+private:
+    struct Channel
+    {
+        std::vector<SampleType> inputHistory;   // 2 * numTaps: каждое значение дважды, окно читается подряд
+        std::vector<SampleType> lowDelay;       // нижняя полоса без обработки, lowBandLatency семплов
+        std::vector<SampleType> lowReference;   // она же с задержкой - для текущего блока
+        std::vector<SampleType> changeHistory;  // 2 * tapsPerPhase: разница на пониженной частоте
+        std::vector<SampleType> dryDelay;       // вход полной полосы, getLatencySamples() семплов
+    };
+
+    std::vector<Channel> channels;
+
+    // Ядро FIR (симметричное) и оно же по фазам интерполятора: [phase * tapsPerPhase + i],
+    // от старого семпла к новому, уже умножено на factor
+    std::vector<SampleType> kernel;
+    std::vector<SampleType> polyphaseKernel;
+
+    int factor = 1;
+    int numTaps = 1;
+    int tapsPerPhase = 1;
+    int lowBandLatency = 0;
+    int maxLowBlockSize = 0;
+
+    // Общие для каналов позиции
+    int phase = 0;             // семплов с последнего выхода дециматора
+    int blockStartPhase = 0;
+    int numLowSamples = 0;     // выдано последним decimate()
+    int historyPosition = 0;
+    int lowDelayPosition = 0;
+    int changePosition = 0;
+    int dryDelayPosition = 0;
+
+    static constexpr int TAPS_PER_PHASE = 32;
+    static constexpr double CUTOFF = 0.35;  // доля пониженной частоты: полоса пропускания ~0.26, подавление с ~0.44
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (MultirateBandSplit)
+};
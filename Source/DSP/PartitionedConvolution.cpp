@@ -0,0 +1,454 @@
+/*
+  ==============================================================================
+
+   PartitionedConvolution - свёртка с длинной IR без задержки
+   Голова IR - прямой FIR, дальше FFT-разбиения растущего размера
+   (64 / 512 / 4096): чем дальше от начала, тем реже и крупнее блоки.
+   Поздний хвост (4096) считает отдельный поток - в callback-е только ранние
+
+  ==============================================================================
+*/
+
+#include "PartitionedConvolution.h"
+
+namespace
+{
+    // Четыре независимые суммы: цепочка зависимостей сложений в 4 раза короче
+    float dotProduct (const float* a, const float* b, int num) noexcept
+    {
+        float sum0 = 0, sum1 = 0, sum2 = 0, sum3 = 0;
+        int i = 0;
+
+        for (; i + 4 <= num; i += 4)
+        {
+            sum0 += a[i] * b[i];
+            sum1 += a[i + 1] * b[i + 1];
+            sum2 += a[i + 2] * b[i + 2];
+            sum3 += a[i + 3] * b[i + 3];
+        }
+
+        for (; i < num; ++i)
+            sum0 += a[i] * b[i];
+
+        return (sum0 + sum1) + (sum2 + sum3);
+    }
+
+    // Real-only FFT JUCE: [re0, im0, re1, im1, ...] -> планарно re[], im[]
+    void deinterleave (const float* interleaved, float* re, float* im, int numBins) noexcept
+    {
+        for (int b = 0; b < numBins; ++b)
+        {
+            re[b] = interleaved[2 * b];
+            im[b] = interleaved[2 * b + 1];
+        }
+    }
+}
+
+//==============================================================================
+template <typename SampleType>
+PartitionedConvolution<SampleType>::PartitionedConvolution (const juce::AudioBuffer<float>& ir)
+    : juce::Thread ("VOID Convolution Tail")
+{
+    jassert (ir.getNumChannels() > 0);
+
+    irLength = ir.getNumSamples();
+    const auto irChannels = juce::jmax (1, juce::jmin (NUM_CHANNELS, ir.getNumChannels()));
+
+    auto irSample = [&] (int channel, int index)
+    {
+        return index < irLength ? ir.getSample (juce::jmin (channel, irChannels - 1), index) : 0.0f;
+    };
+
+    for (int ch = 0; ch < NUM_CHANNELS; ++ch)
+    {
+        headTaps[(size_t) ch].resize ((size_t) HEAD_SIZE);
+        headHistory[(size_t) ch].assign ((size_t) (2 * HEAD_SIZE), 0.0f);
+
+        // История читается от старого к новому - отводы в обратном порядке
+        for (int i = 0; i < HEAD_SIZE; ++i)
+            headTaps[(size_t) ch][(size_t) (HEAD_SIZE - 1 - i)] = irSample (ch, i);
+    }
+
+    // Буферы FFT: ранние уровни - в callback-е, поздний - у worker-а
+    const auto earlyFftSize = 2 * LEVEL_SIZES[LATE_LEVEL - 1];
+    fftBuffer.assign ((size_t) (2 * earlyFftSize), 0.0f);
+    accumulator.assign ((size_t) (2 * (earlyFftSize / 2 + 1)), 0.0f);
+
+    for (int l = 0; l < NUM_LEVELS; ++l)
+    {
+        const auto size = LEVEL_SIZES[l];
+        const auto offset = getLevelOffset (l);
+        const auto end = l + 1 < NUM_LEVELS ? juce::jmin (irLength, getLevelOffset (l + 1)) : irLength;
+
+        if (end <= offset)
+            break;
+
+        auto& level = levels[(size_t) l];
+        level.partitionSize = size;
+        level.numPartitions = (end - offset + size - 1) / size;
+        level.numBins = size + 1;
+        level.fft = std::make_unique<juce::dsp::FFT> (juce::roundToInt (std::log2 (2 * size)));
+        level.irSpectra.resize ((size_t) (NUM_CHANNELS * level.numPartitions * 2 * level.numBins));
+
+        std::vector<float> scratch ((size_t) (4 * size));
+
+        // Разбиение k: IR [offset + k * size, offset + (k + 1) * size), дополнено нулями до 2 * size
+        for (int ch = 0; ch < NUM_CHANNELS; ++ch)
+        {
+            for (int k = 0; k < level.numPartitions; ++k)
+            {
+                std::fill (scratch.begin(), scratch.end(), 0.0f);
+
+                for (int i = 0; i < size; ++i)
+                    scratch[(size_t) i] = irSample (ch, offset + k * size + i);
+
+                level.fft->performRealOnlyForwardTransform (scratch.data(), true);
+
+                auto* spectrum = level.irSpectra.data() + (size_t) ((ch * level.numPartitions + k) * 2 * level.numBins);
+                deinterleave (scratch.data(), spectrum, spectrum + level.numBins, level.numBins);
+            }
+
+            auto& channel = level.channels[(size_t) ch];
+            channel.window.assign ((size_t) (2 * size), 0.0f);
+            channel.fdl.assign ((size_t) (level.numPartitions * 2 * level.numBins), 0.0f);
+            channel.output.assign ((size_t) size, 0.0f);
+        }
+
+        numActiveLevels = l + 1;
+    }
+
+    hasLateLevel = numActiveLevels > LATE_LEVEL;
+
+    if (hasLateLevel)
+    {
+        const auto size = LEVEL_SIZES[LATE_LEVEL];
+
+        for (auto& job : lateJobs)
+        {
+            for (auto& input : job.input)    input.assign ((size_t) size, 0.0f);
+            for (auto& output : job.output)  output.assign ((size_t) size, 0.0f);
+        }
+
+        for (auto& window : lateWindows)
+            window.assign ((size_t) (2 * size), 0.0f);
+
+        lateFftBuffer.assign ((size_t) (4 * size), 0.0f);
+        lateAccumulator.assign ((size_t) (2 * (size + 1)), 0.0f);
+
+        startThread (juce::Thread::Priority::high);
+    }
+}
+
+template <typename SampleType>
+PartitionedConvolution<SampleType>::~PartitionedConvolution()
+{
+    stopThread (1000);
+}
+
+template <typename SampleType>
+void PartitionedConvolution<SampleType>::reset() noexcept
+{
+    for (auto& history : headHistory)
+        std::fill (history.begin(), history.end(), 0.0f);
+
+    headPosition = 0;
+
+    for (int l = 0; l < NUM_LEVELS; ++l)
+    {
+        auto& level = levels[(size_t) l];
+        level.fill = 0;
+
+        for (auto& channel : level.channels)
+        {
+            std::fill (channel.window.begin(), channel.window.end(), 0.0f);
+            std::fill (channel.output.begin(), channel.output.end(), 0.0f);
+        }
+
+        // Линию задержки спектров позднего уровня чистит его worker
+        if (l == LATE_LEVEL)
+            continue;
+
+        level.fdlPosition = 0;
+
+        for (auto& channel : level.channels)
+            std::fill (channel.fdl.begin(), channel.fdl.end(), 0.0f);
+    }
+
+    if (hasLateLevel)
+        requestLateFlush();
+}
+
+//==============================================================================
+template <typename SampleType>
+void PartitionedConvolution<SampleType>::processStereo (SampleType* left, SampleType* right, int numSamples) noexcept
+{
+    SampleType* data[NUM_CHANNELS] = { left, right };
+    const auto smallest = LEVEL_SIZES[0];
+
+    // Отрезки до границы самого мелкого блока: границы всех уровней совпадают с ними
+    for (int start = 0; start < numSamples;)
+    {
+        const auto length = juce::jmin (numSamples - start, smallest - levels[0].fill % smallest);
+
+        for (int ch = 0; ch < NUM_CHANNELS; ++ch)
+        {
+            auto* samples = data[ch] + start;
+            auto* history = headHistory[(size_t) ch].data();
+            const auto* taps = headTaps[(size_t) ch].data();
+            auto position = headPosition;
+
+            for (int i = 0; i < length; ++i)
+            {
+                const auto input = (float) samples[i];
+
+                position = position + 1 == HEAD_SIZE ? 0 : position + 1;
+                history[position] = history[position + HEAD_SIZE] = input;
+
+                auto output = (SampleType) dotProduct (taps, history + position + 1, HEAD_SIZE);
+
+                for (int l = 0; l < numActiveLevels; ++l)
+                {
+                    auto& level = levels[(size_t) l];
+                    auto& channel = level.channels[(size_t) ch];
+                    channel.window[(size_t) (level.partitionSize + level.fill + i)] = input;
+                    output += (SampleType) channel.output[(size_t) (level.fill + i)];
+                }
+
+                samples[i] = output;
+            }
+
+            if (ch == NUM_CHANNELS - 1)
+                headPosition = position;
+        }
+
+        start += length;
+
+        for (int l = 0; l < numActiveLevels; ++l)
+        {
+            auto& level = levels[(size_t) l];
+            level.fill += length;
+
+            if (level.fill < level.partitionSize)
+                continue;
+
+            if (l == LATE_LEVEL)
+            {
+                exchangeLateBlock();
+                continue;
+            }
+
+            auto& channels = level.channels;
+            processBlock (level, { channels[0].window.data(), channels[1].window.data() },
+                          { channels[0].output.data(), channels[1].output.data() }, fftBuffer, accumulator);
+
+            for (auto& channel : channels)
+                std::copy (channel.window.begin() + level.partitionSize, channel.window.end(), channel.window.begin());
+
+            level.fill = 0;
+        }
+
+        // Без активных уровней (короткая IR) счётчик самого мелкого блока ведётся отдельно
+        if (numActiveLevels == 0)
+            levels[0].fill = (levels[0].fill + length) % smallest;
+    }
+}
+
+template <typename SampleType>
+void PartitionedConvolution<SampleType>::processBlock (Level& level, const std::array<float*, NUM_CHANNELS>& windows,
+                                                       const std::array<float*, NUM_CHANNELS>& outputs,
+                                                       std::vector<float>& fftScratch,
+                                                       std::vector<float>& accumulatorScratch) noexcept
+{
+    const auto size = level.partitionSize;
+    const auto numBins = level.numBins;
+    const auto spectrumSize = 2 * numBins;
+
+    level.fdlPosition = level.fdlPosition + 1 == level.numPartitions ? 0 : level.fdlPosition + 1;
+
+    for (int ch = 0; ch < NUM_CHANNELS; ++ch)
+    {
+        auto& channel = level.channels[(size_t) ch];
+
+        // Overlap-save: спектр последних 2 * size семплов входа - в самый свежий слот FDL
+        std::copy (windows[(size_t) ch], windows[(size_t) ch] + 2 * size, fftScratch.begin());
+        std::fill (fftScratch.begin() + 2 * size, fftScratch.begin() + 4 * size, 0.0f);
+        level.fft->performRealOnlyForwardTransform (fftScratch.data(), true);
+
+        auto* newest = channel.fdl.data() + (size_t) (level.fdlPosition * spectrumSize);
+        deinterleave (fftScratch.data(), newest, newest + numBins, numBins);
+
+        // Сумма по разбиениям: вход k блоков назад x разбиение k
+        auto* accRe = accumulatorScratch.data();
+        auto* accIm = accumulatorScratch.data() + numBins;
+        std::fill (accumulatorScratch.begin(), accumulatorScratch.begin() + spectrumSize, 0.0f);
+
+        const auto* irSpectra = level.irSpectra.data() + (size_t) (ch * level.numPartitions * spectrumSize);
+
+        for (int k = 0, slot = level.fdlPosition; k < level.numPartitions; ++k, slot = slot == 0 ? level.numPartitions - 1 : slot - 1)
+        {
+            const auto* xRe = channel.fdl.data() + (size_t) (slot * spectrumSize);
+            const auto* xIm = xRe + numBins;
+            const auto* hRe = irSpectra + (size_t) (k * spectrumSize);
+            const auto* hIm = hRe + numBins;
+
+            for (int b = 0; b < numBins; ++b)
+            {
+                accRe[b] += xRe[b] * hRe[b] - xIm[b] * hIm[b];
+                accIm[b] += xRe[b] * hIm[b] + xIm[b] * hRe[b];
+            }
+        }
+
+        for (int b = 0; b < numBins; ++b)
+        {
+            fftScratch[(size_t) (2 * b)] = accRe[b];
+            fftScratch[(size_t) (2 * b + 1)] = accIm[b];
+        }
+
+        level.fft->performRealOnlyInverseTransform (fftScratch.data());
+
+        // Вторая половина окна - выход уровня на следующие size семплов
+        std::copy (fftScratch.begin() + size, fftScratch.begin() + 2 * size, outputs[(size_t) ch]);
+    }
+}
+
+//==============================================================================
+template <typename SampleType>
+void PartitionedConvolution<SampleType>::exchangeLateBlock() noexcept
+{
+    auto& level = levels[(size_t) LATE_LEVEL];
+    const auto size = level.partitionSize;
+    const auto submitted = lateSubmitted.load (std::memory_order_relaxed);
+
+    if (lateFlushing)
+    {
+        if (nonRealtime)
+            while (lateFlushRequested.load (std::memory_order_acquire) && isThreadRunning() && ! threadShouldExit())
+                juce::Thread::yield();
+
+        // Сброс подтверждён: очередь пуста, годятся только задания с этого места
+        if (! lateFlushRequested.load (std::memory_order_acquire))
+        {
+            lateFlushing = false;
+            lateFirstValid = submitted;
+        }
+    }
+
+    // Результат задания submitted - 1 звучит на следующем блоке - это и есть срок worker-а
+    bool ready = false;
+
+    if (! lateFlushing && submitted > lateFirstValid)
+    {
+        if (nonRealtime)
+            while (lateCompleted.load (std::memory_order_acquire) < submitted && isThreadRunning() && ! threadShouldExit())
+                juce::Thread::yield();
+
+        ready = lateCompleted.load (std::memory_order_acquire) >= submitted;
+
+        if (! ready)
+            missedSamples.fetch_add (size, std::memory_order_relaxed);
+    }
+
+    const auto& previous = lateJobs[(size_t) ((submitted - 1) % LATE_QUEUE_SIZE)];
+
+    for (int ch = 0; ch < NUM_CHANNELS; ++ch)
+    {
+        auto& output = level.channels[(size_t) ch].output;
+
+        if (ready)
+            std::copy (previous.output[(size_t) ch].begin(), previous.output[(size_t) ch].end(), output.begin());
+        else
+            std::fill (output.begin(), output.end(), 0.0f);
+    }
+
+    // Новый блок входа - worker-у; окно уровня на аудио-потоке не сдвигается (история - у worker-а)
+    if (! lateFlushing)
+    {
+        if (submitted - lateCompleted.load (std::memory_order_acquire) < (juce::uint32) LATE_QUEUE_SIZE)
+        {
+            auto& job = lateJobs[(size_t) (submitted % LATE_QUEUE_SIZE)];
+
+            for (int ch = 0; ch < NUM_CHANNELS; ++ch)
+            {
+                const auto& window = level.channels[(size_t) ch].window;
+                std::copy (window.begin() + size, window.end(), job.input[(size_t) ch].begin());
+            }
+
+            lateSubmitted.store (submitted + 1, std::memory_order_release);
+        }
+        else
+        {
+            requestLateFlush();  // worker отстал на всю очередь
+        }
+    }
+
+    level.fill = 0;
+}
+
+template <typename SampleType>
+void PartitionedConvolution<SampleType>::requestLateFlush() noexcept
+{
+    lateFlushing = true;
+    lateFlushRequested.store (true, std::memory_order_release);
+}
+
+//==============================================================================
+template <typename SampleType>
+void PartitionedConvolution<SampleType>::run()
+{
+    juce::ScopedNoDenormals noDenormals;
+
+    auto& level = levels[(size_t) LATE_LEVEL];
+    const auto size = level.partitionSize;
+    int idlePolls = 0;
+
+    while (! threadShouldExit())
+    {
+        if (lateFlushRequested.load (std::memory_order_acquire))
+        {
+            for (int ch = 0; ch < NUM_CHANNELS; ++ch)
+            {
+                std::fill (lateWindows[(size_t) ch].begin(), lateWindows[(size_t) ch].end(), 0.0f);
+                std::fill (level.channels[(size_t) ch].fdl.begin(), level.channels[(size_t) ch].fdl.end(), 0.0f);
+            }
+
+            level.fdlPosition = 0;
+            lateCompleted.store (lateSubmitted.load (std::memory_order_acquire), std::memory_order_release);
+            lateFlushRequested.store (false, std::memory_order_release);
+            idlePolls = 0;
+            continue;
+        }
+
+        const auto completed = lateCompleted.load (std::memory_order_relaxed);
+
+        // Аудио-поток worker не будит (никаких мьютексов и системных вызовов на его стороне).
+        // Заданий нет дольше, чем идут блоки (свёртка отыграла, стадия спит) - опрос реже
+        if (completed == lateSubmitted.load (std::memory_order_acquire))
+        {
+            if (idlePolls < IDLE_POLLS_BEFORE_BACKOFF)
+                ++idlePolls;
+
+            wait (idlePolls < IDLE_POLLS_BEFORE_BACKOFF ? POLL_INTERVAL_MS : IDLE_POLL_INTERVAL_MS);
+            continue;
+        }
+
+        idlePolls = 0;
+
+        auto& job = lateJobs[(size_t) (completed % LATE_QUEUE_SIZE)];
+
+        for (int ch = 0; ch < NUM_CHANNELS; ++ch)
+        {
+            auto& window = lateWindows[(size_t) ch];
+            std::copy (window.begin() + size, window.end(), window.begin());
+            std::copy (job.input[(size_t) ch].begin(), job.input[(size_t) ch].end(), window.begin() + size);
+        }
+
+        processBlock (level, { lateWindows[0].data(), lateWindows[1].data() },
+                      { job.output[0].data(), job.output[1].data() }, lateFftBuffer, lateAccumulator);
+
+        lateCompleted.store (completed + 1, std::memory_order_release);
+    }
+}
+
+//==============================================================================
+template class PartitionedConvolution<float>;
+template class PartitionedConvolution<double>;
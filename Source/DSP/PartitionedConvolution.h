@@ -0,0 +1,165 @@
+/*
+  ==============================================================================
+
+   PartitionedConvolution - свёртка с длинной IR без задержки
+   Голова IR - прямой FIR, дальше FFT-разбиения растущего размера
+   (64 / 512 / 4096): чем дальше от начала, тем реже и крупнее блоки.
+   Поздний хвост (4096) считает отдельный поток - в callback-е только ранние
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <juce_audio_processors/juce_audio_processors.h>
+#include <juce_dsp/juce_dsp.h>
+#include <array>
+#include <atomic>
+#include <memory>
+#include <vector>
+
+//==============================================================================
+/** Stereo convolution with a fixed impulse response, zero latency.
+
+    The IR is split non-uniformly into two stages:
+      - [0, 64)        direct-form FIR, sample by sample          (callback)
+      - [64, 512)      partitions of 64, FFT 128                  (callback)
+      - [512, 8192)    partitions of 512, FFT 1024                (callback)
+      - [8192, end)    partitions of 4096, FFT 8192               (worker thread)
+
+    An early level with partitions of P starts at IR offset P, so its
+    overlap-save block - computed once P new input samples are in - lands
+    exactly on the next P output samples. The late level starts at 2P
+    instead: the block computed from input block k is only heard one block
+    later, which is the worker's deadline (4096 samples). The callback just
+    hands the new input block over and picks up the previous result, so
+    its cost is flat and its worst case is the early levels'.
+
+    Each level keeps a frequency-domain delay line of its past input
+    spectra and multiplies it with the IR partition spectra (planar re / im,
+    one vectorisable loop).
+
+    A late result that is not ready when due is replaced by silence (the
+    late tail drops out for one block) and counted in getNumMissedSamples().
+    When the worker falls LATE_QUEUE_SIZE blocks behind, its queue and
+    delay line are flushed and it restarts in sync, like BackgroundSTFT.
+    Offline (setNonRealtime) the callback waits for the worker instead.
+    With no job for about a second the worker polls every 10 ms instead
+    of every millisecond.
+
+    Everything is allocated and the worker started in the constructor:
+    build it off the audio thread, then hand it over (ConvolutionReverb
+    does that). Spectra are float (juce::dsp::FFT); input and output keep
+    SampleType.
+*/
+template <typename SampleType>
+class PartitionedConvolution : private juce::Thread
+{
+public:
+    /** ir: one (used for both sides) or two channels, already at the processing rate. */
+    explicit PartitionedConvolution (const juce::AudioBuffer<float>& ir);
+    ~PartitionedConvolution() override;
+
+    /** Safe on the audio thread: the late stage is flushed by its worker. */
+    void reset() noexcept;
+
+    /** In place: left / right are replaced by the convolved signal (100% wet). */
+    void processStereo (SampleType* left, SampleType* right, int numSamples) noexcept;
+
+    int getLengthSamples() const noexcept  { return irLength; }
+
+    /** Offline rendering has no deadline: processStereo() waits for the late stage. */
+    void setNonRealtime (bool isNonRealtime) noexcept  { nonRealtime = isNonRealtime; }
+
+    /** Output samples whose late-stage result was not ready in time. */
+    int getNumMissedSamples() const noexcept  { return missedSamples.load (std::memory_order_relaxed); }
+
+    static constexpr int HEAD_SIZE = 64;
+    static constexpr int NUM_LEVELS = 3;
+    static constexpr int LEVEL_SIZES[NUM_LEVELS] = { 64, 512, 4096 };  // каждый делит следующий
+    static constexpr int LATE_LEVEL = NUM_LEVELS - 1;                   // на worker-е
+    static constexpr int LATE_QUEUE_SIZE = 4;                           // блоков, на которые worker может отстать
+
+    /** IR offset where a level starts: P for the early levels, 2P for the late one. */
+    static constexpr int getLevelOffset (int level) noexcept
+    {
+        return level == LATE_LEVEL ? 2 * LEVEL_SIZES[level] : LEVEL_SIZES[level];
+    }
+
+private:
+    static constexpr int NUM_CHANNELS = 2;
+
+    struct Level
+    {
+        int partitionSize = 0;
+        int numPartitions = 0;
+        int numBins = 0;        // partitionSize + 1
+        int fill = 0;           // новых семплов входа в текущем блоке
+        int fdlPosition = 0;    // слот самого свежего спектра
+        std::unique_ptr<juce::dsp::FFT> fft;
+
+        // Спектры разбиений IR: [channel][partition], каждый - numBins re, затем numBins im
+        std::vector<float> irSpectra;
+
+        struct Channel
+        {
+            std::vector<float> window;  // 2 * partitionSize: прошлый и текущий блок входа
+            std::vector<float> fdl;     // numPartitions спектров входа, кольцо
+            std::vector<float> output;  // partitionSize: выход этого уровня на текущий блок
+        };
+
+        std::array<Channel, NUM_CHANNELS> channels;
+    };
+
+    /** Overlap-save block of one level: windows (2P) -> outputs (P); scratch - FFT и сумма. */
+    void processBlock (Level& level, const std::array<float*, NUM_CHANNELS>& windows,
+                       const std::array<float*, NUM_CHANNELS>& outputs,
+                       std::vector<float>& fftScratch, std::vector<float>& accumulatorScratch) noexcept;
+
+    /** Audio thread, at a late block boundary: previous result -> output, new input -> worker. */
+    void exchangeLateBlock() noexcept;
+    void requestLateFlush() noexcept;
+
+    void run() override;
+
+    std::array<Level, NUM_LEVELS> levels;
+    int numActiveLevels = 0;
+    bool hasLateLevel = false;
+
+    // Голова: отводы от нового семпла к старому, история записана дважды - окно читается подряд
+    std::array<std::vector<float>, NUM_CHANNELS> headTaps;
+    std::array<std::vector<float>, NUM_CHANNELS> headHistory;
+    int headPosition = 0;
+
+    std::vector<float> fftBuffer;    // 2 * наибольший FFT ранних уровней (формат real-only FFT JUCE)
+    std::vector<float> accumulator;  // re, затем im
+
+    // Поздний уровень. Задание k: вход блока k -> результат, звучащий через блок.
+    // Слоты - кольцо LATE_QUEUE_SIZE; submitted пишет аудио-поток, completed - worker
+    struct LateJob
+    {
+        std::array<std::vector<float>, NUM_CHANNELS> input, output;  // partitionSize каждый
+    };
+
+    std::array<LateJob, LATE_QUEUE_SIZE> lateJobs;
+    std::atomic<juce::uint32> lateSubmitted { 0 }, lateCompleted { 0 };
+    std::atomic<bool> lateFlushRequested { false };
+    std::atomic<int> missedSamples { 0 };
+
+    // Аудио-поток: до подтверждения сброса результаты недействительны, после - с firstValid
+    bool lateFlushing = false;
+    juce::uint32 lateFirstValid = 0;
+    bool nonRealtime = false;
+
+    // Worker: своё окно входа и свои буферы FFT
+    std::array<std::vector<float>, NUM_CHANNELS> lateWindows;
+    std::vector<float> lateFftBuffer, lateAccumulator;
+
+    int irLength = 0;
+
+    static constexpr int POLL_INTERVAL_MS = 1;  // как у BackgroundSTFT: аудио-поток worker не будит
+    static constexpr int IDLE_POLL_INTERVAL_MS = 10;
+    static constexpr int IDLE_POLLS_BEFORE_BACKOFF = 1000;  // ~1 с: блок 4096 приходит чаще даже при 8 кГц
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (PartitionedConvolution)
+};
@@ -0,0 +1,119 @@
+/*
+  ==============================================================================
+
+   PredelayLine - стерео предзадержка реверба SpaceEngine
+   Кольцо степени двойки (индексы по маске), дробная задержка с ограниченной скоростью,
+   при неподвижной задержке - копирование блока двумя кусками
+
+  ==============================================================================
+*/
+
+#include "PredelayLine.h"
+#include <algorithm>
+#include <cmath>
+
+//==============================================================================
+template <typename SampleType>
+void PredelayLine<SampleType>::prepare (double sampleRate, double maximumDelaySeconds, int maximumBlockSize)
+{
+    jassert (sampleRate > 0 && maximumDelaySeconds >= 0);
+
+    maximumDelay = (int) std::ceil (maximumDelaySeconds * sampleRate);
+    maximumChunk = juce::jmax (1, maximumBlockSize);
+
+    const auto length = juce::nextPowerOfTwo (maximumDelay + maximumChunk + 1);
+    mask = length - 1;
+
+    for (auto& ring : rings)
+        ring.assign ((size_t) length, SampleType (0));
+
+    setDelay (targetDelay);
+    reset();
+}
+
+template <typename SampleType>
+void PredelayLine<SampleType>::reset()
+{
+    for (auto& ring : rings)
+        std::fill (ring.begin(), ring.end(), SampleType (0));
+
+    writePosition = 0;
+    currentDelay = targetDelay;
+}
+
+template <typename SampleType>
+void PredelayLine<SampleType>::setDelay (double delaySamples) noexcept
+{
+    // Цель - целое число семплов: после глайда задержка снова копируется без интерполяции
+    targetDelay = juce::jlimit (0, maximumDelay, (int) std::lround (delaySamples));
+}
+
+//==============================================================================
+template <typename SampleType>
+void PredelayLine<SampleType>::processStereo (SampleType* left, SampleType* right, int numSamples) noexcept
+{
+    jassert (mask > 0);  // prepare() не вызывался
+
+    // Блок длиннее обещанного в prepare() - кусками, чтобы запись не догнала чтение
+    for (int start = 0; start < numSamples; start += maximumChunk)
+        processChunk ({ left + start, right + start }, juce::jmin (maximumChunk, numSamples - start));
+}
+
+template <typename SampleType>
+void PredelayLine<SampleType>::processChunk (const std::array<SampleType*, NUM_CHANNELS>& channels, int numSamples) noexcept
+{
+    const auto length = mask + 1;
+    const auto start = writePosition;
+
+    // Сначала весь кусок в кольцо (задержка может быть короче куска): до конца кольца и с начала
+    const auto firstPart = juce::jmin (numSamples, length - start);
+
+    for (int ch = 0; ch < NUM_CHANNELS; ++ch)
+    {
+        auto* ring = rings[(size_t) ch].data();
+        std::copy (channels[(size_t) ch], channels[(size_t) ch] + firstPart, ring + start);
+        std::copy (channels[(size_t) ch] + firstPart, channels[(size_t) ch] + numSamples, ring);
+    }
+
+    writePosition = (start + numSamples) & mask;
+
+    if (currentDelay == (double) targetDelay)
+    {
+        // Задержка стоит и целая: чтение - те же два куска, со сдвигом назад
+        const auto readStart = (start + length - targetDelay) & mask;
+        const auto firstRead = juce::jmin (numSamples, length - readStart);
+
+        for (int ch = 0; ch < NUM_CHANNELS; ++ch)
+        {
+            const auto* ring = rings[(size_t) ch].data();
+            std::copy (ring + readStart, ring + readStart + firstRead, channels[(size_t) ch]);
+            std::copy (ring, ring + (numSamples - firstRead), channels[(size_t) ch] + firstRead);
+        }
+
+        return;
+    }
+
+    // Глайд: не быстрее MAX_GLIDE_RATE за семпл (цель достигается точно),
+    // дробная позиция - линейная интерполяция между соседними семплами
+    const auto* ringL = rings[0].data();
+    const auto* ringR = rings[1].data();
+    const auto target = (double) targetDelay;
+
+    for (int i = 0; i < numSamples; ++i)
+    {
+        currentDelay = currentDelay < target ? juce::jmin (currentDelay + MAX_GLIDE_RATE, target)
+                                             : juce::jmax (currentDelay - MAX_GLIDE_RATE, target);
+        const auto whole = (int) currentDelay;
+        const auto fraction = static_cast<SampleType> (currentDelay - whole);
+
+        const auto newer = (start + i + length - whole) & mask;
+        const auto older = (newer - 1) & mask;
+
+        channels[0][i] = ringL[newer] + fraction * (ringL[older] - ringL[newer]);
+        channels[1][i] = ringR[newer] + fraction * (ringR[older] - ringR[newer]);
+    }
+}
+
+//==============================================================================
+template class PredelayLine<float>;
+template class PredelayLine<double>;
@@ -0,0 +1,76 @@
+/*
+  ==============================================================================
+
+   PredelayLine - стерео предзадержка реверба SpaceEngine
+   Кольцо степени двойки (индексы по маске), дробная задержка с ограниченной скоростью,
+   при неподвижной задержке - копирование блока двумя кусками
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <juce_audio_processors/juce_audio_processors.h>
+#include <array>
+#include <vector>
+
+//==============================================================================
+/** Stereo delay line for the reverb predelay.
+
+    The ring buffer is a power of two long, sized in prepare() for the
+    maximum delay at the actual sample rate plus one block, so positions
+    wrap with a mask. Each block is first written into the ring and then
+    read back, which allows any delay from 0 to the maximum.
+
+    setDelay() targets are whole samples. The delay moves towards the
+    latest target by at most MAX_GLIDE_RATE samples per sample, so the
+    glide takes as long as the change needs (|change| / MAX_GLIDE_RATE)
+    and the read speed stays within 1 +- MAX_GLIDE_RATE: the reverb feed
+    is detuned by half a semitone at most while Depth moves, instead of
+    clicking. A new target mid-glide does not restart anything, the slew
+    just heads for it. During a glide every sample is read at its
+    fractional position (linear interpolation). Once the delay is settled
+    it is a whole number of samples, and a block is two contiguous copies
+    at most (split where the ring wraps) on the way in and again on the
+    way out.
+*/
+template <typename SampleType>
+class PredelayLine
+{
+public:
+    PredelayLine() = default;
+    ~PredelayLine() = default;
+
+    void prepare (double sampleRate, double maximumDelaySeconds, int maximumBlockSize);
+
+    /** Clears the ring; the delay jumps to its target, no glide. */
+    void reset();
+
+    /** Target delay in samples, rounded to whole samples and limited to the maximum. */
+    void setDelay (double delaySamples) noexcept;
+
+    /** Longest delay applied until the current glide ends, in samples. */
+    double getDelaySamples() const noexcept  { return juce::jmax (currentDelay, (double) targetDelay); }
+
+    /** In place: left / right are replaced by the delayed signal. */
+    void processStereo (SampleType* left, SampleType* right, int numSamples) noexcept;
+
+    /** Largest delay change per sample: read speed 1 +- 0.03, about +-0.5 semitone. */
+    static constexpr double MAX_GLIDE_RATE = 0.03;
+
+private:
+    static constexpr int NUM_CHANNELS = 2;
+
+    void processChunk (const std::array<SampleType*, NUM_CHANNELS>& channels, int numSamples) noexcept;
+
+    std::array<std::vector<SampleType>, NUM_CHANNELS> rings;
+    int mask = 0;            // длина кольца - 1
+    int writePosition = 0;
+    int maximumDelay = 0;    // семплов
+    int maximumChunk = 1;    // кольцо вмещает maximumDelay + кусок + 1 семпл на интерполяцию
+
+    double currentDelay = 0.0;  // семплов, во время глайда дробное
+    int targetDelay = 0;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (PredelayLine)
+};
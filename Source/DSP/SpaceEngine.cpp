@@ -11,21 +11,21 @@
 #include <cmath>
 
 //==============================================================================
-SpaceEngine::SpaceEngine()
+template <typename SampleType>
+SpaceEngine<SampleType>::SpaceEngine()
 {
-    // Initialize pre-delay buffers (max size for 48kHz)
-    auto maxDelaySamples = static_cast<int> (MAX_PREDELAY_MS * 0.001 * 48000.0);
-    predelayBufferL.setSize (1, maxDelaySamples);
-    predelayBufferR.setSize (1, maxDelaySamples);
-    predelayBufferL.clear();
-    predelayBufferR.clear();
+    // Pre-delay до prepare() - под частоту по умолчанию
+    predelay.prepare (sampleRate, MAX_PREDELAY_MS * 0.001, blockSize);
     // Initialize reverb parameters for male vocal
-    reverbParams.roomSize = 0.5f;
+    reverbParams.decaySeconds = MIN_DECAY_SEC;
     reverbParams.damping = 0.5f;
     reverbParams.wetLevel = 0.33f;
     reverbParams.dryLevel = 0.4f;
     reverbParams.width = 1.0f;
-    reverbParams.freezeMode = 0.0f;
+
+    // Параметры приходят каждые CONTROL_INTERVAL семплов - рампы ревербов той же длины
+    reverb.setRampLength (CONTROL_INTERVAL);
+    convolution.setRampLength (CONTROL_INTERVAL);
     
     // Initialize smoothers (30ms smoothing)
     depthSmoother.reset (44100.0, 0.03f);
@@ -40,11 +40,12 @@ SpaceEngine::SpaceEngine()
     depthParam = 0.0f;
     flowParam = 0.0f;
     ghostParam = 0.0f;
-    updateParameters();  // This will set wetLevel=0, roomSize=0.1
+    updateParameters();  // This will set wetLevel=0, decay=MIN_DECAY_SEC
 }
 
 //==============================================================================
-void SpaceEngine::prepare (const juce::dsp::ProcessSpec& spec)
+template <typename SampleType>
+void SpaceEngine<SampleType>::prepare (const juce::dsp::ProcessSpec& spec)
 {
     sampleRate = spec.sampleRate;
     blockSize = (int) spec.maximumBlockSize;
@@ -52,65 +53,73 @@ void SpaceEngine::prepare (const juce::dsp::ProcessSpec& spec)
     
     // Prepare reverb
     reverb.prepare (spec);
+    convolution.prepare (spec);
+
+    // Режим переживает prepare: доля свёртки сразу на целевом значении
+    modeBuffer.setSize (2, juce::jmax (1, blockSize));
+    convolutionMix.reset (sampleRate, MODE_CROSSFADE_SEC);
+    convolutionMix.setCurrentAndTargetValue (convolutionMix.getTargetValue());
     
-    // Prepare pre-delay buffers (enough for max pre-delay)
-    auto maxDelaySamples = static_cast<int> (MAX_PREDELAY_MS * 0.001 * sampleRate);
-    predelayBufferL.setSize (1, maxDelaySamples);
-    predelayBufferR.setSize (1, maxDelaySamples);
-    predelayBufferL.clear();
-    predelayBufferR.clear();
-    predelayWritePosL = 0;
-    predelayWritePosR = 0;
-    predelayReadPosL = 0;
-    predelayReadPosR = 0;
+    // Pre-delay: кольцо под MAX_PREDELAY_MS при новой частоте (и 192 кГц)
+    predelay.prepare (sampleRate, MAX_PREDELAY_MS * 0.001, blockSize);
     
     // Reset smoothers with new sample rate
     depthSmoother.reset (sampleRate, 0.03f);
     flowSmoother.reset (sampleRate, 0.03f);
     ghostSmoother.reset (sampleRate, 0.03f);
+    depthSmoother.setCurrentAndTargetValue (depthParam);
+    flowSmoother.setCurrentAndTargetValue (flowParam);
+    ghostSmoother.setCurrentAndTargetValue (ghostParam);
+    
+    // Звук стоит: параметры сразу на целях, задержка (в семплах - от частоты) - без глайда в reset()
+    updateParameters();
+    parametersDirty = false;
     
     reset();
 }
 
 //==============================================================================
-void SpaceEngine::reset()
+template <typename SampleType>
+void SpaceEngine<SampleType>::reset()
 {
     reverb.reset();
-    predelayBufferL.clear();
-    predelayBufferR.clear();
-    predelayWritePosL = 0;
-    predelayWritePosR = 0;
-    predelayReadPosL = 0;
-    predelayReadPosR = 0;
+    convolution.reset();
+    predelay.reset();
+    remainingTailSamples = 0;
 }
 
 //==============================================================================
-void SpaceEngine::setDepth (float depth)
+template <typename SampleType>
+void SpaceEngine<SampleType>::setDepth (float depth)
 {
     depthParam = juce::jlimit (0.0f, 1.0f, depth);
-    updateParameters();
+    parametersDirty = true;
 }
 
-void SpaceEngine::setFlow (float flow)
+template <typename SampleType>
+void SpaceEngine<SampleType>::setFlow (float flow)
 {
     flowParam = juce::jlimit (0.0f, 1.0f, flow);
-    updateParameters();
+    parametersDirty = true;
 }
 
-void SpaceEngine::setGhost (float ghost)
+template <typename SampleType>
+void SpaceEngine<SampleType>::setGhost (float ghost)
 {
     ghostParam = juce::jlimit (0.0f, 1.0f, ghost);
-    updateParameters();
+    parametersDirty = true;
+}
+
+template <typename SampleType>
+void SpaceEngine<SampleType>::loadImpulseResponse (const juce::AudioBuffer<float>& ir, double irSampleRate)
+{
+    convolution.loadImpulseResponse (ir, irSampleRate);
 }
 
 //==============================================================================
-void SpaceEngine::updateParameters()
+template <typename SampleType>
+void SpaceEngine<SampleType>::updateParameters()
 {
-    // Update smoothed values
-    depthSmoother.setTargetValue (depthParam);
-    flowSmoother.setTargetValue (flowParam);
-    ghostSmoother.setTargetValue (ghostParam);
-    
     // Depth controls: decay time, pre-delay, room size
     // Нелинейная кривая для более заметных изменений на больших значениях
     // Depth=0% → маленькая комната, Depth=100% → бездна
@@ -118,9 +127,8 @@ void SpaceEngine::updateParameters()
     auto depth = depthSmoother.getCurrentValue();
     auto depthCurved = std::pow (depth, 1.3f);  // Менее агрессивная кривая для более заметных изменений
     auto predelayMs = MIN_PREDELAY_MS + (MAX_PREDELAY_MS - MIN_PREDELAY_MS) * depthCurved;
-    // Room size: 0.1 (маленькая комната) → 0.95 (огромная) для более заметной разницы
-    // Сделано более заметным: 0.1 вместо 0.05 для лучшего контраста
-    auto roomSize = 0.1f + 0.85f * depthCurved;  // 0.1 to 0.95 (более заметный диапазон)
+    // Время спада: MIN_DECAY_SEC (маленькая комната) → MAX_DECAY_SEC (бездна)
+    auto decaySeconds = MIN_DECAY_SEC + (MAX_DECAY_SEC - MIN_DECAY_SEC) * depthCurved;
     
     // Flow controls: movement (LFO will be in MotionMod, here we adjust width and damping)
     // Нелинейная кривая для более заметного эффекта на больших значениях
@@ -145,106 +153,193 @@ void SpaceEngine::updateParameters()
     damping = juce::jlimit (MIN_DAMPING, MAX_DAMPING, damping);
     
     // Update reverb parameters
-    reverbParams.roomSize = roomSize;
+    reverbParams.decaySeconds = decaySeconds;
     reverbParams.damping = damping;
     reverbParams.wetLevel = wetLevel;
     reverbParams.dryLevel = dryLevel;
     reverbParams.width = stereoWidth;
     
-    // Note: pre-delay is applied manually in process() using predelayMs
-    // predelayMs is calculated above and used in process() per-sample
-    
     reverb.setParameters (reverbParams);
+    predelay.setDelay (predelayMs * 0.001 * sampleRate);
+
+    // Свёртка: те же Ghost (wet) и ширина; decay и damping задаёт сама IR
+    convolutionParams.wetLevel = wetLevel;
+    convolutionParams.width = stereoWidth;
+    convolution.setParameters (convolutionParams);
 }
 
 //==============================================================================
-void SpaceEngine::process (juce::AudioBuffer<float>& buffer)
+template <typename SampleType>
+void SpaceEngine<SampleType>::process (juce::AudioBuffer<SampleType>& buffer)
 {
     auto numSamples = buffer.getNumSamples();
     
     if (numChannels < 2 || numSamples == 0)
         return;
     
-    // Update smoothed parameters
-    depthSmoother.skip (numSamples);
-    flowSmoother.skip (numSamples);
-    ghostSmoother.skip (numSamples);
-    
-    // Get current smoothed values
-    auto currentDepth = depthSmoother.getCurrentValue();
-    auto currentFlow = flowSmoother.getCurrentValue();
-    auto currentGhost = ghostSmoother.getCurrentValue();
+    if (parametersDirty)
+    {
+        depthSmoother.setTargetValue (depthParam);
+        flowSmoother.setTargetValue (flowParam);
+        ghostSmoother.setTargetValue (ghostParam);
+    }
     
     // If Ghost is zero (no reverb), skip processing entirely (pass through)
     // Depth alone doesn't enable reverb - Ghost controls wet level
-    if (currentGhost < 0.001f)
+    if (ghostSmoother.getCurrentValue() < 0.001f && ! ghostSmoother.isSmoothing())
+    {
+        depthSmoother.skip (numSamples);
+        flowSmoother.skip (numSamples);
+        remainingTailSamples = 0;
         return;
+    }
     
-    // Update reverb parameters if they changed significantly
-    // (JUCE reverb doesn't support per-sample updates, so we update once per block)
-    if (std::abs (currentDepth - depthParam) > 0.001f ||
-        std::abs (currentFlow - flowParam) > 0.001f ||
-        std::abs (currentGhost - ghostParam) > 0.001f)
+    // Уровень входа (до предзадержки) - для оценки хвоста после реверба
+    auto inputLevel = juce::jmax (buffer.getMagnitude (0, 0, numSamples), buffer.getMagnitude (1, 0, numSamples));
+    
+    // Pre-delay + reverb
+    auto* left = buffer.getWritePointer (0);
+    auto* right = buffer.getWritePointer (1);
+    
+    if (depthSmoother.isSmoothing() || flowSmoother.isSmoothing() || ghostSmoother.isSmoothing())
     {
-        depthParam = currentDepth;
-        flowParam = currentFlow;
-        ghostParam = currentGhost;
-        updateParameters();
+        // Автоматизация: точки кривой сглаживателей раз в CONTROL_INTERVAL, между ними
+        // ревербы идут рампой той же длины - параметры меняются по семплу, без ступенек на блок
+        for (int start = 0; start < numSamples; start += CONTROL_INTERVAL)
+        {
+            const auto length = juce::jmin (CONTROL_INTERVAL, numSamples - start);
+            depthSmoother.skip (length);
+            flowSmoother.skip (length);
+            ghostSmoother.skip (length);
+            updateParameters();
+            predelay.processStereo (left + start, right + start, length);
+            processReverb (left + start, right + start, length);
+        }
+    }
+    else
+    {
+        // Параметры стоят: пересчёт, только если цели сменились (и сглаживатели уже на них)
+        if (parametersDirty)
+            updateParameters();
+        
+        predelay.processStereo (left, right, numSamples);
+        processReverb (left, right, numSamples);
     }
     
-    // Use curved depth for pre-delay calculation (consistent with updateParameters)
-    auto depthCurved = std::pow (currentDepth, 1.5f);
-    auto predelayMs = MIN_PREDELAY_MS + (MAX_PREDELAY_MS - MIN_PREDELAY_MS) * depthCurved;
-    auto predelaySamplesInt = static_cast<int> (predelayMs * 0.001 * sampleRate);
+    parametersDirty = false;
     
-    // Apply pre-delay to preserve male vocal clarity
-    auto maxDelay = predelayBufferL.getNumSamples();
+    // Оценка хвоста по уровню входа при уже применённых параметрах: громкий вход
+    // продлевает хвост, тишина только отсчитывает оставшееся время спада
+    remainingTailSamples = juce::jmax (0, remainingTailSamples - numSamples);
     
-    if (predelaySamplesInt > 0 && predelaySamplesInt < maxDelay && numChannels >= 2)
+    if (inputLevel > static_cast<SampleType> (SILENCE_LEVEL))
     {
-        auto* leftChannel = buffer.getWritePointer (0);
-        auto* rightChannel = buffer.getWritePointer (1);
-        auto* delayL = predelayBufferL.getWritePointer (0);
-        auto* delayR = predelayBufferR.getWritePointer (0);
-        
-        // Update read position based on delay
-        // Read position is (writePos - delaySamples) mod maxDelay
-        predelayReadPosL = (predelayWritePosL - predelaySamplesInt + maxDelay) % maxDelay;
-        predelayReadPosR = (predelayWritePosR - predelaySamplesInt + maxDelay) % maxDelay;
-        
-        // Simple circular buffer pre-delay
-        // IMPORTANT: We need to write first, then read, to avoid reading zeros on first pass
-        for (int sample = 0; sample < numSamples; ++sample)
+        auto tailSamples = std::ceil (getDecaySeconds (static_cast<double> (inputLevel)) * sampleRate);
+        remainingTailSamples = juce::jmax (remainingTailSamples, static_cast<int> (juce::jmin (tailSamples, 1.0e9)));
+    }
+}
+
+template <typename SampleType>
+void SpaceEngine<SampleType>::processReverb (SampleType* left, SampleType* right, int numSamples) noexcept
+{
+    const auto target = static_cast<SampleType> (convolutionMode && convolution.hasImpulseResponse() ? 1 : 0);
+
+    if (target != convolutionMix.getTargetValue())
+    {
+        // Включаемый реверб стоял - его старое состояние не должно прозвучать
+        if (! convolutionMix.isSmoothing())
         {
-            // Save current sample before writing
-            auto currentL = leftChannel[sample];
-            auto currentR = rightChannel[sample];
-            
-            // Write current samples to delay buffer FIRST
-            delayL[predelayWritePosL] = currentL;
-            delayR[predelayWritePosR] = currentR;
-            
-            // Update write positions
-            predelayWritePosL = (predelayWritePosL + 1) % maxDelay;
-            predelayWritePosR = (predelayWritePosR + 1) % maxDelay;
-            
-            // Read delayed samples (from previous write)
-            auto delayedL = delayL[predelayReadPosL];
-            auto delayedR = delayR[predelayReadPosR];
-            
-            // Update read positions
-            predelayReadPosL = (predelayReadPosL + 1) % maxDelay;
-            predelayReadPosR = (predelayReadPosR + 1) % maxDelay;
-            
-            // Apply delayed signal (replace current with delayed)
-            leftChannel[sample] = delayedL;
-            rightChannel[sample] = delayedR;
+            if (target > 0)
+                convolution.reset();
+            else
+                reverb.reset();
         }
+
+        convolutionMix.setTargetValue (target);
     }
-    
-    // Process through reverb
-    juce::dsp::AudioBlock<float> block (buffer);
-    juce::dsp::ProcessContextReplacing<float> context (block);
-    reverb.process (context);
+
+    if (! convolutionMix.isSmoothing())
+    {
+        if (convolutionMix.getCurrentValue() > 0)
+            convolution.processStereo (left, right, numSamples);
+        else
+            reverb.processStereo (left, right, numSamples);
+
+        return;
+    }
+
+    // Кроссфейд режимов: FDN на месте, свёртка - в modeBuffer
+    auto* convolutionL = modeBuffer.getWritePointer (0);
+    auto* convolutionR = modeBuffer.getWritePointer (1);
+
+    for (int start = 0; start < numSamples; start += modeBuffer.getNumSamples())
+    {
+        const auto length = juce::jmin (modeBuffer.getNumSamples(), numSamples - start);
+        auto* l = left + start;
+        auto* r = right + start;
+
+        std::copy (l, l + length, convolutionL);
+        std::copy (r, r + length, convolutionR);
+        reverb.processStereo (l, r, length);
+        convolution.processStereo (convolutionL, convolutionR, length);
+
+        for (int i = 0; i < length; ++i)
+        {
+            const auto mix = convolutionMix.getNextValue();
+            l[i] += (convolutionL[i] - l[i]) * mix;
+            r[i] += (convolutionR[i] - r[i]) * mix;
+        }
+    }
+}
+
+//==============================================================================
+template <typename SampleType>
+double SpaceEngine<SampleType>::getTailLengthSeconds() const noexcept
+{
+    if (! isActive())
+        return 0.0;
+
+    // Сигнал 0 dBFS: предзадержка + спад реверба до -120 dBFS
+    return getDecaySeconds (1.0);
 }
 
+template <typename SampleType>
+double SpaceEngine<SampleType>::getDecaySeconds (double inputLevel) const noexcept
+{
+    auto predelaySeconds = predelay.getDelaySamples() / sampleRate;
+    auto reverbSeconds = 0.0;
+
+    // Свёртка замолкает ровно через длину IR после входа (хвост IR обрезан на -120 дБ)
+    if (convolutionMix.getCurrentValue() > 0 || convolutionMix.getTargetValue() > 0)
+        reverbSeconds = convolution.getTailLengthSeconds();
+
+    if (convolutionMix.getCurrentValue() < 1 || convolutionMix.getTargetValue() < 1)
+    {
+        // Не juce::Decibels - он обрезает на -100 дБ, а нам нужно до -120
+        // Реверб может накопить энергию выше уровня входа - учитываем верхнюю оценку усиления
+        auto decayDb = 20.0 * std::log10 (inputLevel / SILENCE_LEVEL) + reverb.getPeakGainDb();
+
+        if (decayDb > 0.0)
+            reverbSeconds = juce::jmax (reverbSeconds, reverb.getDecayTimeSeconds (decayDb));
+    }
+
+    return predelaySeconds + reverbSeconds;
+}
+
+template <typename SampleType>
+bool SpaceEngine<SampleType>::hasTail() const noexcept
+{
+    return isActive() && remainingTailSamples > 0;
+}
+
+//==============================================================================
+template <typename SampleType>
+bool SpaceEngine<SampleType>::isActive() const noexcept
+{
+    // Ghost управляет wet level - при Ghost = 0 реверб не слышен
+    return ghostParam >= 0.001f || ghostSmoother.getCurrentValue() >= 0.001f;
+}
+
+//==============================================================================
+template class SpaceEngine<float>;
+template class SpaceEngine<double>;
@@ -11,8 +11,12 @@
 
 #include <juce_audio_processors/juce_audio_processors.h>
 #include <juce_dsp/juce_dsp.h>
+#include "FdnReverb.h"
+#include "ConvolutionReverb.h"
+#include "PredelayLine.h"
 
 //==============================================================================
+template <typename SampleType>
 class SpaceEngine
 {
 public:
@@ -21,24 +25,63 @@ public:
 
     void prepare (const juce::dsp::ProcessSpec& spec);
     void reset();
-    void process (juce::AudioBuffer<float>& buffer);
+    void process (juce::AudioBuffer<SampleType>& buffer);
+
+    // true, если process() сейчас меняет сигнал (иначе планировщик процессора пропускает модуль)
+    bool isActive() const noexcept;
 
     // Parameter control (normalized 0.0-1.0)
+    // Сеттеры только запоминают цель - параметры ревербов пересчитывает process()
     void setDepth (float depth);      // 0.0 = close, 1.0 = deep space
     void setFlow (float flow);        // 0.0 = static, 1.0 = moving
     void setGhost (float ghost);      // 0.0 = no reflections, 1.0 = dense reflections
 
+    // Режим свёртки: вместо FDN - загруженная IR (та же предзадержка, Ghost и ширина).
+    // Без загруженной IR остаётся FDN; переключение - кроссфейд MODE_CROSSFADE_SEC
+    void setConvolutionMode (bool shouldUseConvolution) noexcept  { convolutionMode = shouldUseConvolution; }
+
+    /** Not on the audio thread: builds the convolution and hands it to the audio thread lock-free. */
+    void loadImpulseResponse (const juce::AudioBuffer<float>& ir, double irSampleRate);
+
+    /** Not on the audio thread: frees the convolution replaced by the last load (ConvolutionReverb::releaseRetired). */
+    void releaseRetiredImpulseResponse()  { convolution.releaseRetired(); }
+
+    /** Audio stopped: frees the convolution and its worker, the IR is kept for the next prepare(). */
+    void release()  { convolution.release(); }
+
+    // Offline рендер: поздний хвост свёртки (worker) ждём, а не пропускаем
+    void setNonRealtime (bool isNonRealtime) noexcept  { convolution.setNonRealtime (isNonRealtime); }
+
+    // Хвост (предзадержка + реверб) - для sleep-режима процессора
+    double getTailLengthSeconds() const noexcept;   // от 0 dBFS до SILENCE_LEVEL при текущих настройках
+    bool hasTail() const noexcept;                  // в предзадержке/реверберации ещё есть энергия выше SILENCE_LEVEL
+
+    static constexpr float SILENCE_LEVEL = 1.0e-6f;  // -120 dBFS
+
 private:
-    void updateParameters();
+    void updateParameters();  // текущие сглаженные Depth / Flow / Ghost -> параметры FDN и свёртки
+    double getDecaySeconds (double inputLevel) const noexcept;  // предзадержка + спад от inputLevel до SILENCE_LEVEL
+    void processReverb (SampleType* left, SampleType* right, int numSamples) noexcept;
 
-    juce::dsp::Reverb reverb;
-    juce::dsp::Reverb::Parameters reverbParams;
+    // FDN: время спада задаётся напрямую (до MAX_DECAY_SEC), float и double - один алгоритм
+    FdnReverb<SampleType> reverb;
+    typename FdnReverb<SampleType>::Parameters reverbParams;
+
+    // Свёртка с IR; convolutionMix - доля свёртки (0 - FDN, 1 - свёртка), во время
+    // кроссфейда работают оба, выход свёртки - в modeBuffer
+    ConvolutionReverb<SampleType> convolution;
+    typename ConvolutionReverb<SampleType>::Parameters convolutionParams;
+    bool convolutionMode = false;
+    juce::LinearSmoothedValue<SampleType> convolutionMix;
+    juce::AudioBuffer<SampleType> modeBuffer;
+    
+    // Pre-delay for male vocal clarity: кольцо под MAX_PREDELAY_MS при текущей частоте,
+    // задержка следует за Depth плавно (дробная), неподвижная - копируется блоком
+    PredelayLine<SampleType> predelay;
     
-    // Pre-delay for male vocal clarity (100-150 ms optimal)
-    // Using simple delay buffers for now (can be improved with proper DelayLine later)
-    juce::AudioBuffer<float> predelayBufferL, predelayBufferR;
-    int predelayWritePosL = 0, predelayWritePosR = 0;
-    int predelayReadPosL = 0, predelayReadPosR = 0;
+    // Оценка энергии хвоста: сколько семплов осталось до -120 dBFS после последнего
+    // громкого входа (считается от уровня входа по времени спада реверба)
+    int remainingTailSamples = 0;
     
     // Stereo width control
     float stereoWidth = 1.0f;
@@ -49,7 +92,10 @@ private:
     float ghostParam = 0.0f;
     
     // Smoothed parameters to prevent clicks
+    // Пока сглаживатели идут, process() пересчитывает параметры ревербов каждые
+    // CONTROL_INTERVAL семплов, а ревербы доходят до них рампой той же длины
     juce::LinearSmoothedValue<float> depthSmoother, flowSmoother, ghostSmoother;
+    bool parametersDirty = true;  // цели изменились, сглаживатели их ещё не получили
     
     double sampleRate = 44100.0;
     int blockSize = 512;
@@ -63,6 +109,8 @@ private:
     static constexpr float MAX_DECAY_SEC = 20.0f;     // Iceberg can go up to 20 sec
     static constexpr float MIN_DAMPING = 0.3f;        // Less damping for male voice (lower frequencies)
     static constexpr float MAX_DAMPING = 0.7f;
+    static constexpr double MODE_CROSSFADE_SEC = 0.05;
+    static constexpr int CONTROL_INTERVAL = 64;  // семплов между пересчётами параметров
     
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (SpaceEngine)
 };
@@ -0,0 +1,166 @@
+/*
+  ==============================================================================
+
+   SpectralAnalyzer - общий спектральный анализ в начале цепочки
+   Один FFT на hop для всех: модули читают результат напрямую,
+   редактор - копию через TripleBuffer
+
+  ==============================================================================
+*/
+
+#include "SpectralAnalyzer.h"
+
+//==============================================================================
+template <typename SampleType>
+void SpectralAnalyzer<SampleType>::prepare (const juce::dsp::ProcessSpec& spec)
+{
+    constexpr auto fftSize = SpectralAnalysis::FFT_SIZE;
+
+    fft = std::make_unique<juce::dsp::FFT> (SpectralAnalysis::FFT_ORDER);
+    input.assign ((size_t) fftSize, 0.0f);
+    frame.assign ((size_t) (2 * fftSize), 0.0f);
+    window.resize ((size_t) fftSize);
+
+    // Периодический Hann; 2 / sum - пик синуса равен его амплитуде
+    const auto pi = juce::MathConstants<double>::pi;
+    double sum = 0.0;
+
+    for (int i = 0; i < fftSize; ++i)
+        sum += 0.5 - 0.5 * std::cos (2.0 * pi * i / fftSize);
+
+    for (int i = 0; i < fftSize; ++i)
+        window[(size_t) i] = (float) ((0.5 - 0.5 * std::cos (2.0 * pi * i / fftSize)) * 2.0 / sum);
+
+    analysis.sampleRate = (float) spec.sampleRate;
+    bandOfBin.resize ((size_t) SpectralAnalysis::NUM_BINS);
+
+    for (int bin = 0, band = 0; bin < SpectralAnalysis::NUM_BINS; ++bin)
+    {
+        while (band + 1 < SpectralAnalysis::NUM_BANDS
+               && analysis.getBinFrequency (bin) >= SpectralAnalysis::BAND_LOWER_EDGES_HZ[band + 1])
+            ++band;
+
+        bandOfBin[(size_t) bin] = band;
+    }
+
+    reset();
+}
+
+template <typename SampleType>
+void SpectralAnalyzer<SampleType>::reset() noexcept
+{
+    std::fill (input.begin(), input.end(), 0.0f);
+
+    analysis.magnitudes.fill (0.0f);
+    analysis.bandEnergies.fill (0.0f);
+    analysis.centroidHz = 0.0f;
+    analysis.flatness = 0.0f;
+    ++analysis.frameIndex;  // читатели должны увидеть обнулённый результат
+
+    position = 0;
+    hopPosition = 0;
+}
+
+//==============================================================================
+template <typename SampleType>
+void SpectralAnalyzer<SampleType>::process (const juce::AudioBuffer<SampleType>& buffer) noexcept
+{
+    const auto numChannels = buffer.getNumChannels();
+    const auto numSamples = buffer.getNumSamples();
+
+    if (numChannels == 0 || fft == nullptr)
+        return;
+
+    const auto channelGain = 1.0f / (float) numChannels;
+
+    for (int i = 0; i < numSamples;)
+    {
+        // До конца hop или блока - без проверок внутри цикла
+        const auto count = juce::jmin (numSamples - i, SpectralAnalysis::HOP_SIZE - hopPosition,
+                                       SpectralAnalysis::FFT_SIZE - position);
+
+        for (int ch = 0; ch < numChannels; ++ch)
+        {
+            const auto* data = buffer.getReadPointer (ch, i);
+            auto* ring = input.data() + position;
+
+            if (ch == 0)
+                for (int k = 0; k < count; ++k)
+                    ring[k] = (float) data[k] * channelGain;
+            else
+                for (int k = 0; k < count; ++k)
+                    ring[k] += (float) data[k] * channelGain;
+        }
+
+        i += count;
+        position = (position + count) & (SpectralAnalysis::FFT_SIZE - 1);
+        hopPosition += count;
+
+        if (hopPosition == SpectralAnalysis::HOP_SIZE)
+        {
+            hopPosition = 0;
+            analyseFrame();
+        }
+    }
+}
+
+template <typename SampleType>
+void SpectralAnalyzer<SampleType>::analyseFrame() noexcept
+{
+    constexpr auto fftSize = SpectralAnalysis::FFT_SIZE;
+    constexpr auto numBins = SpectralAnalysis::NUM_BINS;
+
+    // Кольцо разворачивается от самого старого семпла (position) к новому
+    const auto tail = fftSize - position;
+
+    for (int i = 0; i < tail; ++i)
+        frame[(size_t) i] = input[(size_t) (position + i)] * window[(size_t) i];
+
+    for (int i = 0; i < position; ++i)
+        frame[(size_t) (tail + i)] = input[(size_t) i] * window[(size_t) (tail + i)];
+
+    fft->performRealOnlyForwardTransform (frame.data(), true);
+
+    analysis.bandEnergies.fill (0.0f);
+
+    double magnitudeSum = 0.0, weightedSum = 0.0, powerSum = 0.0, logPowerSum = 0.0;
+
+    for (int bin = 0; bin < numBins; ++bin)
+    {
+        const auto re = frame[(size_t) (2 * bin)];
+        const auto im = frame[(size_t) (2 * bin + 1)];
+        const auto power = re * re + im * im;
+        const auto magnitude = std::sqrt (power);
+
+        analysis.magnitudes[(size_t) bin] = magnitude;
+        analysis.bandEnergies[(size_t) bandOfBin[(size_t) bin]] += power;
+
+        // DC и Найквист не участвуют: смещение и окно не должны двигать центроид
+        if (bin == 0 || bin == numBins - 1)
+            continue;
+
+        magnitudeSum += magnitude;
+        weightedSum += magnitude * (double) bin;
+        powerSum += power;
+        logPowerSum += std::log ((double) power + SILENCE_POWER);
+    }
+
+    constexpr auto numAnalysed = (double) (numBins - 2);
+
+    if (powerSum / numAnalysed > SILENCE_POWER)
+    {
+        analysis.centroidHz = (float) (weightedSum / magnitudeSum) * analysis.getBinFrequency (1);
+        analysis.flatness = juce::jlimit (0.0f, 1.0f, (float) (std::exp (logPowerSum / numAnalysed) / (powerSum / numAnalysed)));
+    }
+    else
+    {
+        analysis.centroidHz = 0.0f;
+        analysis.flatness = 0.0f;
+    }
+
+    ++analysis.frameIndex;
+}
+
+//==============================================================================
+template class SpectralAnalyzer<float>;
+template class SpectralAnalyzer<double>;
@@ -0,0 +1,84 @@
+/*
+  ==============================================================================
+
+   SpectralAnalyzer - общий спектральный анализ в начале цепочки
+   Один FFT на hop для всех: модули читают результат напрямую,
+   редактор - копию через TripleBuffer
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <juce_audio_processors/juce_audio_processors.h>
+#include <juce_dsp/juce_dsp.h>
+#include <array>
+#include <memory>
+#include <vector>
+
+//==============================================================================
+/** Result of the latest analysis frame. Fixed size and trivially copyable, so it
+    can be handed to the editor by value (TripleBuffer) without allocating.
+*/
+struct SpectralAnalysis
+{
+    static constexpr int FFT_ORDER = 10;
+    static constexpr int FFT_SIZE = 1 << FFT_ORDER;
+    static constexpr int HOP_SIZE = FFT_SIZE / 4;
+    static constexpr int NUM_BINS = FFT_SIZE / 2 + 1;
+
+    // Октавные полосы: нижние границы, последняя - до Найквиста
+    static constexpr int NUM_BANDS = 8;
+    static constexpr float BAND_LOWER_EDGES_HZ[NUM_BANDS] = { 0.0f, 125.0f, 250.0f, 500.0f, 1000.0f, 2000.0f, 4000.0f, 8000.0f };
+
+    std::array<float, NUM_BINS> magnitudes {};      // синус с амплитудой A даёт A в своём бине
+    std::array<float, NUM_BANDS> bandEnergies {};   // сумма квадратов амплитуд по полосе
+    float centroidHz = 0.0f;                        // центр тяжести амплитуд, 0 в тишине
+    float flatness = 0.0f;                          // геометрическое / арифметическое среднее мощности: ~0 - тон, ~0.5 - белый шум
+    float sampleRate = 44100.0f;
+    juce::uint32 frameIndex = 0;                    // растёт на каждый кадр: новый ли результат
+
+    float getBinFrequency (int bin) const noexcept  { return (float) bin * sampleRate / (float) FFT_SIZE; }
+};
+
+//==============================================================================
+/** Analyses the input of the processing chain: one Hann-windowed FFT of the
+    channel average every HOP_SIZE samples, independent of any module's own
+    transforms or latency tier.
+
+    process() never changes the buffer. getAnalysis() returns the latest
+    frame; read it on the audio thread only (modules), or copy it out
+    through a TripleBuffer for other threads (the editor).
+*/
+template <typename SampleType>
+class SpectralAnalyzer
+{
+public:
+    SpectralAnalyzer() = default;
+
+    void prepare (const juce::dsp::ProcessSpec& spec);
+    void reset() noexcept;
+
+    /** Read-only: buffer is analysed, not modified. */
+    void process (const juce::AudioBuffer<SampleType>& buffer) noexcept;
+
+    const SpectralAnalysis& getAnalysis() const noexcept  { return analysis; }
+
+private:
+    void analyseFrame() noexcept;
+
+    std::unique_ptr<juce::dsp::FFT> fft;
+    std::vector<float> input;           // последние FFT_SIZE семплов (среднее каналов), кольцо
+    std::vector<float> frame;           // 2 * FFT_SIZE: формат real-only FFT JUCE
+    std::vector<float> window;          // Hann с нормировкой 2 / sum: амплитуда синуса в бине
+    std::vector<int> bandOfBin;
+
+    SpectralAnalysis analysis;
+
+    int position = 0;
+    int hopPosition = 0;
+
+    static constexpr float SILENCE_POWER = 1.0e-12f;  // -120 дБ: ниже центроид и flatness - 0
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (SpectralAnalyzer)
+};
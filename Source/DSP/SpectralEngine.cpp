@@ -10,22 +10,11 @@
 #include "SpectralEngine.h"
 
 //==============================================================================
-SpectralEngine::SpectralEngine()
-    // ВРЕМЕННО: FFT отключен (вызывает зависание)
-    // : fft (std::make_unique<juce::dsp::FFT> (static_cast<int> (std::log2 (fftSize))))
+template <typename SampleType>
+SpectralEngine<SampleType>::SpectralEngine()
 {
-    // ВРЕМЕННО: FFT буферы отключены (вызывают зависание)
-    // fftBuffer.resize (fftSize * 2, 0.0f);
-    // windowBuffer.resize (fftSize, 0.0f);
-    // inputBuffer.resize (fftSize, 0.0f);
-    // outputBuffer.resize (fftSize, 0.0f);
-    // overlapBuffer.resize (overlapSize, 0.0f);
-    
-    // Create Hann window для плавного перекрытия
-    // for (int i = 0; i < fftSize; ++i)
-    // {
-    //     windowBuffer[i] = 0.5f * (1.0f - std::cos (2.0f * juce::MathConstants<float>::pi * i / (fftSize - 1)));
-    // }
+    // Вокальные шины всегда стерео: одно комплексное FFT вместо двух вещественных
+    stft.setStereoPacking (true);
     
     // Initialize smoothers (30ms smoothing)
     claritySmoother.reset (44100.0, 0.03f);
@@ -35,31 +24,36 @@ SpectralEngine::SpectralEngine()
     claritySmoother.setCurrentAndTargetValue (0.0f);
     depthSmoother.setCurrentAndTargetValue (0.0f);
     flowSmoother.setCurrentAndTargetValue (0.0f);
-    
-    inputBufferPos = 0;
-    outputBufferPos = 0;
 }
 
 //==============================================================================
-void SpectralEngine::prepare (const juce::dsp::ProcessSpec& spec)
+template <typename SampleType>
+void SpectralEngine<SampleType>::prepare (const juce::dsp::ProcessSpec& spec)
 {
     sampleRate = spec.sampleRate;
     blockSize = (int) spec.maximumBlockSize;
     numChannels = static_cast<int> (spec.numChannels);
     
-    // Prepare EQ chain - КРИТИЧНО: prepare должен вызываться перед reset
-    // Это гарантирует, что фильтры инициализируются правильно для стерео
-    eqChain.prepare (spec);
+    // Состояние фильтров - на каждый канал
+    eqCascade.prepare (numChannels);
+    
+    // Таблицы коэффициентов EQ зависят от частоты дискретизации
+    prepareFilterTables();
+    
+    // Все буферы формант-шифта выделяются здесь, не в аудио-потоке.
+    // Worker (если был) останавливается до того, как STFT пересоздаётся
+    backgroundStft.release();
+    
+    // Режим полос: тот же шаг по частоте и длина кадра во времени, но FFT в splitFactor раз меньше
+    splitFactor = 1;
     
-    // Убеждаемся, что все фильтры в цепочке сброшены и имеют одинаковое состояние
-    eqChain.reset();
+    if (splitBandProcessing && sampleRate >= SPLIT_BAND_MIN_HOST_RATE)
+        while (sampleRate / (2 * splitFactor) >= SPLIT_BAND_MIN_RATE)
+            splitFactor *= 2;
     
-    // ВРЕМЕННО: FFT буферы отключены
-    // std::fill (inputBuffer.begin(), inputBuffer.end(), 0.0f);
-    // std::fill (outputBuffer.begin(), outputBuffer.end(), 0.0f);
-    // std::fill (overlapBuffer.begin(), overlapBuffer.end(), 0.0f);
-    inputBufferPos = 0;
-    outputBufferPos = 0;
+    const auto fftOrder = TIER_FFT_ORDERS[latencyTier] - juce::roundToInt (std::log2 (splitFactor));
+    stft.prepare (numChannels, fftOrder, (1 << fftOrder) / 4);
+    formantShifter.prepare (fftOrder, sampleRate / splitFactor);
     
     // Reset smoothers with new sample rate
     claritySmoother.reset (sampleRate, 0.03f);
@@ -67,247 +61,337 @@ void SpectralEngine::prepare (const juce::dsp::ProcessSpec& spec)
     flowSmoother.reset (sampleRate, 0.03f);
     
     reset();
+    
+    const auto stftBlockSize = splitFactor > 1 ? blockSize / splitFactor + 1 : blockSize;
+    
+    if (backgroundProcessing)
+        backgroundStft.prepare (stft, numChannels, stftBlockSize, sampleRate / splitFactor);
+    
+    // Задержка нижней полосы известна только после запуска worker-а
+    if (splitFactor > 1)
+    {
+        bandSplit.prepare (numChannels, splitFactor, blockSize, getStftLatencySamples());
+        lowBand.setSize (numChannels, bandSplit.getMaxLowBlockSize());
+    }
 }
 
 //==============================================================================
-void SpectralEngine::reset()
+template <typename SampleType>
+void SpectralEngine<SampleType>::reset()
 {
-    eqChain.reset();
+    eqCascade.reset();
+    
+    // STFT в фоне принадлежит worker-у - сброс через него
+    if (backgroundStft.isRunning())
+        backgroundStft.reset();
+    else
+        stft.reset();
+    
+    if (splitFactor > 1)
+        bandSplit.reset();
+    
     claritySmoother.setCurrentAndTargetValue (0.0f);
     depthSmoother.setCurrentAndTargetValue (0.0f);
     flowSmoother.setCurrentAndTargetValue (0.0f);
     formantLfoPhase = 0.5f;
     
-    // ВРЕМЕННО: FFT буферы отключены
-    // std::fill (inputBuffer.begin(), inputBuffer.end(), 0.0f);
-    // std::fill (outputBuffer.begin(), outputBuffer.end(), 0.0f);
-    // std::fill (overlapBuffer.begin(), overlapBuffer.end(), 0.0f);
-    // std::fill (fftBuffer.begin(), fftBuffer.end(), 0.0f);
-    inputBufferPos = 0;
-    outputBufferPos = 0;
-    
-    updateFilters();
+    applyFilterCoefficients (0.0f, 0.0f);
 }
 
 //==============================================================================
-void SpectralEngine::setClarity (float clarity)
+template <typename SampleType>
+void SpectralEngine<SampleType>::setClarity (float clarity)
 {
     auto newClarity = juce::jlimit (-0.5f, 0.5f, clarity);
     if (std::abs (newClarity - clarityParam) > 0.0001f)
     {
         clarityParam = newClarity;
-        claritySmoother.setTargetValue (clarityParam);
-        updateFilters();  // Обновляем фильтры сразу при изменении параметра
+        claritySmoother.setTargetValue (clarityParam);  // Фильтры идут за сглаженным значением в process()
     }
 }
 
-void SpectralEngine::setDepth (float depth)
+template <typename SampleType>
+void SpectralEngine<SampleType>::setDepth (float depth)
 {
     depthParam = juce::jlimit (0.0f, 1.0f, depth);
 }
 
-void SpectralEngine::setFlow (float flow)
+template <typename SampleType>
+void SpectralEngine<SampleType>::setFlow (float flow)
 {
     flowParam = juce::jlimit (0.0f, 1.0f, flow);
     flowSmoother.setTargetValue (flowParam);
 }
 
 //==============================================================================
-void SpectralEngine::updateFilters()
+template <typename SampleType>
+void SpectralEngine<SampleType>::prepareFilterTables()
 {
-    // Используем прямое значение параметра (не smoothed), чтобы фильтры обновлялись сразу
-    // Smoother нужен только для плавности, но для обновления фильтров используем актуальное значение
-    using Coeffs = juce::dsp::IIR::Coefficients<float>;
-    auto clarity = clarityParam;
-    
+    // Все коэффициенты EQ считаются здесь, на сетке Clarity / Depth для текущей частоты.
     // Clarity: "Хрустальный блеск" vs "Мутный лёд" - ПРАВИЛЬНЫЙ ПОДХОД
     // Проблема была: слишком агрессивный boost усиливал шумы, а не гармоники
     // Решение: более тонкий, музыкальный подход
-    
-    auto clarityCurved = clarity * 2.0f;  // -1.0 to +1.0
+    const auto sr = sampleRate;
     
     // High-shelf: УМЕРЕННЫЙ boost для "воздуха" (не шум!)
     // При +50%: +7 дБ @ 8 кГц - заметнее, но не шумно
     // При -50%: -7 дБ @ 8 кГц - "мутный лёд"
-    auto airGainDb = clarityCurved * 7.0f;  // ±7 дБ (+20% от ±6)
-    auto airGainLinear = juce::Decibels::decibelsToGain (airGainDb);
-    
-    // High-shelf filter (воздух) - для верхов
-    // Более широкий Q (0.7) для плавности и минимальных фазовых искажений
-    auto highShelfCoeffs = Coeffs::makeHighShelf (
-        sampleRate, HIGH_SHELF_FREQ, 0.7f, airGainLinear);  // Q=0.7 для баланса плавности и фаз
-    *eqChain.get<0>().state = *highShelfCoeffs;
+    airTable.prepare (-0.5f, 0.5f, CLARITY_TABLE_POINTS, [sr] (float clarity)
+    {
+        auto clarityCurved = clarity * 2.0f;  // -1.0 to +1.0
+        auto airGainDb = clarityCurved * 7.0f;  // ±7 дБ (+20% от ±6)
+        auto airGainLinear = juce::Decibels::decibelsToGain (airGainDb);
+        
+        // Более широкий Q (0.7) для плавности и минимальных фазовых искажений
+        return ArrayCoeffs::makeHighShelf (sr, HIGH_SHELF_FREQ, 0.7f, airGainLinear);
+    });
     
     // Формант-сдвиг через резонансные фильтры (F1, F2, F3) - УМЕРЕННЫЙ
     // При -50%: форманты сдвигаются вниз (мутный лёд)
     // При +50%: форманты сдвигаются вверх (хрустальный блеск)
-    auto formantShiftRatio = 1.0f + clarityCurved * 0.35f;  // ±35% сдвиг (+20% от ±30%)
-    
-    // F1: 200-800 Hz (базовый формант) - ЛЕГКИЙ ЭФФЕКТ
+    auto makeFormantTable = [sr] (BiquadCoefficientTable<SampleType>& table, float centre, float q, float gainScale)
+    {
+        table.prepare (-0.5f, 0.5f, CLARITY_TABLE_POINTS, [=] (float clarity)
+        {
+            auto clarityCurved = clarity * 2.0f;
+            auto formantShiftRatio = 1.0f + clarityCurved * 0.35f;  // ±35% сдвиг (+20% от ±30%)
+            auto gain = clarityCurved > 0.0f
+                ? 1.0f + clarityCurved * gainScale
+                : 1.0f - std::abs (clarityCurved) * gainScale;
+            return ArrayCoeffs::makePeakFilter (sr, centre * formantShiftRatio, q, gain);
+        });
+    };
+    
+    // F1: 200-800 Hz (базовый формант) - ЛЕГКИЙ ЭФФЕКТ, ~500 Hz, ±35%
     // УМЕНЬШЕН Q для минимизации фазовых искажений (меньше стерео-смещения)
-    auto f1Center = (FORMANT_F1_MIN + FORMANT_F2_MIN) / 2.0f;  // ~500 Hz
-    auto f1Shifted = f1Center * formantShiftRatio;
-    auto f1Gain = clarityCurved > 0.0f 
-        ? 1.0f + clarityCurved * 0.35f  // При +50%: +35% boost
-        : 1.0f - std::abs(clarityCurved) * 0.35f;  // При -50%: -35%
-    auto f1Coeffs = Coeffs::makePeakFilter (
-        sampleRate, f1Shifted, 1.2f, f1Gain);  // Q=1.2 (было 2.0) - менее фазовых искажений
-    *eqChain.get<2>().state = *f1Coeffs;
-    
-    // F2: 800-3000 Hz (основной формант речи) - СРЕДНИЙ ЭФФЕКТ
-    auto f2Center = (FORMANT_F2_MIN + FORMANT_F2_MAX) / 2.0f;  // ~1900 Hz
-    auto f2Shifted = f2Center * formantShiftRatio;
-    auto f2Gain = clarityCurved > 0.0f 
-        ? 1.0f + clarityCurved * 0.45f  // При +50%: +45% boost
-        : 1.0f - std::abs(clarityCurved) * 0.45f;  // При -50%: -45%
-    auto f2Coeffs = Coeffs::makePeakFilter (
-        sampleRate, f2Shifted, 1.2f, f2Gain);  // Q=1.2 (было 1.8) - менее фазовых искажений
-    *eqChain.get<3>().state = *f2Coeffs;
-    
-    // F3: 2000-4000 Hz (высокий формант, "блеск") - КЛЮЧЕВОЙ, НО УМЕРЕННЫЙ
-    auto f3Center = (FORMANT_F3_MIN + FORMANT_F3_MAX) / 2.0f;  // ~3000 Hz
-    auto f3Shifted = f3Center * formantShiftRatio;
-    auto f3Gain = clarityCurved > 0.0f 
-        ? 1.0f + clarityCurved * 0.55f  // При +50%: +55% boost (~+4 дБ)
-        : 1.0f - std::abs(clarityCurved) * 0.55f;  // При -50%: -55% (~-4 дБ)
-    auto f3Coeffs = Coeffs::makePeakFilter (
-        sampleRate, f3Shifted, 1.0f, f3Gain);  // Q=1.0 (было 1.5) - минимальные фазовые искажения
-    *eqChain.get<4>().state = *f3Coeffs;
-    
-    // Low-mid bell filter (Depth - для "темноты" подо льдом)
-    auto depth = depthSmoother.getCurrentValue();
-    if (depth < 0.1f)
+    makeFormantTable (f1Table, (FORMANT_F1_MIN + FORMANT_F2_MIN) / 2.0f, 1.2f, 0.35f);  // Q=1.2 (было 2.0)
+    
+    // F2: 800-3000 Hz (основной формант речи) - СРЕДНИЙ ЭФФЕКТ, ~1900 Hz, ±45%
+    makeFormantTable (f2Table, (FORMANT_F2_MIN + FORMANT_F2_MAX) / 2.0f, 1.2f, 0.45f);  // Q=1.2 (было 1.8)
+    
+    // F3: 2000-4000 Hz (высокий формант, "блеск") - КЛЮЧЕВОЙ, НО УМЕРЕННЫЙ, ~3000 Hz, ±55% (~±4 дБ)
+    makeFormantTable (f3Table, (FORMANT_F3_MIN + FORMANT_F3_MAX) / 2.0f, 1.0f, 0.55f);  // Q=1.0 (было 1.5)
+    
+    // Low-mid bell filter (Depth - для "темноты" подо льдом), только при Depth < 0.1
+    lowMidTable.prepare (0.0f, LOW_MID_DEPTH_LIMIT, DEPTH_TABLE_POINTS, [sr] (float depth)
     {
         auto depthCurved = std::pow (depth * 10.0f, 1.3f);  // Scale для малых значений
         auto lowMidGainDb = depthCurved * MAX_LOW_MID_BOOST;
         auto lowMidGainLinear = juce::Decibels::decibelsToGain (lowMidGainDb);
-        auto lowMidCoeffs = Coeffs::makePeakFilter (
-            sampleRate, LOW_MID_FREQ, LOW_MID_Q, lowMidGainLinear);
-        *eqChain.get<1>().state = *lowMidCoeffs;
+        return ArrayCoeffs::makePeakFilter (sr, LOW_MID_FREQ, LOW_MID_Q, lowMidGainLinear);
+    });
+    
+    // Когда Depth большой, отключаем low-mid EQ (глубина создаётся через реверб)
+    lowMidBypassTable.prepare (0.0f, 1.0f, 2, [sr] (float)
+    {
+        return ArrayCoeffs::makePeakFilter (sr, LOW_MID_FREQ, LOW_MID_Q, 1.0f);
+    });
+    
+    lastFilterClarity = -999.0f;
+    lastFilterDepth = -999.0f;
+}
+
+template <typename SampleType>
+void SpectralEngine<SampleType>::applyFilterCoefficients (float clarity, float depth) noexcept
+{
+    // Только интерполяция по таблицам, без аллокаций
+    if (clarity != lastFilterClarity)
+    {
+        eqCascade.setCoefficients (airSection, airTable.lookup (clarity));
+        eqCascade.setCoefficients (f1Section, f1Table.lookup (clarity));
+        eqCascade.setCoefficients (f2Section, f2Table.lookup (clarity));
+        eqCascade.setCoefficients (f3Section, f3Table.lookup (clarity));
+        lastFilterClarity = clarity;
     }
-    else
+    
+    if (depth != lastFilterDepth)
+    {
+        eqCascade.setCoefficients (lowMidSection, depth < LOW_MID_DEPTH_LIMIT ? lowMidTable.lookup (depth)
+                                                                              : lowMidBypassTable.lookup (0.0f));
+        lastFilterDepth = depth;
+    }
+}
+
+template <typename SampleType>
+void SpectralEngine<SampleType>::processEq (juce::AudioBuffer<SampleType>& buffer, float clarityStart, float depthStart) noexcept
+{
+    juce::dsp::AudioBlock<SampleType> block (buffer);
+    const auto numSamples = (int) block.getNumSamples();
+    const auto clarityEnd = claritySmoother.getCurrentValue();
+    const auto depthEnd = depthSmoother.getCurrentValue();
+    
+    // Сглаживатели линейные: значение внутри блока - прямая от начала к концу.
+    // Коэффициенты обновляются каждые EQ_SUB_BLOCK_SIZE семплов, без ступенек на весь блок
+    const bool ramping = clarityStart != clarityEnd || depthStart != depthEnd;
+    const auto subBlockSize = ramping ? EQ_SUB_BLOCK_SIZE : numSamples;
+    
+    for (int start = 0; start < numSamples; start += subBlockSize)
     {
-        // Когда Depth большой, отключаем low-mid EQ (глубина создаётся через реверб)
-        auto lowMidCoeffs = Coeffs::makePeakFilter (
-            sampleRate, LOW_MID_FREQ, LOW_MID_Q, 1.0f);
-        *eqChain.get<1>().state = *lowMidCoeffs;
+        const auto count = juce::jmin (subBlockSize, numSamples - start);
+        const auto t = (float) (start + count) / (float) numSamples;
+        
+        applyFilterCoefficients (clarityStart + (clarityEnd - clarityStart) * t,
+                                 depthStart + (depthEnd - depthStart) * t);
+        
+        eqCascade.process (block.getSubBlock ((size_t) start, (size_t) count));
     }
 }
 
 //==============================================================================
-void SpectralEngine::processFormantShift (juce::AudioBuffer<float>& buffer, int channel)
+template <typename SampleType>
+void SpectralEngine<SampleType>::FormantShifter::prepare (int fftOrder, double sampleRate)
 {
-    auto numSamples = buffer.getNumSamples();
-    auto* channelData = buffer.getWritePointer (channel);
+    const auto fftSize = 1 << fftOrder;
+    const auto numBins = fftSize / 2 + 1;
     
-    // Вычисляем формант-сдвиг от Clarity (в полутонах)
-    auto clarityCurved = clarityParam * 2.0f;  // -1.0 to +1.0
-    auto formantShiftSemitones = clarityCurved * 3.0f;  // ±3 полутона (документация: ±2-6 пт)
-    auto formantShiftRatio = std::pow (2.0f, formantShiftSemitones / 12.0f);  // Частотный коэффициент
+    // Диапазон таблиц: полный Clarity плюс размах LFO
+    remapTables.prepare (numBins, FORMANT_SHIFT_MAX_SEMITONES + FORMANT_LFO_DEPTH, FORMANT_TABLE_STEP);
+    magnitudes.assign ((size_t) remapTables.getSourceSize(), 0.0f);
+    shifted.assign ((size_t) numBins, 0.0f);
+    scratch.assign ((size_t) numBins, 0.0f);
     
-    // Если сдвиг нулевой, формант-шифт не нужен
-    if (std::abs (formantShiftRatio - 1.0f) < 0.001f)
-        return;
+    cepstrumFft = std::make_unique<juce::dsp::FFT> (fftOrder);
+    cepstrum.assign ((size_t) (2 * fftSize), 0.0f);
+    logEnvelope.assign ((size_t) remapTables.getSourceSize(), 0.0f);
     
-    // Обрабатываем каждый семпл с overlap-add
-    for (int i = 0; i < numSamples; ++i)
+    // Кепстр чётный: коэффициенты n и fftSize - n одинаковы. Спад Hann до CEPSTRUM_LIFTER_SEC
+    // вместо обрыва - огибающая без ряби от края окна
+    const auto cutoff = juce::jlimit (2, fftSize / 2, (int) std::round (CEPSTRUM_LIFTER_SEC * sampleRate));
+    lifter.assign ((size_t) fftSize, 0.0f);
+    
+    for (int n = 0; n < cutoff; ++n)
     {
-        // Добавляем семпл во входной буфер
-        inputBuffer[inputBufferPos] = channelData[i];
-        inputBufferPos++;
-        
-        // Когда набрали достаточно семплов для FFT, обрабатываем
-        if (inputBufferPos >= hopSize)
-        {
-            // Копируем inputBuffer в fftBuffer с окном
-            for (int j = 0; j < fftSize; ++j)
-            {
-                fftBuffer[j * 2] = inputBuffer[j] * windowBuffer[j];  // Real
-                fftBuffer[j * 2 + 1] = 0.0f;                           // Imaginary
-            }
-            
-            // Forward FFT
-            fft->performRealOnlyForwardTransform (fftBuffer.data());
-            
-            // Спектральное перемаппирование (формант-сдвиг)
-            // Создаем новый спектр со сдвинутыми частотами
-            std::vector<float> shiftedSpectrum (fftSize * 2, 0.0f);
-            
-            for (int bin = 0; bin < fftSize / 2; ++bin)
-            {
-                // Вычисляем новую частоту после сдвига
-                float originalFreq = static_cast<float> (bin) * sampleRate / fftSize;
-                float shiftedFreq = originalFreq * formantShiftRatio;
-                float shiftedBin = shiftedFreq * fftSize / sampleRate;
-                
-                // Интерполируем между бинами
-                int binLow = static_cast<int> (std::floor (shiftedBin));
-                int binHigh = static_cast<int> (std::ceil (shiftedBin));
-                float fraction = shiftedBin - binLow;
-                
-                if (binHigh < fftSize / 2)
-                {
-                    // Линейная интерполяция
-                    float realLow = fftBuffer[binLow * 2];
-                    float imagLow = fftBuffer[binLow * 2 + 1];
-                    float realHigh = fftBuffer[binHigh * 2];
-                    float imagHigh = fftBuffer[binHigh * 2 + 1];
-                    
-                    shiftedSpectrum[bin * 2] = realLow * (1.0f - fraction) + realHigh * fraction;
-                    shiftedSpectrum[bin * 2 + 1] = imagLow * (1.0f - fraction) + imagHigh * fraction;
-                }
-            }
-            
-            // Копируем обратно в fftBuffer
-            std::copy (shiftedSpectrum.begin(), shiftedSpectrum.end(), fftBuffer.begin());
-            
-            // Inverse FFT
-            fft->performRealOnlyInverseTransform (fftBuffer.data());
-            
-            // Применяем окно и добавляем в outputBuffer с overlap-add
-            for (int j = 0; j < fftSize; ++j)
-            {
-                float sample = fftBuffer[j * 2] * windowBuffer[j];
-                
-                if (j < overlapSize)
-                {
-                    // Overlap-add с предыдущим окном
-                    sample += overlapBuffer[j];
-                }
-                
-                if (j < hopSize)
-                {
-                    // Выводим первые hopSize семплов
-                    outputBuffer[j] = sample;
-                }
-                else if (j < overlapSize)
-                {
-                    // Сохраняем для следующего overlap
-                    overlapBuffer[j] = sample;
-                }
-            }
-            
-            // Сдвигаем inputBuffer влево на hopSize
-            std::copy (inputBuffer.begin() + hopSize, inputBuffer.end(), inputBuffer.begin());
-            std::fill (inputBuffer.begin() + (fftSize - hopSize), inputBuffer.end(), 0.0f);
-            inputBufferPos -= hopSize;
-        }
+        const auto weight = (float) (0.5 * (1.0 + std::cos (juce::MathConstants<double>::pi * n / cutoff)));
+        lifter[(size_t) n] = weight;
+        lifter[(size_t) ((fftSize - n) & (fftSize - 1))] = weight;
+    }
+}
+
+template <typename SampleType>
+void SpectralEngine<SampleType>::FormantShifter::processFrame (int, Complex* bins, int numBins) noexcept
+{
+    jassert (numBins == remapTables.getNumBins());
+    numBins = juce::jmin (numBins, remapTables.getNumBins());
+    
+    const auto shift = semitones.load (std::memory_order_relaxed);
+    
+    if (envelopeMode.load (std::memory_order_relaxed))
+        shiftEnvelope (bins, numBins, shift);
+    else
+        shiftBins (bins, numBins, shift);
+}
+
+template <typename SampleType>
+void SpectralEngine<SampleType>::FormantShifter::shiftBins (Complex* bins, int numBins, float shift) noexcept
+{
+    // Два последних элемента magnitudes - нули (выше Найквиста), не перезаписываются
+    for (int bin = 0; bin < numBins; ++bin)
+        magnitudes[(size_t) bin] = std::abs (bins[bin]);
+    
+    // Бин b получает амплитуду с частоты b / ratio: огибающая растягивается в ratio раз
+    remapTables.remap (magnitudes.data(), shift, shifted.data(), scratch.data());
+    
+    for (int bin = 0; bin < numBins; ++bin)
+    {
+        const auto magnitude = magnitudes[(size_t) bin];
         
-        // Выводим семпл из outputBuffer
-        if (outputBufferPos < hopSize && inputBufferPos < hopSize)
-        {
-            channelData[i] = outputBuffer[outputBufferPos];
-            outputBufferPos++;
-        }
+        if (magnitude > 1.0e-9f)
+            bins[bin] *= shifted[(size_t) bin] / magnitude;
+        else
+            bins[bin] = { shifted[(size_t) bin], 0.0f };
     }
+}
+
+template <typename SampleType>
+void SpectralEngine<SampleType>::FormantShifter::shiftEnvelope (Complex* bins, int numBins, float shift) noexcept
+{
+    const auto fftSize = 2 * (numBins - 1);
+    
+    // Лог-спектр -> кепстр (вещественный и чётный), обратное FFT JUCE делит на N.
+    // log |X| = log |X|^2 / 2 - без корня
+    for (int bin = 0; bin < numBins; ++bin)
+    {
+        cepstrum[(size_t) (2 * bin)] = 0.5f * std::log (std::norm (bins[bin]) + 1.0e-18f);
+        cepstrum[(size_t) (2 * bin + 1)] = 0.0f;
+    }
+    
+    cepstrumFft->performRealOnlyInverseTransform (cepstrum.data());
+    
+    // Низкие кефренции - огибающая, высокие (период основного тона) - гармоники
+    juce::FloatVectorOperations::multiply (cepstrum.data(), lifter.data(), fftSize);
+    cepstrumFft->performRealOnlyForwardTransform (cepstrum.data(), true);
+    
+    for (int bin = 0; bin < numBins; ++bin)
+        logEnvelope[(size_t) bin] = cepstrum[(size_t) (2 * bin)];
+    
+    // Выше Найквиста огибающая продолжается последним значением, а не тишиной
+    logEnvelope[(size_t) numBins] = logEnvelope[(size_t) numBins + 1] = logEnvelope[(size_t) numBins - 1];
     
-    // Сбрасываем позиции для следующего блока
-    if (outputBufferPos >= hopSize)
-        outputBufferPos = 0;
+    // Тот же перенос, что и в shiftBins, но только огибающей: гармоники стоят на месте
+    remapTables.remap (logEnvelope.data(), shift, shifted.data(), scratch.data());
+    
+    for (int bin = 0; bin < numBins; ++bin)
+    {
+        const auto gainLog = juce::jlimit (-ENVELOPE_MAX_GAIN_LOG, ENVELOPE_MAX_GAIN_LOG,
+                                           shifted[(size_t) bin] - logEnvelope[(size_t) bin]);
+        bins[bin] *= std::exp (gainLog);
+    }
 }
 
 //==============================================================================
-void SpectralEngine::process (juce::AudioBuffer<float>& buffer)
+template <typename SampleType>
+void SpectralEngine<SampleType>::processFormantShift (juce::AudioBuffer<SampleType>& buffer)
+{
+    // Формант-сдвиг от Clarity (в полутонах), сглаженное значение - на блок
+    auto clarityCurved = claritySmoother.getCurrentValue() * 2.0f;  // -1.0 to +1.0
+    auto formantShiftSemitones = clarityCurved * FORMANT_SHIFT_MAX_SEMITONES;  // ±3 полутона (документация: ±2-6 пт)
+    
+    // Медленное "дыхание" формант от Flow, таблицы между точками сетки смешиваются
+    auto lfo = std::sin (juce::MathConstants<float>::twoPi * formantLfoPhase);
+    formantShiftSemitones += lfo * FORMANT_LFO_DEPTH * flowSmoother.getCurrentValue();
+    
+    formantLfoPhase += (float) (FORMANT_LFO_HZ * buffer.getNumSamples() / sampleRate);
+    formantLfoPhase -= std::floor (formantLfoPhase);
+    
+    formantShifter.semitones.store (formantShiftSemitones, std::memory_order_relaxed);
+    
+    // Сдвиг незаметен - кадры идут без FFT, но через те же кольца (задержка и overlap-add не прерываются)
+    const bool shifting = std::abs (formantShiftSemitones) >= 0.015f;
+    auto* processor = shifting ? &formantShifter : nullptr;
+    
+    if (splitFactor == 1)
+    {
+        processStft (buffer, processor);
+        return;
+    }
+    
+    // Нижняя полоса на пониженной частоте; верх не фильтруется - к задержанному входу
+    // добавляется только интерполированная разница, которую внёс формант-шифт
+    const auto numLowSamples = bandSplit.decimate (buffer, lowBand);
+    juce::AudioBuffer<SampleType> lowBlock (lowBand.getArrayOfWritePointers(), lowBand.getNumChannels(), numLowSamples);
+    processStft (lowBlock, processor);
+    bandSplit.recombine (buffer, lowBlock);
+}
+
+template <typename SampleType>
+void SpectralEngine<SampleType>::processStft (juce::AudioBuffer<SampleType>& buffer,
+                                              typename StreamingSTFT<SampleType>::FrameProcessor* processor)
+{
+    if (backgroundStft.isRunning())
+        backgroundStft.process (buffer, processor);
+    else
+        stft.process (buffer, processor);
+}
+
+template <typename SampleType>
+int SpectralEngine<SampleType>::getStftLatencySamples() const noexcept
+{
+    return backgroundStft.isRunning() ? backgroundStft.getLatencySamples() : stft.getLatencySamples();
+}
+
+//==============================================================================
+template <typename SampleType>
+void SpectralEngine<SampleType>::process (juce::AudioBuffer<SampleType>& buffer)
 {
     // КРИТИЧНО: отключаем денормалы для предотвращения асимметрии на разных каналах
     juce::ScopedNoDenormals noDenormals;
@@ -317,41 +401,57 @@ void SpectralEngine::process (juce::AudioBuffer<float>& buffer)
     if (numChannels == 0 || numSamples == 0)
         return;
     
+    // Значения в начале блока - от них EQ интерполирует коэффициенты
+    const auto clarityStart = claritySmoother.getCurrentValue();
+    const auto depthStart = depthSmoother.getCurrentValue();
+    
     // Update smoothed parameters
+    claritySmoother.setTargetValue (clarityParam);
+    depthSmoother.setTargetValue (depthParam);
     claritySmoother.skip (numSamples);
     depthSmoother.skip (numSamples);
     flowSmoother.skip (numSamples);
     
-    // Обновляем smoothed значения для плавности
-    claritySmoother.setTargetValue (clarityParam);
-    depthSmoother.setTargetValue (depthParam);
-    
-    // Update filters if parameters changed (проверяем прямое значение параметра)
-    static float lastClarity = -999.0f;
-    static float lastDepth = -999.0f;
+    // Formant shift (before EQ) - Clarity управляет сдвигом (не Depth!)
+    // Работает всегда: при нулевом сдвиге только задерживает сигнал
+    processFormantShift (buffer);
     
-    // Обновляем фильтры если значения изменились (используем прямое значение, не smoothed)
-    if (std::abs (clarityParam - lastClarity) > 0.0001f ||
-        std::abs (depthParam - lastDepth) > 0.0001f)
+    // Process through EQ chain (after formant shift)
+    // Пропуск с reset() - только когда и прошлый блок закончился на единичном усилении:
+    // блок, в котором рампа доходит до нуля, ещё обрабатывается (в TDF2 ненулевое состояние)
+    if (isEqActive (clarityStart, depthStart))
     {
-        lastClarity = clarityParam;
-        lastDepth = depthParam;
-        updateFilters();
+        processEq (buffer, clarityStart, depthStart);
     }
+    else
+    {
+        eqCascade.reset();
+    }
+}
+
+//==============================================================================
+template <typename SampleType>
+bool SpectralEngine<SampleType>::isEqUnity (float clarity, float depth) noexcept
+{
+    // При Clarity = 0 все фильтры (воздух, F1-F3) имеют единичное усиление.
+    // Low-mid bell ненулевой только при 0 < Depth < 0.1 (см. prepareFilterTables)
+    const auto lowMidActive = depth > 0.0001f && depth < LOW_MID_DEPTH_LIMIT;
+    return std::abs (clarity) <= 0.0001f && ! lowMidActive;
+}
+
+template <typename SampleType>
+bool SpectralEngine<SampleType>::isEqActive (float clarityStart, float depthStart) const noexcept
+{
+    // Сглаживатели уже прошли блок: текущие значения - конец блока
+    const auto clarityEnd = claritySmoother.getCurrentValue();
+    const auto depthEnd = depthSmoother.getCurrentValue();
     
-    // Process formant shift for each channel (before EQ)
-    // ВРЕМЕННО ОТКЛЮЧЕНО - FFT вызывает зависание (нужна оптимизация)
-    // Формант-шифт управляется Clarity (не Depth!)
-    // auto clarity = claritySmoother.getCurrentValue();
-    // if (std::abs (clarity) > 0.01f)  // Если Clarity не нулевой
-    // {
-    //     for (int ch = 0; ch < numChannels; ++ch)
-    //         processFormantShift (buffer, ch);
-    // }
+    if (clarityStart != clarityEnd || depthStart != depthEnd)
+        return true;
     
-    // Process through EQ chain (after formant shift)
-    juce::dsp::AudioBlock<float> block (buffer);
-    juce::dsp::ProcessContextReplacing<float> context (block);
-    eqChain.process (context);
+    return ! isEqUnity (clarityEnd, depthEnd);
 }
 
+//==============================================================================
+template class SpectralEngine<float>;
+template class SpectralEngine<double>;
@@ -11,10 +11,19 @@
 
 #include <juce_audio_processors/juce_audio_processors.h>
 #include <juce_dsp/juce_dsp.h>
+#include <atomic>
 #include <cmath>
+#include <memory>
 #include <vector>
+#include "BackgroundSTFT.h"
+#include "BinRemapTables.h"
+#include "BiquadCascade.h"
+#include "BiquadCoefficientTable.h"
+#include "MultirateBandSplit.h"
+#include "StreamingSTFT.h"
 
 //==============================================================================
+template <typename SampleType>
 class SpectralEngine
 {
 public:
@@ -23,7 +32,54 @@ public:
 
     void prepare (const juce::dsp::ProcessSpec& spec);
     void reset();
-    void process (juce::AudioBuffer<float>& buffer);
+    void process (juce::AudioBuffer<SampleType>& buffer);
+
+    // Звук стоит: останавливает worker фонового STFT (если был), до следующего prepare()
+    void release()  { backgroundStft.release(); }
+
+    // Всегда true: STFT формант-шифта задерживает сигнал, пропуск ступени сдвинул бы его во времени.
+    // Неактивные EQ и формант-шифт пропускаются внутри process()
+    bool isActive() const noexcept  { return true; }
+
+    // Задержка формант-шифта (STFT, в фоне - плюс бюджет worker-а; в режиме полос - плюс FIR
+    // ресемплинга), постоянная при любых параметрах
+    int getLatencySamples() const noexcept
+    {
+        return splitFactor > 1 ? bandSplit.getLatencySamples() : getStftLatencySamples();
+    }
+
+    // Тир задержки/качества: 0 - tracking (FFT 256), 1 - balanced (1024), 2 - mixdown (4096).
+    // Применяется в следующем prepare()
+    static constexpr int NUM_LATENCY_TIERS = 3;
+    static constexpr int TRACKING_TIER = 0;
+    static constexpr int MIXDOWN_TIER = NUM_LATENCY_TIERS - 1;
+    void setLatencyTier (int tier) noexcept  { latencyTier = juce::jlimit (0, NUM_LATENCY_TIERS - 1, tier); }
+    int getLatencyTier() const noexcept      { return latencyTier; }
+
+    // Фон: кадры STFT считает отдельный поток (ровная нагрузка на аудио-поток при больших FFT),
+    // задержка растёт на бюджет worker-а. Применяется в следующем prepare()
+    void setBackgroundProcessing (bool shouldRunInBackground) noexcept  { backgroundProcessing = shouldRunInBackground; }
+    bool isBackgroundProcessing() const noexcept                        { return backgroundStft.isRunning(); }
+
+    // Offline рендер: фоновый STFT ждёт worker вместо подмены на dry
+    void setNonRealtime (bool isNonRealtime) noexcept  { backgroundStft.setNonRealtime (isNonRealtime); }
+
+    // Семплов, подменённых на dry из-за опоздания worker-а (с последнего prepare)
+    int getNumMissedSamples() const noexcept  { return backgroundStft.getNumMissedSamples(); }
+
+    // Режим полос: на высоких частотах дискретизации формант-шифт работает на нижней полосе,
+    // пониженной в getSplitBandFactor() раз (FFT во столько же раз меньше). Применяется в следующем prepare()
+    void setSplitBandProcessing (bool shouldSplit) noexcept  { splitBandProcessing = shouldSplit; }
+    int getSplitBandFactor() const noexcept                   { return splitFactor; }
+
+    // Формант-шифт: перенос амплитуд бинов целиком (по умолчанию) или только огибающей
+    // (кепстр) - гармоники остаются на месте, и малого FFT уже достаточно. Переключается на лету
+    enum class FormantMode { binRemap, spectralEnvelope };
+    void setFormantMode (FormantMode mode) noexcept  { formantShifter.envelopeMode.store (mode == FormantMode::spectralEnvelope, std::memory_order_relaxed); }
+    FormantMode getFormantMode() const noexcept      { return formantShifter.envelopeMode.load (std::memory_order_relaxed) ? FormantMode::spectralEnvelope : FormantMode::binRemap; }
+
+    // Стерео: L и R в одном комплексном FFT (по умолчанию), false - отдельный FFT на канал
+    void setStereoPackedFFT (bool shouldPack) noexcept  { stft.setStereoPacking (shouldPack); }
 
     // Parameter control (normalized)
     void setClarity (float clarity);    // -0.5 to +0.5: баланс верхов/низов
@@ -31,37 +87,89 @@ public:
     void setFlow (float flow);          // 0.0-1.0: LFO на форманты (для Motion Mod)
 
 private:
-    void updateFilters();
-    void processFormantShift (juce::AudioBuffer<float>& buffer, int channel);
+    void prepareFilterTables();
+    void applyFilterCoefficients (float clarity, float depth) noexcept;
+    void processEq (juce::AudioBuffer<SampleType>& buffer, float clarityStart, float depthStart) noexcept;
+    void processFormantShift (juce::AudioBuffer<SampleType>& buffer);
+    void processStft (juce::AudioBuffer<SampleType>& buffer, typename StreamingSTFT<SampleType>::FrameProcessor* processor);
+    int getStftLatencySamples() const noexcept;  // на частоте STFT (в режиме полос - пониженной)
+
+    // true, если EQ в этом блоке меняет сигнал: параметры двигались (от значений
+    // в начале блока) или усиление в конце блока не единичное
+    bool isEqActive (float clarityStart, float depthStart) const noexcept;
+    static bool isEqUnity (float clarity, float depth) noexcept;
     
-    // EQ для спектрального баланса
-    // Используем ProcessorDuplicator для раздельных состояний фильтров на каждый канал
-    // Это устраняет стерео-смещение при изменении Clarity
-    using IIR = juce::dsp::IIR::Filter<float>;
-    using Coeffs = juce::dsp::IIR::Coefficients<float>;
-    template<typename F> using Dup = juce::dsp::ProcessorDuplicator<F, Coeffs>;
+    // EQ для спектрального баланса: пять секций одним проходом, раздельное состояние
+    // на каждый канал (без стерео-смещения при изменении Clarity)
+    using ArrayCoeffs = juce::dsp::IIR::ArrayCoefficients<SampleType>;
     
-    juce::dsp::ProcessorChain<
-        Dup<IIR>,  // High-shelf для воздуха (Clarity - верха)
-        Dup<IIR>,  // Low-mid для "гула" (Depth, когда формант-шифт выкл)
-        Dup<IIR>,  // Формант F1 (200-800 Hz) - Clarity управляет сдвигом
-        Dup<IIR>,  // Формант F2 (800-3000 Hz) - Clarity управляет сдвигом
-        Dup<IIR>   // Формант F3 (2000-4000 Hz) - Clarity управляет сдвигом
-    > eqChain;
-
-    // FFT для формант-шифта (оптимизировано)
-    std::unique_ptr<juce::dsp::FFT> fft;
-    std::vector<float> fftBuffer;           // FFT буфер (фиксированный размер)
-    std::vector<float> windowBuffer;       // Окно (фиксированный размер)
-    std::vector<float> inputBuffer;        // Входной буфер для накопления
-    std::vector<float> outputBuffer;       // Выходной буфер для overlap-add
-    std::vector<float> overlapBuffer;      // Overlap-add буфер (фиксированный размер)
+    enum EqSection
+    {
+        airSection,     // High-shelf для воздуха (Clarity - верха)
+        lowMidSection,  // Low-mid для "гула" (Depth, когда формант-шифт выкл)
+        f1Section,      // Формант F1 (200-800 Hz) - Clarity управляет сдвигом
+        f2Section,      // Формант F2 (800-3000 Hz) - Clarity управляет сдвигом
+        f3Section,      // Формант F3 (2000-4000 Hz) - Clarity управляет сдвигом
+        numEqSections
+    };
     
-    int fftSize = 2048;
-    int hopSize = 512;
-    int overlapSize = fftSize - hopSize;   // 1536 samples
-    int inputBufferPos = 0;                // Позиция в inputBuffer
-    int outputBufferPos = 0;               // Позиция в outputBuffer
+    BiquadCascade<SampleType, numEqSections> eqCascade;
+
+    // Коэффициенты EQ на сетке параметров (пересчёт в prepare): в аудио-потоке
+    // автоматизация Clarity / Depth - только интерполяция, без тригонометрии
+    BiquadCoefficientTable<SampleType> airTable, f1Table, f2Table, f3Table;
+    BiquadCoefficientTable<SampleType> lowMidTable, lowMidBypassTable;
+
+    // Формант-шифт: перенос огибающей амплитуд по бинам, фазы остаются свои
+    struct FormantShifter : StreamingSTFT<SampleType>::FrameProcessor
+    {
+        using Complex = typename StreamingSTFT<SampleType>::Complex;
+
+        void prepare (int fftOrder, double sampleRate);
+        void processFrame (int channel, Complex* bins, int numBins) noexcept override;
+
+        // Амплитуды бинов переезжают целиком (вместе с гармониками)
+        void shiftBins (Complex* bins, int numBins, float shift) noexcept;
+
+        // Кепстральная огибающая: сдвигается только она, бины умножаются на exp (новая - старая)
+        void shiftEnvelope (Complex* bins, int numBins, float shift) noexcept;
+
+        std::atomic<float> semitones { 0.0f };      // > 0 - форманты вверх; в фоне читает worker
+        std::atomic<bool> envelopeMode { false };
+        BinRemapTables remapTables;     // индексы бинов на сетке сдвигов
+        std::vector<float> magnitudes;  // на один кадр: numBins + 2 нуля сверху
+        std::vector<float> shifted, scratch;
+
+        std::unique_ptr<juce::dsp::FFT> cepstrumFft;
+        std::vector<float> cepstrum;      // 2 * fftSize: формат real-only FFT JUCE
+        std::vector<float> lifter;        // окно кепстра, CEPSTRUM_LIFTER_SEC
+        std::vector<float> logEnvelope;   // numBins + 2: сверху повтор последнего бина
+    };
+
+    StreamingSTFT<SampleType> stft;
+    FormantShifter formantShifter;
+    BackgroundSTFT<SampleType> backgroundStft;  // после stft и formantShifter: останавливается первым
+    bool backgroundProcessing = false;
+
+    // Режим полос: децимация перед STFT и интерполяция разницы обратно
+    MultirateBandSplit<SampleType> bandSplit;
+    juce::AudioBuffer<SampleType> lowBand;
+    bool splitBandProcessing = true;
+    int splitFactor = 1;
+
+    // FFT по тирам, hop = fftSize / 4. На 44.1 кГц: 5.8 мс / 172 Гц на бин,
+    // 23 мс / 43 Гц, 93 мс / 11 Гц
+    static constexpr int TIER_FFT_ORDERS[NUM_LATENCY_TIERS] = { 8, 10, 12 };
+
+    // Форманты F1-F3 (до 4 кГц, +20% при сдвиге вверх) укладываются в полосу пропускания
+    // ресемплинга (~0.26 пониженной частоты) при пониженной частоте от SPLIT_BAND_MIN_RATE
+    static constexpr double SPLIT_BAND_MIN_RATE = 22050.0;
+    static constexpr double SPLIT_BAND_MIN_HOST_RATE = 88200.0;  // 44.1 / 48 кГц - полный диапазон, как раньше
+    int latencyTier = 1;
+
+    // Значения, для которых последний раз выставлялись коэффициенты EQ
+    float lastFilterClarity = -999.0f;
+    float lastFilterDepth = -999.0f;
 
     // Parameters (normalized)
     float clarityParam = 0.0f;  // -0.5 to +0.5
@@ -84,11 +192,20 @@ private:
     static constexpr float LOW_MID_Q = 1.5f;
     static constexpr float MAX_AIR_BOOST = 7.0f;       // Макс подъем воздуха (+7 дБ) - УМЕРЕННЫЙ
     static constexpr float MAX_LOW_MID_BOOST = 4.0f;    // Макс подъем гула (+4 дБ)
+    static constexpr float LOW_MID_DEPTH_LIMIT = 0.1f;  // выше - low-mid EQ выключен
+    
+    // Сетка таблиц EQ: шаг Clarity 1/256 (~0.05 дБ воздуха), Depth 0.1/128
+    static constexpr int CLARITY_TABLE_POINTS = 257;
+    static constexpr int DEPTH_TABLE_POINTS = 129;
+    static constexpr int EQ_SUB_BLOCK_SIZE = 32;       // шаг обновления коэффициентов при сглаживании
     
     // Формант-шифт настройки (для Iceberg)
-    static constexpr float FORMANT_SHIFT_SEMITONES = -0.3f;  // -0.3 полутона вниз (скрытый параметр)
+    static constexpr float FORMANT_SHIFT_MAX_SEMITONES = 3.0f;  // при |Clarity| = 50%
     static constexpr float FORMANT_LFO_HZ = 0.05f;          // 0.05 Hz LFO для модуляции
     static constexpr float FORMANT_LFO_DEPTH = 0.15f;       // ±0.15 полутона модуляция
+    static constexpr float FORMANT_TABLE_STEP = 0.125f;     // сетка таблиц перемаппирования (полутона)
+    static constexpr double CEPSTRUM_LIFTER_SEC = 0.002;    // огибающая без гармоник голоса (F0 до 500 Гц)
+    static constexpr float ENVELOPE_MAX_GAIN_LOG = 6.9f;    // ±60 дБ: провалы огибающей не взрывают шум
     static constexpr float FORMANT_F1_MIN = 200.0f;          // F1 диапазон (Hz)
     static constexpr float FORMANT_F1_MAX = 800.0f;
     static constexpr float FORMANT_F2_MIN = 800.0f;          // F2 диапазон (Hz)
@@ -0,0 +1,217 @@
+/*
+  ==============================================================================
+
+   StreamingSTFT - потоковый STFT с overlap-add для спектральных эффектов
+   Кольцевые буферы на каждый канал, все кадры выделены в prepare():
+   в аудио-потоке ни аллокаций, ни сдвигов буферов
+
+  ==============================================================================
+*/
+
+#include "StreamingSTFT.h"
+
+//==============================================================================
+template <typename SampleType>
+void StreamingSTFT<SampleType>::prepare (int numChannels, int fftOrder, int newHopSize)
+{
+    fftSize = 1 << fftOrder;
+    hopSize = newHopSize;
+
+    jassert (hopSize > 0 && hopSize <= fftSize / 4 && fftSize % hopSize == 0);
+
+    fft = std::make_unique<juce::dsp::FFT> (fftOrder);
+
+    channels.resize ((size_t) juce::jmax (0, numChannels));
+
+    for (auto& channel : channels)
+    {
+        channel.input.assign ((size_t) fftSize, SampleType (0));
+        channel.output.assign ((size_t) fftSize, SampleType (0));
+    }
+
+    frame.assign ((size_t) (2 * fftSize), 0.0f);
+    packedFrame.assign ((size_t) fftSize, Complex());
+    packedSpectrum.assign ((size_t) fftSize, Complex());
+    leftBins.assign ((size_t) getNumBins(), Complex());
+    rightBins.assign ((size_t) getNumBins(), Complex());
+    analysisWindow.resize ((size_t) fftSize);
+    synthesisWindow.resize ((size_t) fftSize);
+    passThroughWindow.resize ((size_t) fftSize);
+
+    // Периодический Hann: сумма квадратов окна со сдвигом hopSize постоянна при hop <= N/4
+    auto hann = [this] (int i) { return 0.5 * (1.0 - std::cos (2.0 * juce::MathConstants<double>::pi * i / fftSize)); };
+
+    double windowPowerSum = 0.0;
+
+    for (int i = 0; i < fftSize; ++i)
+        windowPowerSum += hann (i) * hann (i);
+
+    // Обратное FFT JUCE уже делит на N - остаётся только усиление перекрытия
+    const auto overlapGain = windowPowerSum / hopSize;
+
+    for (int i = 0; i < fftSize; ++i)
+    {
+        auto w = hann (i);
+        analysisWindow[(size_t) i] = (float) w;
+        synthesisWindow[(size_t) i] = (float) (w / overlapGain);
+        passThroughWindow[(size_t) i] = (SampleType) (w * w / overlapGain);
+    }
+
+    reset();
+}
+
+template <typename SampleType>
+void StreamingSTFT<SampleType>::reset() noexcept
+{
+    for (auto& channel : channels)
+    {
+        std::fill (channel.input.begin(), channel.input.end(), SampleType (0));
+        std::fill (channel.output.begin(), channel.output.end(), SampleType (0));
+    }
+
+    position = 0;
+    hopPosition = 0;
+}
+
+//==============================================================================
+template <typename SampleType>
+void StreamingSTFT<SampleType>::process (juce::AudioBuffer<SampleType>& buffer, FrameProcessor* processor) noexcept
+{
+    auto numSamples = buffer.getNumSamples();
+    auto numChannels = juce::jmin (buffer.getNumChannels(), (int) channels.size());
+
+    if (fftSize == 0)
+        return;
+
+    // Отрезками до следующей границы кадра: внутри отрезка кольца не переворачиваются
+    for (int start = 0; start < numSamples;)
+    {
+        const auto count = juce::jmin (numSamples - start, hopSize - hopPosition, fftSize - position);
+
+        for (int ch = 0; ch < numChannels; ++ch)
+        {
+            auto* data = buffer.getWritePointer (ch, start);
+            auto* input = channels[(size_t) ch].input.data() + position;
+            auto* output = channels[(size_t) ch].output.data() + position;
+
+            for (int i = 0; i < count; ++i)
+            {
+                input[i] = data[i];
+                data[i] = output[i];
+                output[i] = SampleType (0);
+            }
+        }
+
+        start += count;
+        position = (position + count) & (fftSize - 1);
+        hopPosition += count;
+
+        if (hopPosition == hopSize)
+        {
+            hopPosition = 0;
+
+            if (stereoPacking && processor != nullptr && numChannels == 2)
+                processStereoFrame (*processor);
+            else
+                for (int ch = 0; ch < numChannels; ++ch)
+                    processFrame (ch, processor);
+        }
+    }
+}
+
+template <typename SampleType>
+void StreamingSTFT<SampleType>::processFrame (int ch, FrameProcessor* processor) noexcept
+{
+    auto& channel = channels[(size_t) ch];
+
+    // position указывает на самый старый семпл: кадр = кольцо, развёрнутое с этой точки.
+    // Семпл k кадра складывается в ту же ячейку кольца выхода - задержка ровно fftSize
+    const auto firstPart = fftSize - position;
+
+    if (processor == nullptr)
+    {
+        // Без спектральной обработки FFT и IFFT взаимно обратны: остаются только окна
+        for (int k = 0; k < firstPart; ++k)
+            channel.output[(size_t) (position + k)] += channel.input[(size_t) (position + k)] * passThroughWindow[(size_t) k];
+
+        for (int k = firstPart; k < fftSize; ++k)
+            channel.output[(size_t) (k - firstPart)] += channel.input[(size_t) (k - firstPart)] * passThroughWindow[(size_t) k];
+
+        return;
+    }
+
+    for (int k = 0; k < firstPart; ++k)
+        frame[(size_t) k] = (float) channel.input[(size_t) (position + k)] * analysisWindow[(size_t) k];
+
+    for (int k = firstPart; k < fftSize; ++k)
+        frame[(size_t) k] = (float) channel.input[(size_t) (k - firstPart)] * analysisWindow[(size_t) k];
+
+    fft->performRealOnlyForwardTransform (frame.data(), true);
+    processor->processFrame (ch, reinterpret_cast<Complex*> (frame.data()), getNumBins());
+    fft->performRealOnlyInverseTransform (frame.data());
+
+    for (int k = 0; k < firstPart; ++k)
+        channel.output[(size_t) (position + k)] += (SampleType) (frame[(size_t) k] * synthesisWindow[(size_t) k]);
+
+    for (int k = firstPart; k < fftSize; ++k)
+        channel.output[(size_t) (k - firstPart)] += (SampleType) (frame[(size_t) k] * synthesisWindow[(size_t) k]);
+}
+
+template <typename SampleType>
+void StreamingSTFT<SampleType>::processStereoFrame (FrameProcessor& processor) noexcept
+{
+    auto& left = channels[0];
+    auto& right = channels[1];
+    const auto firstPart = fftSize - position;
+    const auto numBins = getNumBins();
+    const auto mask = fftSize - 1;
+
+    // z = L + jR, оба канала с окном анализа
+    for (int k = 0; k < fftSize; ++k)
+    {
+        const auto index = (size_t) ((position + k) & mask);
+        const auto w = analysisWindow[(size_t) k];
+        packedFrame[(size_t) k] = { (float) left.input[index] * w, (float) right.input[index] * w };
+    }
+
+    fft->perform (packedFrame.data(), packedSpectrum.data(), false);
+
+    // Спектры вещественных сигналов эрмитовы: L[k] = (Z[k] + Z*[N-k]) / 2, R[k] = (Z[k] - Z*[N-k]) / 2j
+    for (int k = 0; k < numBins; ++k)
+    {
+        const auto z = packedSpectrum[(size_t) k];
+        const auto mirrored = std::conj (packedSpectrum[(size_t) ((fftSize - k) & mask)]);
+        leftBins[(size_t) k] = (z + mirrored) * 0.5f;
+        rightBins[(size_t) k] = (z - mirrored) * Complex (0.0f, -0.5f);
+    }
+
+    processor.processFrame (0, leftBins.data(), numBins);
+    processor.processFrame (1, rightBins.data(), numBins);
+
+    // Обратно в один спектр: Z = L + jR, отрицательные частоты - сопряжённые положительных
+    const Complex j (0.0f, 1.0f);
+
+    for (int k = 0; k < numBins; ++k)
+        packedSpectrum[(size_t) k] = leftBins[(size_t) k] + j * rightBins[(size_t) k];
+
+    for (int k = numBins; k < fftSize; ++k)
+        packedSpectrum[(size_t) k] = std::conj (leftBins[(size_t) (fftSize - k)]) + j * std::conj (rightBins[(size_t) (fftSize - k)]);
+
+    // DC и Найквист вещественны - мнимую часть отбрасывает и обратное вещественное FFT
+    packedSpectrum[0] = { leftBins[0].real(), rightBins[0].real() };
+    packedSpectrum[(size_t) (fftSize / 2)] = { leftBins[(size_t) (fftSize / 2)].real(), rightBins[(size_t) (fftSize / 2)].real() };
+
+    fft->perform (packedSpectrum.data(), packedFrame.data(), true);
+
+    for (int k = 0; k < fftSize; ++k)
+    {
+        const auto index = (size_t) (k < firstPart ? position + k : k - firstPart);
+        const auto w = synthesisWindow[(size_t) k];
+        left.output[index] += (SampleType) (packedFrame[(size_t) k].real() * w);
+        right.output[index] += (SampleType) (packedFrame[(size_t) k].imag() * w);
+    }
+}
+
+//==============================================================================
+template class StreamingSTFT<float>;
+template class StreamingSTFT<double>;
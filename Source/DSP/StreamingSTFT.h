@@ -0,0 +1,107 @@
+/*
+  ==============================================================================
+
+   StreamingSTFT - потоковый STFT с overlap-add для спектральных эффектов
+   Кольцевые буферы на каждый канал, все кадры выделены в prepare():
+   в аудио-потоке ни аллокаций, ни сдвигов буферов
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <juce_audio_processors/juce_audio_processors.h>
+#include <juce_dsp/juce_dsp.h>
+#include <memory>
+#include <vector>
+
+//==============================================================================
+/** Streaming short-time Fourier transform with weighted overlap-add.
+
+    Every hopSize samples the newest fftSize input samples of each channel are
+    Hann-windowed, transformed, handed to a FrameProcessor, transformed back,
+    windowed again and added into the channel's output ring. The output is the
+    input delayed by exactly getLatencySamples() when the frames are left
+    untouched.
+
+    The cost per block is bounded: at most ceil (numSamples / hopSize) frames
+    per channel, each one FFT pair plus O(fftSize) work. Without a processor
+    (nothing to change in the spectrum) no FFT is done at all - the frames are
+    only windowed, which keeps the overlap-add state continuous, so switching
+    the processor on and off never clicks.
+
+    Spectra are always float (juce::dsp::FFT); the rings and the untouched
+    path keep SampleType precision.
+
+    With stereo packing on and exactly two channels, L and R go into the real
+    and imaginary parts of one complex transform and are separated by
+    conjugate symmetry: one FFT pair per hop instead of two. The processor
+    sees the same per-channel spectra either way.
+*/
+template <typename SampleType>
+class StreamingSTFT
+{
+public:
+    using Complex = juce::dsp::Complex<float>;
+
+    /** Spectral callback, called on the audio thread once per hop and channel. */
+    struct FrameProcessor
+    {
+        virtual ~FrameProcessor() = default;
+
+        /** bins holds fftSize / 2 + 1 bins (DC to Nyquist), modified in place. */
+        virtual void processFrame (int channel, Complex* bins, int numBins) noexcept = 0;
+    };
+
+    StreamingSTFT() = default;
+
+    /** Allocates everything. hopSize must divide fftSize and be at most fftSize / 4
+        (Hann analysis and synthesis windows overlap-add to a constant from there).
+    */
+    void prepare (int numChannels, int fftOrder, int hopSize);
+    void reset() noexcept;
+
+    /** In place: buffer is replaced by the resynthesised signal, delayed by getLatencySamples().
+        processor may be nullptr - the signal then passes through unchanged (only delayed).
+    */
+    void process (juce::AudioBuffer<SampleType>& buffer, FrameProcessor* processor) noexcept;
+
+    /** Two channels share one complex FFT (see above). Can be switched at any time. */
+    void setStereoPacking (bool shouldPack) noexcept  { stereoPacking = shouldPack; }
+    bool isStereoPacking() const noexcept              { return stereoPacking; }
+
+    int getLatencySamples() const noexcept  { return fftSize; }
+    int getFFTSize() const noexcept         { return fftSize; }
+    int getHopSize() const noexcept         { return hopSize; }
+    int getNumBins() const noexcept         { return fftSize / 2 + 1; }
+
+private:
+    void processFrame (int channel, FrameProcessor* processor) noexcept;
+    void processStereoFrame (FrameProcessor& processor) noexcept;
+
+    struct Channel
+    {
+        std::vector<SampleType> input;   // последние fftSize входных семплов
+        std::vector<SampleType> output;  // накопитель overlap-add
+    };
+
+    std::unique_ptr<juce::dsp::FFT> fft;
+    std::vector<Channel> channels;
+
+    std::vector<float> frame;                    // 2 * fftSize: формат real-only FFT JUCE
+    std::vector<float> analysisWindow;           // Hann
+    std::vector<float> synthesisWindow;          // Hann с нормировкой overlap-add
+    std::vector<SampleType> passThroughWindow;   // analysis * synthesis - кадр без FFT
+
+    // Упакованный стерео кадр: L + jR, его спектр и разделённые спектры каналов
+    std::vector<Complex> packedFrame, packedSpectrum;
+    std::vector<Complex> leftBins, rightBins;
+    bool stereoPacking = false;
+
+    int fftSize = 0;
+    int hopSize = 0;
+    int position = 0;      // общая позиция колец (каналы идут синхронно)
+    int hopPosition = 0;   // семплов с последнего кадра
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (StreamingSTFT)
+};
@@ -0,0 +1,183 @@
+/*
+  ==============================================================================
+
+   MixStage - финальное сведение dry/wet и выходная громкость
+   Рампы усиления считаются один раз на блок, применяются векторно по каналам
+
+  ==============================================================================
+*/
+
+#include "MixStage.h"
+
+//==============================================================================
+template <typename SampleType>
+void MixStage<SampleType>::prepare (const juce::dsp::ProcessSpec& spec, int latencySamples)
+{
+    mixSmoother.reset (spec.sampleRate, SMOOTHING_TIME_SEC);
+    outputSmoother.reset (spec.sampleRate, SMOOTHING_TIME_SEC);
+
+    dryGainRamp.assign (juce::jmax<size_t> (1, spec.maximumBlockSize), SampleType (0));
+    wetGainRamp.assign (juce::jmax<size_t> (1, spec.maximumBlockSize), SampleType (0));
+
+    dryDelay.setSize ((int) spec.numChannels, juce::jmax (0, latencySamples));
+    clearDryDelay();
+}
+
+template <typename SampleType>
+void MixStage<SampleType>::reset (float mix, float output)
+{
+    mixSmoother.setCurrentAndTargetValue (mix);
+    outputSmoother.setCurrentAndTargetValue (output);
+}
+
+template <typename SampleType>
+void MixStage<SampleType>::setTargets (float mix, float output) noexcept
+{
+    mixSmoother.setTargetValue (mix);
+    outputSmoother.setTargetValue (output);
+}
+
+template <typename SampleType>
+void MixStage<SampleType>::skip (int numSamples) noexcept
+{
+    mixSmoother.skip (numSamples);
+    outputSmoother.skip (numSamples);
+}
+
+//==============================================================================
+template <typename SampleType>
+void MixStage<SampleType>::delayDry (juce::AudioBuffer<SampleType>& dry) noexcept
+{
+    auto delayLength = dryDelay.getNumSamples();
+    auto numSamples = dry.getNumSamples();
+    auto numChannels = juce::jmin (dry.getNumChannels(), dryDelay.getNumChannels());
+
+    if (delayLength == 0)
+        return;
+
+    // Обмен с кольцом отрезками до точки разворота: вышедший семпл на место вошедшего
+    for (int start = 0; start < numSamples;)
+    {
+        auto count = juce::jmin (numSamples - start, delayLength - dryDelayPosition);
+
+        for (int channel = 0; channel < numChannels; ++channel)
+        {
+            auto* data = dry.getWritePointer (channel, start);
+            std::swap_ranges (data, data + count, dryDelay.getWritePointer (channel, dryDelayPosition));
+        }
+
+        start += count;
+        dryDelayPosition = (dryDelayPosition + count) % delayLength;
+    }
+}
+
+template <typename SampleType>
+void MixStage<SampleType>::pushDry (const juce::AudioBuffer<SampleType>& dry) noexcept
+{
+    auto delayLength = dryDelay.getNumSamples();
+    auto numSamples = dry.getNumSamples();
+    auto numChannels = juce::jmin (dry.getNumChannels(), dryDelay.getNumChannels());
+
+    if (delayLength == 0)
+        return;
+
+    // Нужны только последние delayLength семплов
+    auto start = juce::jmax (0, numSamples - delayLength);
+    dryDelayPosition = (dryDelayPosition + start) % delayLength;
+
+    while (start < numSamples)
+    {
+        auto count = juce::jmin (numSamples - start, delayLength - dryDelayPosition);
+
+        for (int channel = 0; channel < numChannels; ++channel)
+            dryDelay.copyFrom (channel, dryDelayPosition, dry, channel, start, count);
+
+        start += count;
+        dryDelayPosition = (dryDelayPosition + count) % delayLength;
+    }
+}
+
+template <typename SampleType>
+void MixStage<SampleType>::clearDryDelay() noexcept
+{
+    dryDelay.clear();
+    dryDelayPosition = 0;
+}
+
+//==============================================================================
+template <typename SampleType>
+void MixStage<SampleType>::process (juce::AudioBuffer<SampleType>& buffer, const juce::AudioBuffer<SampleType>& dry) noexcept
+{
+    auto numSamples = buffer.getNumSamples();
+    auto numChannels = juce::jmin (buffer.getNumChannels(), dry.getNumChannels());
+
+    // Быстрый путь: оба сглаживателя на месте - постоянные коэффициенты
+    if (! mixSmoother.isSmoothing() && ! outputSmoother.isSmoothing())
+    {
+        auto mix = static_cast<SampleType> (mixSmoother.getCurrentValue());
+        auto output = static_cast<SampleType> (outputSmoother.getCurrentValue());
+        auto wetGain = mix * output;
+        auto dryGain = (SampleType (1) - mix) * output;
+
+        for (int channel = 0; channel < numChannels; ++channel)
+        {
+            auto* out = buffer.getWritePointer (channel);
+            juce::FloatVectorOperations::multiply (out, wetGain, numSamples);
+            juce::FloatVectorOperations::addWithMultiply (out, dry.getReadPointer (channel), dryGain, numSamples);
+        }
+
+        return;
+    }
+
+    jassert (numSamples <= (int) wetGainRamp.size());
+    numSamples = juce::jmin (numSamples, (int) wetGainRamp.size());
+
+    // Рампы один раз на блок - общие для всех каналов
+    for (int sample = 0; sample < numSamples; ++sample)
+    {
+        auto mix = static_cast<SampleType> (mixSmoother.getNextValue());
+        auto output = static_cast<SampleType> (outputSmoother.getNextValue());
+        wetGainRamp[(size_t) sample] = mix * output;
+        dryGainRamp[(size_t) sample] = (SampleType (1) - mix) * output;
+    }
+
+    for (int channel = 0; channel < numChannels; ++channel)
+    {
+        auto* out = buffer.getWritePointer (channel);
+        juce::FloatVectorOperations::multiply (out, wetGainRamp.data(), numSamples);
+        juce::FloatVectorOperations::addWithMultiply (out, dry.getReadPointer (channel), dryGainRamp.data(), numSamples);
+    }
+}
+
+template <typename SampleType>
+void MixStage<SampleType>::applyOutputGain (juce::AudioBuffer<SampleType>& buffer) noexcept
+{
+    auto numSamples = buffer.getNumSamples();
+    auto numChannels = buffer.getNumChannels();
+
+    mixSmoother.skip (numSamples);
+
+    if (! outputSmoother.isSmoothing())
+    {
+        auto output = static_cast<SampleType> (outputSmoother.getCurrentValue());
+
+        if (output != SampleType (1))
+            for (int channel = 0; channel < numChannels; ++channel)
+                juce::FloatVectorOperations::multiply (buffer.getWritePointer (channel), output, numSamples);
+
+        return;
+    }
+
+    jassert (numSamples <= (int) wetGainRamp.size());
+    numSamples = juce::jmin (numSamples, (int) wetGainRamp.size());
+
+    for (int sample = 0; sample < numSamples; ++sample)
+        wetGainRamp[(size_t) sample] = static_cast<SampleType> (outputSmoother.getNextValue());
+
+    for (int channel = 0; channel < numChannels; ++channel)
+        juce::FloatVectorOperations::multiply (buffer.getWritePointer (channel), wetGainRamp.data(), numSamples);
+}
+
+//==============================================================================
+template class MixStage<float>;
+template class MixStage<double>;
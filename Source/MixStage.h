@@ -0,0 +1,79 @@
+/*
+  ==============================================================================
+
+   MixStage - финальное сведение dry/wet и выходная громкость
+   Рампы усиления считаются один раз на блок, применяются векторно по каналам
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <juce_audio_processors/juce_audio_processors.h>
+#include <algorithm>
+#include <vector>
+
+//==============================================================================
+/** out = (dry * (1 - mix) + wet * mix) * output
+
+    Owns the mix and output smoothers. Per block the smoothed values are
+    written into dry/wet gain ramps once, then every channel is processed
+    with FloatVectorOperations. When both smoothers have settled the gains
+    are constant and no ramp is filled at all.
+
+    The wet chain has latency (SpectralEngine STFT), so the dry side goes
+    through a delay of the same length before it is mixed back in.
+*/
+template <typename SampleType>
+class MixStage
+{
+public:
+    MixStage() = default;
+
+    /** latencySamples: delay of the wet chain, the dry signal is delayed to match. */
+    void prepare (const juce::dsp::ProcessSpec& spec, int latencySamples);
+
+    /** Jumps to the given values without smoothing. */
+    void reset (float mix, float output);
+
+    void setTargets (float mix, float output) noexcept;
+
+    /** Advances the smoothers without producing audio (the processor is asleep). */
+    void skip (int numSamples) noexcept;
+
+    /** Delays the dry signal in place by the wet chain's latency. */
+    void delayDry (juce::AudioBuffer<SampleType>& dry) noexcept;
+
+    /** Feeds the dry delay without reading it back (the dry side is not heard right now). */
+    void pushDry (const juce::AudioBuffer<SampleType>& dry) noexcept;
+
+    void clearDryDelay() noexcept;
+
+    int getLatencySamples() const noexcept  { return dryDelay.getNumSamples(); }
+
+    /** Mix has settled at 0 - the wet signal is not heard. */
+    bool isWetSilent() const noexcept  { return ! mixSmoother.isSmoothing() && mixSmoother.getTargetValue() <= 0.0f; }
+
+    /** Mix has settled at 1 - the dry signal is not heard. */
+    bool isDrySilent() const noexcept  { return ! mixSmoother.isSmoothing() && mixSmoother.getTargetValue() >= 1.0f; }
+
+    /** buffer holds the wet signal on input and the mixed output on return. */
+    void process (juce::AudioBuffer<SampleType>& buffer, const juce::AudioBuffer<SampleType>& dry) noexcept;
+
+    /** Only the output gain (mix settled at 0 or 1, the other side is not heard). */
+    void applyOutputGain (juce::AudioBuffer<SampleType>& buffer) noexcept;
+
+private:
+    juce::LinearSmoothedValue<float> mixSmoother, outputSmoother;
+
+    // Рампы на один блок (размер - maximumBlockSize из prepare)
+    std::vector<SampleType> dryGainRamp, wetGainRamp;
+
+    // Кольцо задержки dry: длина = задержка wet-цепочки
+    juce::AudioBuffer<SampleType> dryDelay;
+    int dryDelayPosition = 0;
+
+    static constexpr double SMOOTHING_TIME_SEC = 0.03;  // 30 мс, как у остальных параметров
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (MixStage)
+};
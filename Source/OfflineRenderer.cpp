@@ -116,6 +116,12 @@ void OfflineRenderer::parsePresetParams (const juce::String& params)
             float normalized = (floatValue + 0.5f) / 1.0f;
             processor->state.getParameter ("clarity")->setValueNotifyingHost (normalized);
         }
+        else if (keyValue == "latency")
+        {
+            // Latency: индекс тира 0 (tracking), 1 (balanced), 2 (mixdown)
+            auto* latency = processor->state.getParameter ("latency");
+            latency->setValueNotifyingHost (latency->convertTo0to1 (floatValue));
+        }
         else if (keyValue == "output")
         {
             // Output: 0.0 to 2.0, нормализуем в 0.0-1.0 для setValueNotifyingHost
@@ -145,9 +151,6 @@ bool OfflineRenderer::renderFile (const juce::String& inputFile,
               << " каналов, " << audioBuffer.getNumSamples() 
               << " семплов, " << sampleRate << " Гц" << std::endl;
     
-    // Подготавливаем процессор
-    processor->prepareToPlay (sampleRate, 512);
-    
     // Устанавливаем параметры ПЕРЕД установкой Output по умолчанию
     // (чтобы если в параметрах указан output, он не перезаписывался)
     if (presetParams.isNotEmpty())
@@ -165,32 +168,57 @@ bool OfflineRenderer::renderFile (const juce::String& inputFile,
         processor->state.getParameter ("output")->setValueNotifyingHost (1.0f);
     }
     
+    // Подготавливаем процессор после параметров: тир задержки читается в prepareToPlay.
+    // Рендер быстрее реального времени - фоновый STFT должен ждать worker, а не уходить в dry
+    processor->setNonRealtime (true);
+    processor->prepareToPlay (sampleRate, 512);
+    
     // Обрабатываем аудио блоками
     const int blockSize = 512;
     int numSamples = audioBuffer.getNumSamples();
     int numChannels = audioBuffer.getNumChannels();
     
+    // Компенсация задержки (STFT): файл дополняется тишиной на latency семплов,
+    // результат пишется со сдвигом назад - выход совпадает со входом по времени
+    const int latency = processor->getLatencySamples();
+    
     juce::MidiBuffer midiBuffer;
     
-    for (int pos = 0; pos < numSamples; pos += blockSize)
+    for (int pos = 0; pos < numSamples + latency; pos += blockSize)
     {
-        int samplesToProcess = juce::jmin (blockSize, numSamples - pos);
+        int samplesToProcess = juce::jmin (blockSize, numSamples + latency - pos);
         
         juce::AudioBuffer<float> block (numChannels, samplesToProcess);
+        block.clear();
         
-        for (int ch = 0; ch < numChannels; ++ch)
-            block.copyFrom (ch, 0, audioBuffer, ch, pos, samplesToProcess);
+        if (pos < numSamples)
+            for (int ch = 0; ch < numChannels; ++ch)
+                block.copyFrom (ch, 0, audioBuffer, ch, pos, juce::jmin (samplesToProcess, numSamples - pos));
         
         processor->processBlock (block, midiBuffer);
+        processor->profiler.collect();  // Тот же поток - кольцо не переполняется на длинных файлах
+        
+        // Семпл pos + i выхода соответствует семплу pos + i - latency входа (он уже прочитан)
+        auto outputStart = pos - latency;
+        auto skip = juce::jmax (0, -outputStart);
+        auto count = juce::jmin (samplesToProcess - skip, numSamples - (outputStart + skip));
         
-        for (int ch = 0; ch < numChannels; ++ch)
-            audioBuffer.copyFrom (ch, pos, block, ch, 0, samplesToProcess);
+        if (count > 0)
+            for (int ch = 0; ch < numChannels; ++ch)
+                audioBuffer.copyFrom (ch, outputStart + skip, block, ch, skip, count);
     }
     
     // Сохраняем результат
     if (! saveAudioFile (outputFile, audioBuffer, sampleRate))
         return false;
     
+    if (StageProfiler::enabled)
+    {
+        std::cout << "   CPU по модулям (последние вызовы):" << std::endl;
+        std::cout << processor->profiler.getSummary (JuceDemoPluginAudioProcessor::stageNames,
+                                                     JuceDemoPluginAudioProcessor::numStages);
+    }
+    
     std::cout << "✅ Рендеринг завершён!" << std::endl;
     return true;
 }
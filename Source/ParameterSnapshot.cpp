@@ -0,0 +1,85 @@
+/*
+  ==============================================================================
+
+   ParameterSnapshot - снимок всех параметров плагина на один блок
+   Атомики APVTS находятся один раз в конструкторе, в processBlock - только чтение
+
+  ==============================================================================
+*/
+
+#include "ParameterSnapshot.h"
+
+//==============================================================================
+bool ParameterSnapshot::operator== (const ParameterSnapshot& other) const noexcept
+{
+    return flow == other.flow && melt == other.melt && ghost == other.ghost
+        && depth == other.depth && clarity == other.clarity && gravity == other.gravity
+        && energy == other.energy && mix == other.mix && output == other.output;
+}
+
+ParameterSnapshot ParameterSnapshot::interpolatedTowards (const ParameterSnapshot& target, float proportion) const noexcept
+{
+    // Форма (1 - p) * from + p * to: на концах ровно from / to (последний суб-блок - ровно target)
+    auto lerp = [proportion] (float from, float to) { return (1.0f - proportion) * from + proportion * to; };
+
+    ParameterSnapshot result;
+    result.flow    = lerp (flow,    target.flow);
+    result.melt    = lerp (melt,    target.melt);
+    result.ghost   = lerp (ghost,   target.ghost);
+    result.depth   = lerp (depth,   target.depth);
+    result.clarity = lerp (clarity, target.clarity);
+    result.gravity = lerp (gravity, target.gravity);
+    result.energy  = lerp (energy,  target.energy);
+    result.mix     = lerp (mix,     target.mix);
+    result.output  = lerp (output,  target.output);
+    return result;
+}
+
+int ParameterSnapshot::getNumSubBlocks (int numSamples, int maxSubBlockSize, bool automated) noexcept
+{
+    auto numSubBlocks = (numSamples + maxSubBlockSize - 1) / maxSubBlockSize;
+
+    // numSamples / min (с округлением вниз): ни один кусок не короче минимума
+    if (automated)
+        numSubBlocks = juce::jmax (numSubBlocks, numSamples / MIN_AUTOMATION_SUB_BLOCK);
+
+    return numSubBlocks;
+}
+
+int ParameterSnapshot::getSubBlockEnd (int numSamples, int numSubBlocks, int index) noexcept
+{
+    return (int) ((juce::int64) numSamples * (index + 1) / numSubBlocks);
+}
+
+//==============================================================================
+ParameterSnapshotSource::ParameterSnapshotSource (const juce::AudioProcessorValueTreeState& state)
+{
+    static constexpr const char* ids[numParameters] = { "flow", "melt", "ghost", "depth", "clarity",
+                                                        "gravity", "energy", "mix", "output" };
+
+    for (int i = 0; i < numParameters; ++i)
+    {
+        auto& parameter = parameters[(size_t) i];
+        parameter.value = state.getRawParameterValue (ids[i]);
+        parameter.range = state.getParameterRange (ids[i]);
+
+        // Все параметры создаются в конструкторе процессора до этого места
+        jassert (parameter.value != nullptr);
+    }
+}
+
+//==============================================================================
+ParameterSnapshot ParameterSnapshotSource::read() const noexcept
+{
+    ParameterSnapshot snapshot;
+    snapshot.flow    = parameters[flow].getNormalised();
+    snapshot.melt    = parameters[melt].getNormalised();
+    snapshot.ghost   = parameters[ghost].getNormalised();
+    snapshot.depth   = parameters[depth].getNormalised();
+    snapshot.clarity = parameters[clarity].getNormalised();
+    snapshot.gravity = parameters[gravity].getNormalised();
+    snapshot.energy  = parameters[energy].getNormalised();
+    snapshot.mix     = parameters[mix].getNormalised();
+    snapshot.output  = parameters[output].getNormalised();
+    return snapshot;
+}
@@ -0,0 +1,82 @@
+/*
+  ==============================================================================
+
+   ParameterSnapshot - снимок всех параметров плагина на один блок
+   Атомики APVTS находятся один раз в конструкторе, в processBlock - только чтение
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <juce_audio_processors/juce_audio_processors.h>
+#include <array>
+#include <atomic>
+
+//==============================================================================
+/** Values of all nine parameters for one block.
+    Same normalised 0..1 values as AudioProcessorParameter::getValue(),
+    which is what the processor and the DSP modules have always been fed.
+*/
+struct ParameterSnapshot
+{
+    float flow    = 0.0f;
+    float melt    = 0.0f;
+    float ghost   = 0.0f;
+    float depth   = 0.0f;
+    float clarity = 0.0f;
+    float gravity = 0.0f;
+    float energy  = 0.0f;
+    float mix     = 0.0f;
+    float output  = 0.0f;
+
+    bool operator== (const ParameterSnapshot& other) const noexcept;
+    bool operator!= (const ParameterSnapshot& other) const noexcept  { return ! operator== (other); }
+
+    /** Linear interpolation of every value: proportion 0 -> *this, 1 -> target. */
+    ParameterSnapshot interpolatedTowards (const ParameterSnapshot& target, float proportion) const noexcept;
+
+    /** Sub-blocks for one host block: enough to fit maxSubBlockSize, and when automation
+        moved, one per MIN_AUTOMATION_SUB_BLOCK samples (equal sizes, none shorter).
+    */
+    static int getNumSubBlocks (int numSamples, int maxSubBlockSize, bool automated) noexcept;
+
+    /** End sample of sub-block index; sizes differ by at most one sample. */
+    static int getSubBlockEnd (int numSamples, int numSubBlocks, int index) noexcept;
+
+    // Host automation arrives as one value per block (the last automation point).
+    // When it moves, targets are ramped from the previous block's values across
+    // sub-blocks of at least MIN_AUTOMATION_SUB_BLOCK samples instead of stepping.
+    static constexpr int MIN_AUTOMATION_SUB_BLOCK = 32;
+};
+
+//==============================================================================
+/** Resolves the APVTS raw value atomics once, so the audio thread never
+    does a string-keyed parameter lookup.
+*/
+class ParameterSnapshotSource
+{
+public:
+    explicit ParameterSnapshotSource (const juce::AudioProcessorValueTreeState& state);
+
+    /** Reads every parameter once (relaxed atomics, no locks, no allocation). */
+    ParameterSnapshot read() const noexcept;
+
+private:
+    struct CachedParameter
+    {
+        std::atomic<float>* value = nullptr;
+        juce::NormalisableRange<float> range;
+
+        float getNormalised() const noexcept
+        {
+            return range.convertTo0to1 (value->load (std::memory_order_relaxed));
+        }
+    };
+
+    enum Index { flow, melt, ghost, depth, clarity, gravity, energy, mix, output, numParameters };
+
+    std::array<CachedParameter, numParameters> parameters;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (ParameterSnapshotSource)
+};
@@ -111,6 +111,37 @@ JuceDemoPluginAudioProcessorEditor::JuceDemoPluginAudioProcessorEditor (JuceDemo
     timecodeDisplayLabel.setColour (juce::Label::textColourId, juce::Colour (0xff888888));
     timecodeDisplayLabel.setJustificationType (juce::Justification::centred);
 
+    // Тир задержки формант-шифта: Tracking / Balanced / Mixdown
+    if (auto* latencyParameter = dynamic_cast<juce::AudioParameterChoice*> (owner.state.getParameter ("latency")))
+        latencyBox.addItemList (latencyParameter->choices, 1);
+
+    latencyAttachment = std::make_unique<juce::AudioProcessorValueTreeState::ComboBoxAttachment> (owner.state, "latency", latencyBox);
+    addAndMakeVisible (latencyBox);
+
+    // Реверб: FDN или свёртка с IR из файла (загрузка - на message thread, аудио не ждёт)
+    if (auto* spaceParameter = dynamic_cast<juce::AudioParameterChoice*> (owner.state.getParameter ("space")))
+        spaceModeBox.addItemList (spaceParameter->choices, 1);
+
+    spaceModeAttachment = std::make_unique<juce::AudioProcessorValueTreeState::ComboBoxAttachment> (owner.state, "space", spaceModeBox);
+    addAndMakeVisible (spaceModeBox);
+
+    impulseResponseButton.onClick = [this] { chooseImpulseResponse(); };
+    updateImpulseResponseButton();
+    addAndMakeVisible (impulseResponseButton);
+
+    addAndMakeVisible (spectrumDisplayLabel);
+    spectrumDisplayLabel.setFont (juce::FontOptions (juce::Font::getDefaultMonospacedFontName(), 11.0f, juce::Font::plain));
+    spectrumDisplayLabel.setColour (juce::Label::textColourId, juce::Colour (0xff888888));
+    spectrumDisplayLabel.setJustificationType (juce::Justification::centredLeft);
+
+    if (StageProfiler::enabled)
+    {
+        addAndMakeVisible (profilerDisplayLabel);
+        profilerDisplayLabel.setFont (juce::FontOptions (juce::Font::getDefaultMonospacedFontName(), 10.0f, juce::Font::plain));
+        profilerDisplayLabel.setColour (juce::Label::textColourId, juce::Colour (0xff888888));
+        profilerDisplayLabel.setJustificationType (juce::Justification::topLeft);
+    }
+
     setResizeLimits (560, 500, 1000, 800);
     setResizable (true, owner.wrapperType != juce::AudioProcessor::wrapperType_AudioUnitv3);
 
@@ -188,10 +219,17 @@ void JuceDemoPluginAudioProcessorEditor::resized()
     // Title bar (already painted, but we skip it in layout)
     r.removeFromTop (40);
     
-    // Timecode display at top
-    timecodeDisplayLabel.setBounds (r.removeFromTop (24).reduced (8, 4));
+    // Timecode display at top, spectrum readout on the left, latency tier on the right
+    auto topRow = r.removeFromTop (24).reduced (8, 2);
+    latencyBox.setBounds (topRow.removeFromRight (120));
+    spectrumDisplayLabel.setBounds (topRow.removeFromLeft (130).reduced (0, 2));
+    timecodeDisplayLabel.setBounds (topRow.reduced (0, 2));
     r.removeFromTop (8);
 
+    // Profiler readout at the bottom (one line per stage)
+    if (StageProfiler::enabled)
+        profilerDisplayLabel.setBounds (r.removeFromBottom (12 * JuceDemoPluginAudioProcessor::numStages + 8).reduced (8, 4));
+
     // Arrange sliders: 3 rows of 3 sliders each
     const int sliderSize = 100;  // Larger sliders
     const int labelHeight = 24;
@@ -215,6 +253,14 @@ void JuceDemoPluginAudioProcessorEditor::resized()
     auto ghostArea = row1.removeFromLeft (sliderSize);
     ghostLabel.setBounds (ghostArea.removeFromTop (labelHeight));
     ghostSlider.setBounds (ghostArea);
+    row1.removeFromLeft (spacing);
+
+    // Space mode and IR file next to Ghost (the reverb wet level)
+    auto spaceArea = row1.removeFromLeft (140);
+    spaceArea.removeFromTop (labelHeight);
+    spaceModeBox.setBounds (spaceArea.removeFromTop (24));
+    spaceArea.removeFromTop (8);
+    impulseResponseButton.setBounds (spaceArea.removeFromTop (24));
     
     sliderArea.removeFromTop (spacing);
     
@@ -259,6 +305,32 @@ void JuceDemoPluginAudioProcessorEditor::resized()
     lastUIHeight = getHeight();
 }
 
+void JuceDemoPluginAudioProcessorEditor::chooseImpulseResponse()
+{
+    impulseResponseChooser = std::make_unique<juce::FileChooser> ("Load impulse response",
+                                                                  getProcessor().getImpulseResponseFile(),
+                                                                  "*.wav;*.aif;*.aiff;*.flac");
+
+    impulseResponseChooser->launchAsync (juce::FileBrowserComponent::openMode | juce::FileBrowserComponent::canSelectFiles,
+                                         [safeThis = juce::Component::SafePointer<JuceDemoPluginAudioProcessorEditor> (this)] (const juce::FileChooser& chooser)
+    {
+        if (safeThis == nullptr)
+            return;
+
+        const auto file = chooser.getResult();
+
+        if (file.existsAsFile() && safeThis->getProcessor().loadImpulseResponse (file))
+            safeThis->updateImpulseResponseButton();
+    });
+}
+
+void JuceDemoPluginAudioProcessorEditor::updateImpulseResponseButton()
+{
+    const auto file = getProcessor().getImpulseResponseFile();
+    impulseResponseButton.setButtonText (file == juce::File() ? juce::String ("Load IR...") : file.getFileNameWithoutExtension());
+    impulseResponseButton.setTooltip (file.getFullPathName());
+}
+
 void JuceDemoPluginAudioProcessorEditor::setupHelpButtons()
 {
     HelpButton* buttons[] = { &flowHelpButton, &meltHelpButton, &ghostHelpButton, &depthHelpButton,
@@ -442,7 +514,24 @@ void JuceDemoPluginAudioProcessorEditor::positionHelpButtons()
 
 void JuceDemoPluginAudioProcessorEditor::timerCallback()
 {
-    updateTimecodeDisplay (getProcessor().lastPosInfo.get());
+    updateTimecodeDisplay (getProcessor().lastPosInfo.read());
+
+    if (getProcessor().spectrum.hasNewData())
+    {
+        const auto& analysis = getProcessor().spectrum.read();
+        spectrumDisplayLabel.setText (juce::String (juce::roundToInt (analysis.centroidHz)) + " Hz  flat "
+                                          + juce::String (analysis.flatness, 2),
+                                      juce::dontSendNotification);
+    }
+
+    if (StageProfiler::enabled)
+    {
+        auto& profiler = getProcessor().profiler;
+        profiler.collect();
+        profilerDisplayLabel.setText (profiler.getSummary (JuceDemoPluginAudioProcessor::stageNames,
+                                                           JuceDemoPluginAudioProcessor::numStages),
+                                      juce::dontSendNotification);
+    }
 }
 
 void JuceDemoPluginAudioProcessorEditor::hostMIDIControllerIsAvailable (bool controllerIsAvailable)
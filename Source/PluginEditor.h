@@ -45,6 +45,8 @@ private:
     void updateTimecodeDisplay (const juce::AudioPlayHead::PositionInfo& pos);
 
     juce::Label timecodeDisplayLabel;
+    juce::Label profilerDisplayLabel;  // Per-stage CPU, only in profiler builds
+    juce::Label spectrumDisplayLabel;  // Centroid / flatness of the input from the shared analysis
     
     // Parameter labels
     juce::Label flowLabel { {}, "Flow:" },
@@ -73,6 +75,19 @@ private:
                                                           mixAttachment,
                                                           outputAttachment;
     
+    // Latency tier: created after the items are added (the attachment selects by item index)
+    juce::ComboBox latencyBox;
+    std::unique_ptr<juce::AudioProcessorValueTreeState::ComboBoxAttachment> latencyAttachment;
+
+    // Space mode (Algorithmic / Convolution) and the impulse response file for it
+    juce::ComboBox spaceModeBox;
+    std::unique_ptr<juce::AudioProcessorValueTreeState::ComboBoxAttachment> spaceModeAttachment;
+    juce::TextButton impulseResponseButton;
+    std::unique_ptr<juce::FileChooser> impulseResponseChooser;
+
+    void chooseImpulseResponse();
+    void updateImpulseResponseButton();
+
     juce::Colour backgroundColour;
 
     juce::Value lastUIWidth, lastUIHeight;
@@ -10,6 +10,12 @@
 #include "PluginProcessor.h"
 #include "PluginEditor.h"
 
+//==============================================================================
+const char* const JuceDemoPluginAudioProcessor::stageNames[numStages] =
+{
+    "Analysis", "Granular", "Spectral", "Binaural", "Glide", "Space", "Dynamic", "Motion"
+};
+
 //==============================================================================
 JuceDemoPluginAudioProcessor::JuceDemoPluginAudioProcessor()
     : AudioProcessor (getBusesProperties()),
@@ -24,10 +30,32 @@ JuceDemoPluginAudioProcessor::JuceDemoPluginAudioProcessor()
                  std::make_unique<juce::AudioParameterFloat> (juce::ParameterID { "gravity", 1 }, "Gravity", juce::NormalisableRange<float> (0.0f, 1.0f), 0.0f),
                  std::make_unique<juce::AudioParameterFloat> (juce::ParameterID { "energy", 1 }, "Energy", juce::NormalisableRange<float> (0.0f, 1.0f), 0.0f),
                  std::make_unique<juce::AudioParameterFloat> (juce::ParameterID { "mix", 1 }, "Mix", juce::NormalisableRange<float> (0.0f, 1.0f), 0.0f),
-                 std::make_unique<juce::AudioParameterFloat> (juce::ParameterID { "output", 1 }, "Output", juce::NormalisableRange<float> (0.0f, 2.0f), 2.0f)
-             })
+                 std::make_unique<juce::AudioParameterFloat> (juce::ParameterID { "output", 1 }, "Output", juce::NormalisableRange<float> (0.0f, 2.0f), 2.0f),
+
+                 // Задержка/качество формант-шифта (SpectralEngine): FFT 256 / 1024 / 4096
+                 std::make_unique<juce::AudioParameterChoice> (juce::ParameterID { "latency", 1 }, "Latency",
+                                                               juce::StringArray { "Tracking", "Balanced", "Mixdown" }, 1,
+                                                               juce::AudioParameterChoiceAttributes().withAutomatable (false)),
+
+                 // Реверб SpaceEngine: алгоритмический (FDN) или свёртка с загруженной IR
+                 std::make_unique<juce::AudioParameterChoice> (juce::ParameterID { "space", 1 }, "Space",
+                                                               juce::StringArray { "Algorithmic", "Convolution" }, 0,
+                                                               juce::AudioParameterChoiceAttributes().withAutomatable (false))
+             }),
+      parameterSource (state),
+      latencyTierParameter (state.getRawParameterValue ("latency")),
+      spaceModeParameter (state.getRawParameterValue ("space"))
 {
     state.state.addChild ({ "uiState", { { "width",  400 }, { "height", 200 } }, {} }, -1, nullptr);
+    state.addParameterListener ("latency", this);
+    startTimer (HOST_UPDATE_INTERVAL_MS);
+}
+
+JuceDemoPluginAudioProcessor::~JuceDemoPluginAudioProcessor()
+{
+    stopTimer();
+    state.removeParameterListener ("latency", this);
+    cancelPendingUpdate();
 }
 
 //==============================================================================
@@ -52,6 +80,24 @@ void JuceDemoPluginAudioProcessor::prepareToPlay (double newSampleRate, int samp
     processSpec.maximumBlockSize = static_cast<juce::uint32> (samplesPerBlock);
     processSpec.numChannels = static_cast<juce::uint32> (getTotalNumOutputChannels());
 
+    // Allocate audio-thread scratch space up front (process() must not allocate)
+    // Only the buffer for the current precision is allocated
+    scratchCapacity = juce::jmax (1, samplesPerBlock);
+    auto scratchChannels = 2 * juce::jmax (getTotalNumInputChannels(), getTotalNumOutputChannels());
+
+    if (isUsingDoublePrecision())
+    {
+        doubleScratch.setSize (scratchChannels, scratchCapacity, false, true, false);
+        floatScratch.setSize (0, 0);
+    }
+    else
+    {
+        floatScratch.setSize (scratchChannels, scratchCapacity, false, true, false);
+        doubleScratch.setSize (0, 0);
+    }
+
+    silentInputSamples = 0;
+
     // Initialize parameter smoothers (30ms smoothing time)
     const float smoothingTimeMs = 30.0f;
     const float smoothingTimeInSeconds = smoothingTimeMs / 1000.0f;
@@ -63,8 +109,6 @@ void JuceDemoPluginAudioProcessor::prepareToPlay (double newSampleRate, int samp
     claritySmoother.reset (newSampleRate, smoothingTimeInSeconds);
     gravitySmoother.reset (newSampleRate, smoothingTimeInSeconds);
     energySmoother.reset (newSampleRate, smoothingTimeInSeconds);
-    mixSmoother.reset (newSampleRate, smoothingTimeInSeconds);
-    outputSmoother.reset (newSampleRate, smoothingTimeInSeconds);
 
     // Set initial values
     flowSmoother.setCurrentAndTargetValue (0.0f);
@@ -74,28 +118,169 @@ void JuceDemoPluginAudioProcessor::prepareToPlay (double newSampleRate, int samp
     claritySmoother.setCurrentAndTargetValue (0.0f);
     gravitySmoother.setCurrentAndTargetValue (0.0f);
     energySmoother.setCurrentAndTargetValue (0.0f);
-    mixSmoother.setCurrentAndTargetValue (0.0f);
-    outputSmoother.setCurrentAndTargetValue (2.0f);
     
-    // Prepare DSP modules
-    granularEngine.prepare (processSpec);
-    spectralEngine.prepare (processSpec);
-    binauralFlow.prepare (processSpec);  // После Granular, перед Reverb
-    harmonicGlide.prepare (processSpec);  // Психоакустический кирпич для Platina
-    spaceEngine.prepare (processSpec);
-    dynamicLayer.prepare (processSpec);
-    motionMod.prepare (processSpec);
+    // Prepare DSP modules (only the set for the current precision)
+    // Mix/output start at the current parameter values - no fade-in ramp on the first block
+    const auto params = parameterSource.read();
+    lastParams = params;
+
+    preparedLatencyTier = getRequestedLatencyTier();
+
+    // Параметры - до prepare(): модули стартуют на них, и хвост ниже считается по ним
+    // Набор другой точности освобождается: иначе загрузка IR строила бы и для него свёртку,
+    // а его worker-ы продолжали бы опрос
+    if (isUsingDoublePrecision())
+    {
+        floatModules.release();
+        doubleModules.setParameters (params);
+        doubleModules.prepare (processSpec, preparedLatencyTier);
+        doubleModules.mixStage.reset (params.mix, params.output);
+    }
+    else
+    {
+        doubleModules.release();
+        floatModules.setParameters (params);
+        floatModules.prepare (processSpec, preparedLatencyTier);
+        floatModules.mixStage.reset (params.mix, params.output);
+    }
+
+    // STFT формант-шифта: постоянная задержка (своя на каждый тир), хост компенсирует её на остальных дорожках
+    const auto latencySamples = isUsingDoublePrecision() ? doubleModules.getLatencySamples()
+                                                         : floatModules.getLatencySamples();
+    setLatencySamples (latencySamples);
+    tailGuardSamples = static_cast<int> (std::ceil (TAIL_GUARD_SEC * newSampleRate)) + latencySamples;
+
+    // Хост может спросить хвост до первого блока
+    if (isUsingDoublePrecision())
+        updateTailLength<double> (params.mix > 0.0f);
+    else
+        updateTailLength<float> (params.mix > 0.0f);
     
     reset();
 }
 
 void JuceDemoPluginAudioProcessor::releaseResources()
 {
+    floatModules.release();
+    doubleModules.release();
+
+    floatScratch.setSize (0, 0);
+    doubleScratch.setSize (0, 0);
+    scratchCapacity = 0;
 }
 
 void JuceDemoPluginAudioProcessor::reset()
 {
+    silentInputSamples = 0;
+
     // Reset DSP modules
+    if (isUsingDoublePrecision())
+        doubleModules.reset();
+    else
+        floatModules.reset();
+}
+
+//==============================================================================
+int JuceDemoPluginAudioProcessor::getRequestedLatencyTier() const noexcept
+{
+    return juce::roundToInt (latencyTierParameter->load (std::memory_order_relaxed));
+}
+
+void JuceDemoPluginAudioProcessor::parameterChanged (const juce::String& parameterID, float)
+{
+    // Может прийти из любого потока (восстановление состояния, хост) - переподготовка только в message thread
+    if (parameterID == "latency")
+        triggerAsyncUpdate();
+}
+
+void JuceDemoPluginAudioProcessor::handleAsyncUpdate()
+{
+    if (getSampleRate() <= 0.0 || getRequestedLatencyTier() == preparedLatencyTier)
+        return;
+
+    // suspendProcessing держит callback lock: processBlock не идёт, пока буферы пересоздаются
+    suspendProcessing (true);
+    prepareToPlay (getSampleRate(), getBlockSize());
+    suspendProcessing (false);
+}
+
+void JuceDemoPluginAudioProcessor::timerCallback()
+{
+    // Аудио-поток только ставит флаг: updateHostDisplay() зовёт хост, это не для callback-а
+    if (tailLengthChanged.exchange (false, std::memory_order_acquire))
+        updateHostDisplay();
+
+    // Отыгравшая после смены IR свёртка (и её worker) - удаляется здесь, не в аудио-потоке
+    floatModules.spaceEngine.releaseRetiredImpulseResponse();
+    doubleModules.spaceEngine.releaseRetiredImpulseResponse();
+}
+
+//==============================================================================
+template <typename SampleType>
+void JuceDemoPluginAudioProcessor::DspModules<SampleType>::prepare (const juce::dsp::ProcessSpec& spec, int latencyTier)
+{
+    spectralAnalyzer.prepare (spec);
+    granularEngine.prepare (spec);
+    spectralEngine.setLatencyTier (latencyTier);
+    spectralEngine.setBackgroundProcessing (latencyTier == SpectralEngine<SampleType>::MIXDOWN_TIER);  // FFT 4096 - в фоне
+    spectralEngine.setFormantMode (latencyTier == SpectralEngine<SampleType>::TRACKING_TIER  // FFT 256 - только огибающая
+                                       ? SpectralEngine<SampleType>::FormantMode::spectralEnvelope
+                                       : SpectralEngine<SampleType>::FormantMode::binRemap);
+    spectralEngine.prepare (spec);
+    binauralFlow.prepare (spec);  // После Granular, перед Reverb
+    harmonicGlide.prepare (spec);  // Психоакустический кирпич для Platina
+    spaceEngine.prepare (spec);
+    dynamicLayer.prepare (spec);
+    motionMod.prepare (spec);
+    mixStage.prepare (spec, getLatencySamples());
+
+    for (auto& gate : gates)
+        gate.prepare (spec.sampleRate);
+
+    // Выход спектральной ступени задержан - кроссфейд с незадержанной копией дал бы флэм.
+    // Сама она не выключается (isActive() всегда true), только засыпает со всей цепочкой
+    gates[spectralStage].prepare (spec.sampleRate, 0.0);
+}
+
+template <typename SampleType>
+void JuceDemoPluginAudioProcessor::DspModules<SampleType>::release()
+{
+    spectralEngine.release();
+    spaceEngine.release();
+}
+
+template <typename SampleType>
+void JuceDemoPluginAudioProcessor::DspModules<SampleType>::setParameters (const ParameterSnapshot& params)
+{
+    // We pass the target values directly, not smoothed values
+    // Update SpaceEngine parameters (module will smooth internally)
+    spaceEngine.setDepth (params.depth);
+    spaceEngine.setFlow (params.flow);
+    spaceEngine.setGhost (params.ghost);
+    
+    // Update SpectralEngine parameters (module will smooth internally)
+    spectralEngine.setClarity (params.clarity);
+    spectralEngine.setDepth (params.depth);
+    spectralEngine.setFlow (params.flow);
+    
+    // Update MotionMod parameters (module will smooth internally)
+    motionMod.setFlow (params.flow);
+    motionMod.setEnergy (params.energy);
+    
+    // Update BinauralFlow parameters (module will smooth internally)
+    binauralFlow.setFlow (params.flow);
+    binauralFlow.setDepth (params.depth);
+    binauralFlow.setGhost (params.ghost);
+    
+    // Update HarmonicGlide parameters (module will smooth internally)
+    harmonicGlide.setEnergy (params.energy);  // Чувствительность к громкости
+    harmonicGlide.setFlow (params.flow);      // Скорость реакции
+}
+
+template <typename SampleType>
+void JuceDemoPluginAudioProcessor::DspModules<SampleType>::reset()
+{
+    spectralAnalyzer.reset();
     granularEngine.reset();
     spectralEngine.reset();
     binauralFlow.reset();
@@ -103,6 +288,82 @@ void JuceDemoPluginAudioProcessor::reset()
     spaceEngine.reset();
     dynamicLayer.reset();
     motionMod.reset();
+    mixStage.clearDryDelay();
+}
+
+template <typename SampleType>
+void JuceDemoPluginAudioProcessor::DspModules<SampleType>::analyse (const juce::AudioBuffer<SampleType>& buffer,
+                                                                    StageProfiler& profiler) noexcept
+{
+    juce::ignoreUnused (profiler);
+    VOID_PROFILE_STAGE (profiler, analysisStage, buffer.getNumSamples());
+    spectralAnalyzer.process (buffer);
+}
+
+template <typename SampleType>
+void JuceDemoPluginAudioProcessor::DspModules<SampleType>::sleep() noexcept
+{
+    for (auto& gate : gates)
+        gate.sleep();
+}
+
+//==============================================================================
+template <typename SampleType>
+void JuceDemoPluginAudioProcessor::DspModules<SampleType>::process (juce::AudioBuffer<SampleType>& buffer,
+                                                                    juce::AudioBuffer<SampleType>& bypass,
+                                                                    StageProfiler& profiler)
+{
+    // Processing chain: Granular -> Spectral -> BinauralFlow -> HarmonicGlide -> Space -> Dynamic -> Motion
+    runStage (granularEngine, granularStage, buffer, bypass, profiler);
+    runStage (spectralEngine, spectralStage, buffer, bypass, profiler);
+    runStage (binauralFlow, binauralStage, buffer, bypass, profiler);  // Психоакустический кирпич для Iceberg
+    runStage (harmonicGlide, glideStage, buffer, bypass, profiler);  // Психоакустический кирпич для Platina
+    runStage (spaceEngine, spaceStage, buffer, bypass, profiler);
+    runStage (dynamicLayer, dynamicStage, buffer, bypass, profiler);
+    runStage (motionMod, motionStage, buffer, bypass, profiler);
+}
+
+template <typename SampleType>
+template <typename Module>
+void JuceDemoPluginAudioProcessor::DspModules<SampleType>::runStage (Module& module, Stage stage,
+                                                                     juce::AudioBuffer<SampleType>& buffer,
+                                                                     juce::AudioBuffer<SampleType>& bypass,
+                                                                     StageProfiler& profiler)
+{
+    juce::ignoreUnused (profiler);
+    auto& gate = gates[stage];
+
+    switch (gate.next (module.isActive()))
+    {
+        case StageGate::Action::skip:
+            return;
+
+        case StageGate::Action::process:
+        {
+            VOID_PROFILE_STAGE (profiler, stage, buffer.getNumSamples());
+            module.process (buffer);
+            return;
+        }
+
+        case StageGate::Action::wake:
+            // Состояние модуля устарело, пока он спал (линии задержки, фильтры)
+            module.reset();
+            [[fallthrough]];
+
+        case StageGate::Action::crossfade:
+        {
+            for (int channel = 0; channel < buffer.getNumChannels(); ++channel)
+                bypass.copyFrom (channel, 0, buffer, channel, 0, buffer.getNumSamples());
+
+            {
+                VOID_PROFILE_STAGE (profiler, stage, buffer.getNumSamples());
+                module.process (buffer);
+            }
+
+            gate.crossfade (buffer, bypass);
+            return;
+        }
+    }
 }
 
 //==============================================================================
@@ -118,6 +379,12 @@ void JuceDemoPluginAudioProcessor::processBlock (juce::AudioBuffer<double>& buff
     process (buffer, midiMessages);
 }
 
+double JuceDemoPluginAudioProcessor::getTailLengthSeconds() const
+{
+    // Updated by prepareToPlay() and by the audio thread every block (reverb settings change the tail)
+    return tailLengthSeconds.load (std::memory_order_relaxed);
+}
+
 //==============================================================================
 juce::AudioProcessorEditor* JuceDemoPluginAudioProcessor::createEditor()
 {
@@ -134,7 +401,48 @@ void JuceDemoPluginAudioProcessor::getStateInformation (juce::MemoryBlock& destD
 void JuceDemoPluginAudioProcessor::setStateInformation (const void* data, int sizeInBytes)
 {
     if (auto xmlState = getXmlFromBinary (data, sizeInBytes))
+    {
         state.replaceState (juce::ValueTree::fromXml (*xmlState));
+
+        // Сохраняется только путь к IR - сама IR перечитывается из файла
+        const auto irPath = state.state.getProperty (impulseResponseProperty).toString();
+
+        if (irPath.isNotEmpty())
+            loadImpulseResponse (juce::File (irPath));
+    }
+}
+
+//==============================================================================
+bool JuceDemoPluginAudioProcessor::loadImpulseResponse (const juce::File& file)
+{
+    juce::AudioFormatManager formatManager;
+    formatManager.registerBasicFormats();
+
+    const std::unique_ptr<juce::AudioFormatReader> reader (formatManager.createReaderFor (file));
+
+    if (reader == nullptr || reader->sampleRate <= 0.0 || reader->lengthInSamples <= 0)
+        return false;
+
+    const auto maxSamples = (juce::int64) (ConvolutionReverb<float>::MAX_IR_SECONDS * reader->sampleRate);
+    const auto numSamples = (int) juce::jmin (reader->lengthInSamples, maxSamples);
+    juce::AudioBuffer<float> ir ((int) juce::jlimit (1u, 2u, reader->numChannels), numSamples);
+
+    if (! reader->read (&ir, 0, numSamples, 0, true, ir.getNumChannels() > 1))
+        return false;
+
+    // Оба набора модулей: смена точности не должна терять IR. Свёртку строит только
+    // подготовленный (текущей точности), освобождённый другой только хранит IR
+    floatModules.spaceEngine.loadImpulseResponse (ir, reader->sampleRate);
+    doubleModules.spaceEngine.loadImpulseResponse (ir, reader->sampleRate);
+
+    state.state.setProperty (impulseResponseProperty, file.getFullPathName(), nullptr);
+    return true;
+}
+
+juce::File JuceDemoPluginAudioProcessor::getImpulseResponseFile() const
+{
+    const auto irPath = state.state.getProperty (impulseResponseProperty).toString();
+    return irPath.isNotEmpty() ? juce::File (irPath) : juce::File();
 }
 
 //==============================================================================
@@ -159,22 +467,6 @@ JuceDemoPluginAudioProcessor::TrackProperties JuceDemoPluginAudioProcessor::getT
 }
 
 //==============================================================================
-void JuceDemoPluginAudioProcessor::SpinLockedPosInfo::set (const juce::AudioPlayHead::PositionInfo& newInfo)
-{
-    const juce::SpinLock::ScopedTryLockType lock (mutex);
-
-    if (lock.isLocked())
-        info = newInfo;
-}
-
-juce::AudioPlayHead::PositionInfo JuceDemoPluginAudioProcessor::SpinLockedPosInfo::get() const noexcept
-{
-    const juce::SpinLock::ScopedLockType lock (mutex);
-    return info;
-}
-
-//==============================================================================
-
 void JuceDemoPluginAudioProcessor::updateCurrentTimeInfoFromHost()
 {
     const auto newInfo = [&]
@@ -186,7 +478,7 @@ void JuceDemoPluginAudioProcessor::updateCurrentTimeInfoFromHost()
         return juce::AudioPlayHead::PositionInfo{};
     }();
 
-    lastPosInfo.set (newInfo);
+    lastPosInfo.write (newInfo);
 }
 
 JuceDemoPluginAudioProcessor::BusesProperties JuceDemoPluginAudioProcessor::getBusesProperties()
@@ -11,23 +11,36 @@
 
 #include <juce_audio_processors/juce_audio_processors.h>
 #include <juce_audio_utils/juce_audio_utils.h>
+#include <array>
+#include <atomic>
+#include <limits>
 #include <type_traits>
 #include "DSP/GranularEngine.h"
 #include "DSP/SpectralEngine.h"
+#include "DSP/SpectralAnalyzer.h"
 #include "DSP/SpaceEngine.h"
 #include "DSP/DynamicLayer.h"
 #include "DSP/MotionMod.h"
 #include "DSP/BinauralFlow.h"
 #include "DSP/HarmonicGlide.h"
+#include "MixStage.h"
+#include "ParameterSnapshot.h"
+#include "RealtimeSanitizer.h"
+#include "StageGate.h"
+#include "StageProfiler.h"
+#include "TripleBuffer.h"
 
 //==============================================================================
 /** As the name suggest, this class does the actual audio processing. */
-class JuceDemoPluginAudioProcessor final : public juce::AudioProcessor
+class JuceDemoPluginAudioProcessor final : public juce::AudioProcessor,
+                                           private juce::AudioProcessorValueTreeState::Listener,
+                                           private juce::AsyncUpdater,
+                                           private juce::Timer
 {
 public:
     //==============================================================================
     JuceDemoPluginAudioProcessor();
-    ~JuceDemoPluginAudioProcessor() override = default;
+    ~JuceDemoPluginAudioProcessor() override;
 
     //==============================================================================
     bool isBusesLayoutSupported (const BusesLayout& layouts) const override;
@@ -50,7 +63,7 @@ public:
     const juce::String getName() const override                             { return "AudioPluginDemo"; }
     bool acceptsMidi() const override                                 { return false; }
     bool producesMidi() const override                                { return false; }
-    double getTailLengthSeconds() const override                      { return 0.0; }
+    double getTailLengthSeconds() const override;
 
     //==============================================================================
     int getNumPrograms() override                                     { return 0; }
@@ -68,23 +81,33 @@ public:
 
     TrackProperties getTrackProperties() const;
 
-    class SpinLockedPosInfo
-    {
-    public:
-        void set (const juce::AudioPlayHead::PositionInfo& newInfo);
-        juce::AudioPlayHead::PositionInfo get() const noexcept;
-
-    private:
-        juce::SpinLock mutex;
-        juce::AudioPlayHead::PositionInfo info;
-    };
-
     //==============================================================================
     // These properties are public so that our editor component can access them
 
-    SpinLockedPosInfo lastPosInfo;
+    // Written by the audio thread every block, read by the editor timer (lock-free, single reader)
+    TripleBuffer<juce::AudioPlayHead::PositionInfo> lastPosInfo;
+
+    // Latest frame of the shared input analysis, written when a new frame is ready
+    TripleBuffer<SpectralAnalysis> spectrum;
     juce::AudioProcessorValueTreeState state;
 
+    //==============================================================================
+    // Impulse response for the convolution space mode. Message thread: the file is read
+    // and the convolution built here, the audio thread picks it up lock-free.
+    // The path is kept in the state and reloaded by setStateInformation().
+    bool loadImpulseResponse (const juce::File& file);
+    juce::File getImpulseResponseFile() const;
+
+    // Processing chain order - also the stage index for the profiler
+    enum Stage { analysisStage, granularStage, spectralStage, binauralStage, glideStage,
+                 spaceStage, dynamicStage, motionStage, numStages };
+
+    static const char* const stageNames[numStages];
+
+    // Per-stage CPU timing (debug builds only, empty otherwise).
+    // Audio thread writes, one reader thread calls profiler.collect() and reads the stats.
+    StageProfiler profiler;
+
 private:
     //==============================================================================
     class JuceDemoPluginAudioProcessorEditor;
@@ -93,6 +116,12 @@ private:
     template <typename FloatType>
     void process (juce::AudioBuffer<FloatType>& buffer, juce::MidiBuffer& midiMessages);
 
+    template <typename FloatType>
+    static bool isSilent (const juce::AudioBuffer<FloatType>& buffer) noexcept;
+
+    template <typename FloatType>
+    void processChunk (juce::AudioBuffer<FloatType>& buffer, const ParameterSnapshot& params);
+
     juce::CriticalSection trackPropertiesLock;
     TrackProperties trackProperties;
 
@@ -100,22 +129,143 @@ private:
 
     static BusesProperties getBusesProperties();
 
+    // Latency tier (SpectralEngine FFT size) is not automatable: a change needs new buffers
+    // and a new host latency, so the processor re-prepares itself on the message thread
+    void parameterChanged (const juce::String& parameterID, float newValue) override;
+    void handleAsyncUpdate() override;
+
+    // Message thread: изменения, о которых аудио-поток только отметил (длина хвоста), и уборка за ним
+    void timerCallback() override;
+    static constexpr int HOST_UPDATE_INTERVAL_MS = 100;
+
+    int getRequestedLatencyTier() const noexcept;
+
+    // Parameter atomics resolved once - processBlock reads a snapshot, no string lookups
+    ParameterSnapshotSource parameterSource;
+
+    std::atomic<float>* latencyTierParameter = nullptr;
+    int preparedLatencyTier = -1;
+
+    // Space mode (0 - FDN, 1 - convolution): SpaceEngine crossfades itself, read once per block
+    std::atomic<float>* spaceModeParameter = nullptr;
+    static constexpr const char* impulseResponseProperty = "impulseResponse";
+
+    // Automation moved since the last block: targets ramp from lastParams across
+    // sub-blocks (ParameterSnapshot::getNumSubBlocks) instead of stepping
+    ParameterSnapshot lastParams;
+
     // Parameter smoothing (to prevent clicks)
     juce::LinearSmoothedValue<float> flowSmoother, meltSmoother, ghostSmoother, 
                                      depthSmoother, claritySmoother, gravitySmoother,
-                                     energySmoother, mixSmoother, outputSmoother;
+                                     energySmoother;
 
     // DSP Modules
-    GranularEngine granularEngine;
-    SpectralEngine spectralEngine;
-    SpaceEngine spaceEngine;
-    DynamicLayer dynamicLayer;
-    MotionMod motionMod;
-    BinauralFlow binauralFlow;  // Психоакустический кирпич для Iceberg
-    HarmonicGlide harmonicGlide;  // Психоакустический кирпич для Platina
+    // Отдельный набор модулей на каждую точность: double путь работает нативно, без конверсии во float.
+    // Готовится только набор для текущей точности (isUsingDoublePrecision()).
+    // Каждая ступень цепочки идёт через StageGate: неактивные модули не вызываются.
+    // mixStage (dry/wet + output) тоже здесь - его рампы в той же точности, что и сигнал.
+    template <typename SampleType>
+    struct DspModules
+    {
+        void prepare (const juce::dsp::ProcessSpec& spec, int latencyTier);
+
+        /** The set is not used (other precision, or audio stopped): stops its worker threads
+            and frees the convolution, keeping the loaded IR for the next prepare().
+        */
+        void release();
+
+        void reset();
+        void setParameters (const ParameterSnapshot& params);
+
+        /** Runs the chain in place. bypass is scratch for crossfading stages that switch on/off. */
+        void process (juce::AudioBuffer<SampleType>& buffer, juce::AudioBuffer<SampleType>& bypass,
+                      StageProfiler& profiler);
+
+        /** Head of the chain: analyses the input once for every module (buffer is not changed).
+            Runs even when the wet chain is skipped, so the analysis never goes stale.
+        */
+        void analyse (const juce::AudioBuffer<SampleType>& buffer, StageProfiler& profiler) noexcept;
+
+        /** Puts every stage to sleep at once (wet signal is not heard). */
+        void sleep() noexcept;
+
+        /** Latency of the wet chain (SpectralEngine STFT); mixStage delays the dry side to match. */
+        int getLatencySamples() const noexcept  { return spectralEngine.getLatencySamples(); }
+
+        SpectralAnalyzer<SampleType> spectralAnalyzer;  // Общий FFT входа: модули читают getAnalysis()
+        GranularEngine<SampleType> granularEngine;
+        SpectralEngine<SampleType> spectralEngine;
+        SpaceEngine<SampleType> spaceEngine;
+        DynamicLayer<SampleType> dynamicLayer;
+        MotionMod<SampleType> motionMod;
+        BinauralFlow<SampleType> binauralFlow;  // Психоакустический кирпич для Iceberg
+        HarmonicGlide<SampleType> harmonicGlide;  // Психоакустический кирпич для Platina
+
+        MixStage<SampleType> mixStage;  // Owns the mix/output smoothers
+
+        std::array<StageGate, numStages> gates;
+
+    private:
+        template <typename Module>
+        void runStage (Module& module, Stage stage, juce::AudioBuffer<SampleType>& buffer,
+                       juce::AudioBuffer<SampleType>& bypass, StageProfiler& profiler);
+    };
+
+    DspModules<float> floatModules;
+    DspModules<double> doubleModules;
+
+    template <typename FloatType>
+    DspModules<FloatType>& getModules() noexcept
+    {
+        if constexpr (std::is_same_v<FloatType, float>)
+            return floatModules;
+        else
+            return doubleModules;
+    }
     
     juce::dsp::ProcessSpec processSpec;
 
+    // Scratch buffers for the audio thread - sized once in prepareToPlay,
+    // so process() never touches the heap. Only the one matching the current
+    // precision is allocated. The first half of the channels holds the dry copy
+    // of the block, the second half is the bypass copy for crossfading stages.
+    juce::AudioBuffer<float> floatScratch;
+    juce::AudioBuffer<double> doubleScratch;
+    int scratchCapacity = 0;
+
+    // Sleep mode: input below -120 dBFS and every module tail decayed -> the chain is skipped
+    // Короткие хвосты (HarmonicGlide, фильтры) покрываются TAIL_GUARD_SEC, длинный - SpaceEngine::hasTail()
+    // tailGuardSamples включает задержку цепочки: к засыпанию в линиях задержки только тишина
+    static constexpr double TAIL_GUARD_SEC = 0.05;
+    int tailGuardSamples = 0;
+    int silentInputSamples = 0;
+    std::atomic<double> tailLengthSeconds { TAIL_GUARD_SEC };
+
+    // Хосту (updateHostDisplay из timerCallback) - только изменения больше TAIL_REPORT_STEP_SEC:
+    // при движении Depth хвост меняется каждый блок
+    static constexpr double TAIL_REPORT_STEP_SEC = 0.1;
+    double reportedTailLengthSeconds = TAIL_GUARD_SEC;
+    std::atomic<bool> tailLengthChanged { false };
+
+    /** prepareToPlay() / audio thread: TAIL_GUARD_SEC + хвост SpaceEngine, если wet слышен. */
+    template <typename FloatType>
+    void updateTailLength (bool wetAudible) noexcept;
+
+    // Последний кадр анализа, отданный в spectrum: пишем только новые
+    juce::uint32 publishedSpectrumFrame = 0;
+
+    template <typename FloatType>
+    void publishSpectrum() noexcept;
+
+    template <typename FloatType>
+    juce::AudioBuffer<FloatType>& getScratch() noexcept
+    {
+        if constexpr (std::is_same_v<FloatType, float>)
+            return floatScratch;
+        else
+            return doubleScratch;
+    }
+
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (JuceDemoPluginAudioProcessor)
 };
 
@@ -126,6 +276,9 @@ template <typename FloatType>
 void JuceDemoPluginAudioProcessor::process (juce::AudioBuffer<FloatType>& buffer, juce::MidiBuffer& midiMessages)
 {
     juce::ignoreUnused (midiMessages);
+
+    // Debug builds with VOID_RT_SANITIZER: allocations, locks and sleeps from here on are reported
+    const RealtimeSanitizer::ScopedRealtimeContext realtimeContext;
     
     auto numSamples = buffer.getNumSamples();
     auto numChannels = buffer.getNumChannels();
@@ -135,133 +288,170 @@ void JuceDemoPluginAudioProcessor::process (juce::AudioBuffer<FloatType>& buffer
     for (auto i = getTotalNumInputChannels(); i < getTotalNumOutputChannels(); ++i)
         buffer.clear (i, 0, numSamples);
 
-    // Update parameter smoothers with current values
-    flowSmoother.setTargetValue (state.getParameter ("flow")->getValue());
-    meltSmoother.setTargetValue (state.getParameter ("melt")->getValue());
-    ghostSmoother.setTargetValue (state.getParameter ("ghost")->getValue());
-    depthSmoother.setTargetValue (state.getParameter ("depth")->getValue());
-    claritySmoother.setTargetValue (state.getParameter ("clarity")->getValue());
-    gravitySmoother.setTargetValue (state.getParameter ("gravity")->getValue());
-    energySmoother.setTargetValue (state.getParameter ("energy")->getValue());
-    mixSmoother.setTargetValue (state.getParameter ("mix")->getValue());
-    outputSmoother.setTargetValue (state.getParameter ("output")->getValue());
-
-    // Save dry signal for mixing
-    juce::AudioBuffer<FloatType> dryBuffer (numChannels, numSamples);
-    for (int channel = 0; channel < numChannels; ++channel)
-        dryBuffer.copyFrom (channel, 0, buffer, channel, 0, numSamples);
+    // Scratch buffers are sized for the block size given in prepareToPlay.
+    // If the host sends a bigger block, process it in chunks instead of reallocating.
+    auto& scratchBuffer = getScratch<FloatType>();
+    jassert (numChannels <= scratchBuffer.getNumChannels());
+    auto chunkChannels = juce::jmin (numChannels, scratchBuffer.getNumChannels());
+    auto chunkSize = juce::jmax (1, scratchCapacity);
+
+    // One read of all parameters per host block
+    const auto params = parameterSource.read();
+    auto& modules = getModules<FloatType>();
+    const bool wetAudible = params.mix > 0.0f || ! modules.mixStage.isWetSilent();
+
+    // Offline bounce: the background STFT and the convolution tail wait for their workers instead of missing deadlines
+    modules.spectralEngine.setNonRealtime (isNonRealtime());
+    modules.spaceEngine.setNonRealtime (isNonRealtime());
+    modules.spaceEngine.setConvolutionMode (spaceModeParameter->load (std::memory_order_relaxed) > 0.5f);
+
+    // Silence detection: once the input is silent and all tails have decayed below -120 dBFS,
+    // skip the whole chain until signal comes back
+    if (isSilent (buffer))
+        silentInputSamples = juce::jmin (silentInputSamples + numSamples, std::numeric_limits<int>::max() / 2);
+    else
+        silentInputSamples = 0;
+
+    if (silentInputSamples >= tailGuardSamples && ! (wetAudible && modules.spaceEngine.hasTail()))
+    {
+        // Модули проснутся через StageGate::Action::wake со сброшенным состоянием.
+        // Задержка dry не трогается: в ней уже только тишина (tailGuardSamples >= задержки)
+        modules.sleep();
+        buffer.clear();
 
-    // Create wet buffer for processing
-    juce::AudioBuffer<FloatType> wetBuffer (numChannels, numSamples);
-    for (int channel = 0; channel < numChannels; ++channel)
-        wetBuffer.copyFrom (channel, 0, buffer, channel, 0, numSamples);
+        modules.mixStage.setTargets (params.mix, params.output);
+        modules.mixStage.skip (numSamples);
+        lastParams = params;
 
-    // Process through DSP modules (stubs for now - pass through unchanged)
-    // Processing chain: Granular -> Spectral -> Space -> Dynamic -> Motion
-    if (numChannels > 0 && numSamples > 0)
-    {
-        // Convert to float buffer for processing (modules use float for now)
-        juce::AudioBuffer<float> floatBuffer (numChannels, numSamples);
-        
-        if constexpr (std::is_same_v<FloatType, float>)
-        {
-            floatBuffer.makeCopyOf (wetBuffer);
-        }
-        else
-        {
-            // Convert from double to float
-            for (int channel = 0; channel < numChannels; ++channel)
-            {
-                auto* src = wetBuffer.getReadPointer (channel);
-                auto* dst = floatBuffer.getWritePointer (channel);
-                for (int sample = 0; sample < numSamples; ++sample)
-                    dst[sample] = static_cast<float> (src[sample]);
-            }
-        }
-        
-        // Update module parameters from CURRENT parameter values
-        // Modules will handle their own smoothing internally
-        // We pass the target values directly, not smoothed values
-        auto flowValue = static_cast<float> (state.getParameter ("flow")->getValue());
-        auto depthValue = static_cast<float> (state.getParameter ("depth")->getValue());
-        auto ghostValue = static_cast<float> (state.getParameter ("ghost")->getValue());
-        auto energyValue = static_cast<float> (state.getParameter ("energy")->getValue());
-        auto clarityValue = static_cast<float> (state.getParameter ("clarity")->getValue());
-        
-        // Update SpaceEngine parameters (module will smooth internally)
-        spaceEngine.setDepth (depthValue);
-        spaceEngine.setFlow (flowValue);
-        spaceEngine.setGhost (ghostValue);
-        
-        // Update SpectralEngine parameters (module will smooth internally)
-        spectralEngine.setClarity (clarityValue);
-        spectralEngine.setDepth (depthValue);
-        spectralEngine.setFlow (flowValue);
-        
-        // Update MotionMod parameters (module will smooth internally)
-        motionMod.setFlow (flowValue);
-        motionMod.setEnergy (energyValue);
-        
-        // Update BinauralFlow parameters (module will smooth internally)
-        binauralFlow.setFlow (flowValue);
-        binauralFlow.setDepth (depthValue);
-        binauralFlow.setGhost (ghostValue);
-        
-        // Update HarmonicGlide parameters (module will smooth internally)
-        harmonicGlide.setEnergy (energyValue);  // Чувствительность к громкости
-        harmonicGlide.setFlow (flowValue);      // Скорость реакции
-        
-        // Process through modules
-        // Processing chain: Granular -> Spectral -> BinauralFlow -> HarmonicGlide -> Space -> Dynamic -> Motion
-        granularEngine.process (floatBuffer);
-        spectralEngine.process (floatBuffer);
-        binauralFlow.process (floatBuffer);  // Психоакустический кирпич для Iceberg
-        harmonicGlide.process (floatBuffer);  // Психоакустический кирпич для Platina
-        spaceEngine.process (floatBuffer);
-        dynamicLayer.process (floatBuffer);
-        motionMod.process (floatBuffer);
-        
-        // Convert back to FloatType and write to wet buffer
-        if constexpr (std::is_same_v<FloatType, float>)
-        {
-            wetBuffer.makeCopyOf (floatBuffer);
-        }
-        else
-        {
-            // Convert from float to double
-            for (int channel = 0; channel < numChannels; ++channel)
-            {
-                auto* src = floatBuffer.getReadPointer (channel);
-                auto* dst = wetBuffer.getWritePointer (channel);
-                for (int sample = 0; sample < numSamples; ++sample)
-                    dst[sample] = static_cast<FloatType> (src[sample]);
-            }
-        }
+        updateTailLength<FloatType> (wetAudible);
+
+        updateCurrentTimeInfoFromHost();
+        return;
     }
 
-    // Apply dry/wet mix with per-sample smoothing
-    // Process all channels with the same smoothed mix/output values
-    for (int sample = 0; sample < numSamples; ++sample)
+    // Sub-blocks: enough to fit the scratch buffers, and if automation moved since the
+    // last block, one per ParameterSnapshot::MIN_AUTOMATION_SUB_BLOCK samples (equal sizes, none shorter)
+    const bool automated = params != lastParams;
+    const auto numSubBlocks = ParameterSnapshot::getNumSubBlocks (numSamples, chunkSize, automated);
+
+    for (int index = 0, start = 0; index < numSubBlocks; ++index)
     {
-        // Get current smoothed values (smoother updates internally with getNextValue)
-        auto currentMix = static_cast<FloatType> (mixSmoother.getNextValue());
-        auto currentOutput = static_cast<FloatType> (outputSmoother.getNextValue());
-        
-        // Apply to all channels
-        for (int channel = 0; channel < numChannels; ++channel)
-        {
-            auto* dry = dryBuffer.getReadPointer (channel);
-            auto* wet = wetBuffer.getReadPointer (channel);
-            auto* out = buffer.getWritePointer (channel);
-            
-            // Mix dry and wet: out = dry * (1 - mix) + wet * mix
-            auto mixed = dry[sample] * (static_cast<FloatType> (1.0) - currentMix) + 
-                        wet[sample] * currentMix;
-            
-            // Apply output gain
-            out[sample] = mixed * currentOutput;
-        }
+        const auto end = ParameterSnapshot::getSubBlockEnd (numSamples, numSubBlocks, index);
+
+        // Non-owning view into the host buffer - no allocation
+        juce::AudioBuffer<FloatType> chunk (buffer.getArrayOfWritePointers(), chunkChannels, start, end - start);
+
+        // Each sub-block gets the automation value at its end
+        processChunk (chunk, automated ? lastParams.interpolatedTowards (params, (float) end / (float) numSamples)
+                                       : params);
+        start = end;
     }
 
+    lastParams = params;
+
+    updateTailLength<FloatType> (wetAudible);
+
+    publishSpectrum<FloatType>();
     updateCurrentTimeInfoFromHost();
 }
+
+template <typename FloatType>
+void JuceDemoPluginAudioProcessor::updateTailLength (bool wetAudible) noexcept
+{
+    const auto seconds = TAIL_GUARD_SEC + (wetAudible ? getModules<FloatType>().spaceEngine.getTailLengthSeconds() : 0.0);
+    tailLengthSeconds.store (seconds, std::memory_order_relaxed);
+
+    if (std::abs (seconds - reportedTailLengthSeconds) > TAIL_REPORT_STEP_SEC)
+    {
+        reportedTailLengthSeconds = seconds;
+        tailLengthChanged.store (true, std::memory_order_release);
+    }
+}
+
+template <typename FloatType>
+void JuceDemoPluginAudioProcessor::publishSpectrum() noexcept
+{
+    // ~6 КБ копии - раз на кадр (hop 256), а не на каждый блок
+    const auto& analysis = getModules<FloatType>().spectralAnalyzer.getAnalysis();
+
+    if (analysis.frameIndex != publishedSpectrumFrame)
+    {
+        spectrum.write (analysis);
+        publishedSpectrumFrame = analysis.frameIndex;
+    }
+}
+
+template <typename FloatType>
+bool JuceDemoPluginAudioProcessor::isSilent (const juce::AudioBuffer<FloatType>& buffer) noexcept
+{
+    for (int channel = 0; channel < buffer.getNumChannels(); ++channel)
+        if (buffer.getMagnitude (channel, 0, buffer.getNumSamples()) > static_cast<FloatType> (SpaceEngine<FloatType>::SILENCE_LEVEL))
+            return false;
+
+    return true;
+}
+
+template <typename FloatType>
+void JuceDemoPluginAudioProcessor::processChunk (juce::AudioBuffer<FloatType>& buffer, const ParameterSnapshot& params)
+{
+    auto numSamples = buffer.getNumSamples();
+    auto numChannels = buffer.getNumChannels();
+
+    // Update parameter smoothers with current values
+    flowSmoother.setTargetValue (params.flow);
+    meltSmoother.setTargetValue (params.melt);
+    ghostSmoother.setTargetValue (params.ghost);
+    depthSmoother.setTargetValue (params.depth);
+    claritySmoother.setTargetValue (params.clarity);
+    gravitySmoother.setTargetValue (params.gravity);
+    energySmoother.setTargetValue (params.energy);
+
+    auto& modules = getModules<FloatType>();
+    modules.mixStage.setTargets (params.mix, params.output);
+
+    if (numChannels == 0 || numSamples == 0)
+        return;
+
+    // Update module parameters from CURRENT parameter values
+    // Modules will handle their own smoothing internally
+    modules.setParameters (params);
+
+    // Shared analysis first: every stage below (and the editor) sees this chunk's input
+    modules.analyse (buffer, profiler);
+
+    // Mix settled at 0: the wet chain is not heard - skip it and the dry copy entirely.
+    // The output still carries the reported latency
+    if (modules.mixStage.isWetSilent())
+    {
+        modules.sleep();
+        modules.mixStage.delayDry (buffer);
+        modules.mixStage.applyOutputGain (buffer);
+        return;
+    }
+
+    // Views into the preallocated scratch buffer (no allocation on the audio thread)
+    auto& scratch = getScratch<FloatType>();
+    auto scratchHalf = scratch.getNumChannels() / 2;
+    juce::AudioBuffer<FloatType> dryBuffer (scratch.getArrayOfWritePointers(), numChannels, numSamples);
+    juce::AudioBuffer<FloatType> bypassBuffer (scratch.getArrayOfWritePointers() + scratchHalf, numChannels, numSamples);
+
+    // Mix settled at 1: the dry signal is not heard - no dry copy, just the output gain
+    // (the dry delay is still fed, so it is up to date when the mix moves again)
+    if (modules.mixStage.isDrySilent())
+    {
+        modules.mixStage.pushDry (buffer);
+        modules.process (buffer, bypassBuffer, profiler);
+        modules.mixStage.applyOutputGain (buffer);
+        return;
+    }
+
+    // The only copy per block: dry signal -> scratch, modules process the host buffer in place
+    for (int channel = 0; channel < numChannels; ++channel)
+        dryBuffer.copyFrom (channel, 0, buffer, channel, 0, numSamples);
+
+    modules.mixStage.delayDry (dryBuffer);
+    modules.process (buffer, bypassBuffer, profiler);
+
+    // Dry/wet mix and output gain: ramps filled once per chunk, applied per channel with vector ops
+    modules.mixStage.process (buffer, dryBuffer);
+}
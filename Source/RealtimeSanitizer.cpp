@@ -0,0 +1,214 @@
+/*
+  ==============================================================================
+
+   RealtimeSanitizer - отладочный режим, ловящий нарушения real-time правил
+
+   Что перехватывается:
+   - operator new / new[] (все платформы)
+   - malloc, calloc, realloc, free, memalign-семейство (glibc)
+   - pthread_mutex_lock, pthread_cond_wait/timedwait, pthread_join, sem_wait,
+     sleep, usleep, nanosleep, clock_nanosleep (glibc, через RTLD_NEXT)
+
+   Внутри перехватчиков ничего не выделяется: отчёт пишется через write(2),
+   стек - через backtrace_symbols_fd
+
+  ==============================================================================
+*/
+
+#include "RealtimeSanitizer.h"
+
+#if VOID_RT_SANITIZER
+
+#include <atomic>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+
+#if defined (__GLIBC__)
+ #include <dlfcn.h>
+ #include <execinfo.h>
+ #include <pthread.h>
+ #include <semaphore.h>
+ #include <time.h>
+ #include <unistd.h>
+ #define VOID_RT_SANITIZER_GLIBC 1
+#else
+ #define VOID_RT_SANITIZER_GLIBC 0
+#endif
+
+//==============================================================================
+namespace
+{
+    thread_local int realtimeDepth = 0;
+    thread_local bool reporting = false;
+
+    std::atomic<int> numViolations { 0 };
+
+    // Стек печатается только для первых нарушений, дальше - только счётчик
+    constexpr int MAX_REPORTED_STACKS = 16;
+
+    void writeToStderr (const char* text) noexcept
+    {
+       #if VOID_RT_SANITIZER_GLIBC
+        auto ignored = ::write (2, text, std::strlen (text));
+        juce::ignoreUnused (ignored);
+       #else
+        std::fputs (text, stderr);
+       #endif
+    }
+
+    void report (const char* functionName) noexcept
+    {
+        reporting = true;
+
+        if (numViolations.fetch_add (1) < MAX_REPORTED_STACKS)
+        {
+            writeToStderr ("[RT sanitizer] ");
+            writeToStderr (functionName);
+            writeToStderr (" called on a real-time thread\n");
+
+           #if VOID_RT_SANITIZER_GLIBC
+            void* frames[32];
+            const auto numFrames = ::backtrace (frames, 32);
+            ::backtrace_symbols_fd (frames + 2, juce::jmax (0, numFrames - 2), 2);  // без check() и report()
+            writeToStderr ("\n");
+           #endif
+        }
+
+        reporting = false;
+    }
+
+   #if VOID_RT_SANITIZER_GLIBC
+    // backtrace() при первом вызове загружает libgcc_s (с аллокациями) - делаем это заранее
+    [[maybe_unused]] const bool backtracePrimed = []
+    {
+        void* frame = nullptr;
+        ::backtrace (&frame, 1);
+        return true;
+    }();
+   #endif
+}
+
+//==============================================================================
+RealtimeSanitizer::ScopedRealtimeContext::ScopedRealtimeContext() noexcept    { ++realtimeDepth; }
+RealtimeSanitizer::ScopedRealtimeContext::~ScopedRealtimeContext() noexcept   { --realtimeDepth; }
+
+void RealtimeSanitizer::check (const char* functionName) noexcept
+{
+    if (realtimeDepth > 0 && ! reporting)
+        report (functionName);
+}
+
+bool RealtimeSanitizer::isRealtimeThread() noexcept    { return realtimeDepth > 0; }
+int RealtimeSanitizer::getNumViolations() noexcept     { return numViolations.load(); }
+void RealtimeSanitizer::resetViolations() noexcept     { numViolations = 0; }
+
+//==============================================================================
+// Heap
+#if VOID_RT_SANITIZER_GLIBC
+extern "C"
+{
+    void* __libc_malloc (size_t);
+    void* __libc_calloc (size_t, size_t);
+    void* __libc_realloc (void*, size_t);
+    void* __libc_memalign (size_t, size_t);
+    void  __libc_free (void*);
+
+    void* malloc (size_t size)                   { RealtimeSanitizer::check ("malloc");  return __libc_malloc (size); }
+    void* calloc (size_t count, size_t size)     { RealtimeSanitizer::check ("calloc");  return __libc_calloc (count, size); }
+    void* realloc (void* ptr, size_t size)       { RealtimeSanitizer::check ("realloc"); return __libc_realloc (ptr, size); }
+    void  free (void* ptr)                       { if (ptr != nullptr) RealtimeSanitizer::check ("free"); __libc_free (ptr); }
+
+    void* memalign (size_t alignment, size_t size)       { RealtimeSanitizer::check ("memalign"); return __libc_memalign (alignment, size); }
+    void* aligned_alloc (size_t alignment, size_t size)  { RealtimeSanitizer::check ("aligned_alloc"); return __libc_memalign (alignment, size); }
+
+    int posix_memalign (void** result, size_t alignment, size_t size)
+    {
+        RealtimeSanitizer::check ("posix_memalign");
+        *result = __libc_memalign (alignment, size);
+        return *result != nullptr || size == 0 ? 0 : ENOMEM;
+    }
+}
+
+static void* rawAllocate (size_t size) noexcept  { return __libc_malloc (size); }
+static void rawFree (void* ptr) noexcept         { __libc_free (ptr); }
+#else
+static void* rawAllocate (size_t size) noexcept  { return std::malloc (size); }
+static void rawFree (void* ptr) noexcept         { std::free (ptr); }
+#endif
+
+static void* checkedNew (size_t size, const char* functionName)
+{
+    RealtimeSanitizer::check (functionName);
+
+    if (auto* ptr = rawAllocate (size == 0 ? 1 : size))
+        return ptr;
+
+    throw std::bad_alloc();
+}
+
+static void checkedDelete (void* ptr, const char* functionName) noexcept
+{
+    if (ptr != nullptr)
+        RealtimeSanitizer::check (functionName);
+
+    rawFree (ptr);
+}
+
+void* operator new (size_t size)                                     { return checkedNew (size, "operator new"); }
+void* operator new[] (size_t size)                                   { return checkedNew (size, "operator new[]"); }
+void* operator new (size_t size, const std::nothrow_t&) noexcept     { RealtimeSanitizer::check ("operator new"); return rawAllocate (size == 0 ? 1 : size); }
+void* operator new[] (size_t size, const std::nothrow_t&) noexcept   { RealtimeSanitizer::check ("operator new[]"); return rawAllocate (size == 0 ? 1 : size); }
+
+void operator delete (void* ptr) noexcept                            { checkedDelete (ptr, "operator delete"); }
+void operator delete[] (void* ptr) noexcept                          { checkedDelete (ptr, "operator delete[]"); }
+void operator delete (void* ptr, size_t) noexcept                    { checkedDelete (ptr, "operator delete"); }
+void operator delete[] (void* ptr, size_t) noexcept                  { checkedDelete (ptr, "operator delete[]"); }
+void operator delete (void* ptr, const std::nothrow_t&) noexcept     { checkedDelete (ptr, "operator delete"); }
+void operator delete[] (void* ptr, const std::nothrow_t&) noexcept   { checkedDelete (ptr, "operator delete[]"); }
+
+//==============================================================================
+// Locks and blocking calls
+#if VOID_RT_SANITIZER_GLIBC
+namespace
+{
+    // Кэш адресов - атомики с константной инициализацией: guard static-локала сам берёт мьютекс
+    template <typename Function>
+    Function findNext (std::atomic<Function>& cached, const char* name) noexcept
+    {
+        auto function = cached.load (std::memory_order_acquire);
+
+        if (function == nullptr)
+        {
+            function = reinterpret_cast<Function> (::dlsym (RTLD_NEXT, name));
+            cached.store (function, std::memory_order_release);
+        }
+
+        return function;
+    }
+}
+
+#define VOID_RT_INTERCEPT(returnType, name, params, args)                         \
+    extern "C" returnType name params                                             \
+    {                                                                             \
+        RealtimeSanitizer::check (#name);                                         \
+        static std::atomic<returnType (*) params> next { nullptr };              \
+        return findNext (next, #name) args;                                       \
+    }
+
+VOID_RT_INTERCEPT (int, pthread_mutex_lock, (pthread_mutex_t* mutex), (mutex))
+VOID_RT_INTERCEPT (int, pthread_cond_wait, (pthread_cond_t* cond, pthread_mutex_t* mutex), (cond, mutex))
+VOID_RT_INTERCEPT (int, pthread_cond_timedwait, (pthread_cond_t* cond, pthread_mutex_t* mutex, const struct timespec* time), (cond, mutex, time))
+VOID_RT_INTERCEPT (int, pthread_join, (pthread_t thread, void** result), (thread, result))
+VOID_RT_INTERCEPT (int, sem_wait, (sem_t* semaphore), (semaphore))
+VOID_RT_INTERCEPT (unsigned int, sleep, (unsigned int seconds), (seconds))
+VOID_RT_INTERCEPT (int, usleep, (useconds_t microseconds), (microseconds))
+VOID_RT_INTERCEPT (int, nanosleep, (const struct timespec* duration, struct timespec* remaining), (duration, remaining))
+VOID_RT_INTERCEPT (int, clock_nanosleep, (clockid_t clock, int flags, const struct timespec* duration, struct timespec* remaining), (clock, flags, duration, remaining))
+
+#undef VOID_RT_INTERCEPT
+#endif
+
+#endif
@@ -0,0 +1,62 @@
+/*
+  ==============================================================================
+
+   RealtimeSanitizer - отладочный режим, ловящий нарушения real-time правил
+   в аудио-потоке: аллокации (operator new, malloc), блокировки мьютексов
+   и блокирующие вызовы (sleep, ожидание condition variable, join)
+
+   Включается сборкой с VOID_RT_SANITIZER=1 (CMake: -DVOID_RT_SANITIZER=ON,
+   только для offline_render и test_basic - перехват malloc в плагине
+   затронул бы весь хост). Без флага все вызовы - пустые inline-функции
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <juce_core/juce_core.h>
+
+#ifndef VOID_RT_SANITIZER
+ #define VOID_RT_SANITIZER 0
+#endif
+
+//==============================================================================
+/** Marks code that must be real-time safe and reports what breaks the rules.
+
+    Everything the current thread does while a ScopedRealtimeContext is alive
+    is checked. Each violation is counted, and the first few are printed to
+    stderr with the call stack of the offending call.
+*/
+class RealtimeSanitizer
+{
+public:
+    static constexpr bool enabled = VOID_RT_SANITIZER != 0;
+
+    /** The current thread is real-time until this goes out of scope. Nestable. */
+    class ScopedRealtimeContext
+    {
+    public:
+        ScopedRealtimeContext() noexcept;
+        ~ScopedRealtimeContext() noexcept;
+
+        JUCE_DECLARE_NON_COPYABLE (ScopedRealtimeContext)
+    };
+
+    /** Called by the interceptors: reports if the current thread is real-time. */
+    static void check (const char* functionName) noexcept;
+
+    static bool isRealtimeThread() noexcept;
+
+    /** Violations since start (or the last reset), across all threads. */
+    static int getNumViolations() noexcept;
+    static void resetViolations() noexcept;
+};
+
+#if ! VOID_RT_SANITIZER
+inline RealtimeSanitizer::ScopedRealtimeContext::ScopedRealtimeContext() noexcept    {}
+inline RealtimeSanitizer::ScopedRealtimeContext::~ScopedRealtimeContext() noexcept   {}
+inline void RealtimeSanitizer::check (const char*) noexcept                         {}
+inline bool RealtimeSanitizer::isRealtimeThread() noexcept                          { return false; }
+inline int RealtimeSanitizer::getNumViolations() noexcept                           { return 0; }
+inline void RealtimeSanitizer::resetViolations() noexcept                           {}
+#endif
@@ -0,0 +1,70 @@
+/*
+  ==============================================================================
+
+   StageGate - включение/выключение DSP-модуля в цепочке без щелчков
+   Неактивный модуль не вызывается вообще, переходы идут через кроссфейд
+
+  ==============================================================================
+*/
+
+#include "StageGate.h"
+
+//==============================================================================
+StageGate::StageGate()
+{
+    prepare (44100.0);
+}
+
+void StageGate::prepare (double sampleRate, double fadeTimeSec)
+{
+    gain.reset (sampleRate, fadeTimeSec);
+    gain.setCurrentAndTargetValue (0.0f);
+}
+
+void StageGate::sleep() noexcept
+{
+    gain.setCurrentAndTargetValue (0.0f);
+}
+
+//==============================================================================
+StageGate::Action StageGate::next (bool shouldBeActive) noexcept
+{
+    const bool wasAsleep = isAsleep();
+    gain.setTargetValue (shouldBeActive ? 1.0f : 0.0f);
+
+    // Без кроссфейда усиление сразу на месте, но модуль всё равно надо сбросить
+    if (wasAsleep && shouldBeActive)
+        return Action::wake;
+
+    if (! gain.isSmoothing())
+        return gain.getCurrentValue() > 0.5f ? Action::process : Action::skip;
+
+    return wasAsleep ? Action::wake : Action::crossfade;
+}
+
+//==============================================================================
+template <typename SampleType>
+void StageGate::crossfade (juce::AudioBuffer<SampleType>& processed, const juce::AudioBuffer<SampleType>& bypassed) noexcept
+{
+    auto numSamples = processed.getNumSamples();
+    auto numChannels = juce::jmin (processed.getNumChannels(), bypassed.getNumChannels());
+
+    if (! gain.isSmoothing() && gain.getCurrentValue() >= 1.0f)
+        return;
+
+    for (int sample = 0; sample < numSamples; ++sample)
+    {
+        auto currentGain = static_cast<SampleType> (gain.getNextValue());
+
+        for (int channel = 0; channel < numChannels; ++channel)
+        {
+            auto* out = processed.getWritePointer (channel);
+            auto dry = bypassed.getSample (channel, sample);
+            out[sample] = dry + (out[sample] - dry) * currentGain;
+        }
+    }
+}
+
+//==============================================================================
+template void StageGate::crossfade<float> (juce::AudioBuffer<float>&, const juce::AudioBuffer<float>&) noexcept;
+template void StageGate::crossfade<double> (juce::AudioBuffer<double>&, const juce::AudioBuffer<double>&) noexcept;
@@ -0,0 +1,57 @@
+/*
+  ==============================================================================
+
+   StageGate - включение/выключение DSP-модуля в цепочке без щелчков
+   Неактивный модуль не вызывается вообще, переходы идут через кроссфейд
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <juce_audio_processors/juce_audio_processors.h>
+
+//==============================================================================
+/** Per-stage scheduler state.
+
+    Every block the owner asks next() whether the stage should run, passing in
+    whether the module would currently change the signal. Fully idle stages are
+    skipped; enabling and disabling crossfade between the bypassed and the
+    processed signal over FADE_TIME_SEC.
+*/
+class StageGate
+{
+public:
+    enum class Action
+    {
+        skip,       // stage is asleep - do not call the module
+        process,    // stage is fully on - process in place
+        wake,       // stage was asleep - reset the module, then process and crossfade
+        crossfade   // stage is fading in or out - process and crossfade
+    };
+
+    StageGate();
+
+    /** fadeTimeSec = 0: the stage switches without a crossfade. For stages with
+        latency, whose output cannot be blended with the undelayed bypass copy.
+    */
+    void prepare (double sampleRate, double fadeTimeSec = FADE_TIME_SEC);
+
+    /** Turns the stage off immediately, without a fade (e.g. when its output is not heard anyway). */
+    void sleep() noexcept;
+
+    Action next (bool shouldBeActive) noexcept;
+
+    /** processed = bypassed + (processed - bypassed) * gain, advancing the fade per sample. */
+    template <typename SampleType>
+    void crossfade (juce::AudioBuffer<SampleType>& processed, const juce::AudioBuffer<SampleType>& bypassed) noexcept;
+
+    bool isAsleep() const noexcept { return ! gain.isSmoothing() && gain.getTargetValue() == 0.0f; }
+
+private:
+    juce::LinearSmoothedValue<float> gain;
+
+    static constexpr double FADE_TIME_SEC = 0.01;  // 10 мс - без щелчков, но быстро
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (StageGate)
+};
@@ -0,0 +1,142 @@
+/*
+  ==============================================================================
+
+   StageProfiler - замер CPU по модулям цепочки (ns на семпл)
+
+  ==============================================================================
+*/
+
+#include "StageProfiler.h"
+
+#if VOID_ENABLE_PROFILER
+
+#include <algorithm>
+
+#if JUCE_INTEL
+ #if JUCE_MSVC
+  #include <intrin.h>
+ #else
+  #include <x86intrin.h>
+ #endif
+#endif
+
+//==============================================================================
+StageProfiler::StageProfiler()
+{
+    sortScratch.reserve (HISTORY_SIZE);
+    calibrationCycles = readCycleCounter();
+    calibrationTicks = juce::Time::getHighResolutionTicks();
+}
+
+juce::int64 StageProfiler::readCycleCounter() noexcept
+{
+   #if JUCE_INTEL
+    return (juce::int64) __rdtsc();
+   #elif JUCE_ARM && JUCE_64BIT && ! JUCE_MSVC
+    juce::uint64 value;
+    asm volatile ("mrs %0, cntvct_el0" : "=r" (value));
+    return (juce::int64) value;
+   #else
+    return juce::Time::getHighResolutionTicks();
+   #endif
+}
+
+//==============================================================================
+void StageProfiler::push (int stage, juce::int64 cycles, int numSamples) noexcept
+{
+    if (! juce::isPositiveAndBelow (stage, maxStages) || numSamples <= 0)
+        return;
+
+    int start1, size1, start2, size2;
+    fifo.prepareToWrite (1, start1, size1, start2, size2);
+
+    // Кольцо переполнено (никто не читает) - замер теряется, аудио-поток не ждёт
+    if (size1 + size2 == 0)
+        return;
+
+    ring[(size_t) (size1 > 0 ? start1 : start2)] = { stage, numSamples, cycles };
+    fifo.finishedWrite (1);
+}
+
+//==============================================================================
+void StageProfiler::collect()
+{
+    // Частота счётчика: сколько циклов прошло за известное время с момента создания
+    const auto elapsedCycles = readCycleCounter() - calibrationCycles;
+    const auto elapsedTicks = juce::Time::getHighResolutionTicks() - calibrationTicks;
+
+    if (elapsedCycles > 0 && elapsedTicks > 0)
+        nanosecondsPerCycle = (double) elapsedTicks * 1.0e9
+                                / ((double) juce::Time::getHighResolutionTicksPerSecond() * (double) elapsedCycles);
+
+    int start1, size1, start2, size2;
+    fifo.prepareToRead (fifo.getNumReady(), start1, size1, start2, size2);
+
+    auto consume = [this] (int start, int size)
+    {
+        for (int i = start; i < start + size; ++i)
+        {
+            const auto& record = ring[(size_t) i];
+            auto& h = history[(size_t) record.stage];
+
+            h.nsPerSample[(size_t) h.writeIndex] = (float) ((double) record.cycles * nanosecondsPerCycle / record.numSamples);
+            h.writeIndex = (h.writeIndex + 1) % HISTORY_SIZE;
+            h.size = juce::jmin (h.size + 1, HISTORY_SIZE);
+        }
+    };
+
+    consume (start1, size1);
+    consume (start2, size2);
+    fifo.finishedRead (size1 + size2);
+}
+
+StageProfiler::Stats StageProfiler::getStats (int stage) const
+{
+    Stats stats;
+
+    if (! juce::isPositiveAndBelow (stage, maxStages))
+        return stats;
+
+    const auto& h = history[(size_t) stage];
+
+    if (h.size == 0)
+        return stats;
+
+    sortScratch.assign (h.nsPerSample.begin(), h.nsPerSample.begin() + h.size);
+
+    double sum = 0.0;
+
+    for (auto value : sortScratch)
+        sum += value;
+
+    auto p99 = sortScratch.begin() + (std::ptrdiff_t) ((sortScratch.size() - 1) * 99 / 100);
+    std::nth_element (sortScratch.begin(), p99, sortScratch.end());
+
+    stats.numCalls = h.size;
+    stats.meanNs = sum / h.size;
+    stats.p99Ns = *p99;
+    stats.maxNs = *std::max_element (sortScratch.begin(), sortScratch.end());
+    return stats;
+}
+
+juce::String StageProfiler::getSummary (const char* const* stageNames, int numStages) const
+{
+    juce::String summary;
+
+    for (int stage = 0; stage < juce::jmin (numStages, maxStages); ++stage)
+    {
+        const auto stats = getStats (stage);
+
+        if (stats.numCalls == 0)
+            continue;
+
+        summary << juce::String (stageNames[stage]).paddedRight (' ', 10)
+                << "mean " << juce::String (stats.meanNs, 1)
+                << "  p99 " << juce::String (stats.p99Ns, 1)
+                << "  max " << juce::String (stats.maxNs, 1) << " ns/smp\n";
+    }
+
+    return summary;
+}
+
+#endif
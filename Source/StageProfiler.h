@@ -0,0 +1,130 @@
+/*
+  ==============================================================================
+
+   StageProfiler - замер CPU по модулям цепочки (ns на семпл)
+   Аудио-поток пишет замеры в lock-free кольцо, message thread (редактор,
+   офлайн-рендер) читает их и считает mean / p99 / max
+
+   Включается только в debug-сборке (JUCE_DEBUG) или явно через
+   VOID_ENABLE_PROFILER=1. В release все вызовы - пустые inline-функции,
+   VOID_PROFILE_STAGE раскрывается в ничто
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <juce_audio_processors/juce_audio_processors.h>
+#include <array>
+#include <vector>
+
+#ifndef VOID_ENABLE_PROFILER
+ #if JUCE_DEBUG
+  #define VOID_ENABLE_PROFILER 1
+ #else
+  #define VOID_ENABLE_PROFILER 0
+ #endif
+#endif
+
+//==============================================================================
+class StageProfiler
+{
+public:
+    static constexpr bool enabled = VOID_ENABLE_PROFILER != 0;
+    static constexpr int maxStages = 8;
+
+    /** Per-stage timing over the last HISTORY_SIZE calls, in nanoseconds per sample. */
+    struct Stats
+    {
+        double meanNs = 0.0, p99Ns = 0.0, maxNs = 0.0;
+        int numCalls = 0;
+    };
+
+    StageProfiler();
+
+    //==============================================================================
+    // Audio thread
+
+    /** Reads the CPU cycle counter (rdtsc / cntvct_el0, high-resolution ticks elsewhere). */
+    static juce::int64 readCycleCounter() noexcept;
+
+    /** Pushes one measurement; dropped if the reader has fallen behind. Never blocks. */
+    void push (int stage, juce::int64 cycles, int numSamples) noexcept;
+
+    class ScopedTimer
+    {
+    public:
+        ScopedTimer (StageProfiler& p, int stageIndex, int numSamplesToMeasure) noexcept
+            : profiler (p), stage (stageIndex), numSamples (numSamplesToMeasure), start (readCycleCounter()) {}
+
+        ~ScopedTimer() noexcept  { profiler.push (stage, readCycleCounter() - start, numSamples); }
+
+    private:
+        StageProfiler& profiler;
+        const int stage, numSamples;
+        const juce::int64 start;
+
+        JUCE_DECLARE_NON_COPYABLE (ScopedTimer)
+    };
+
+    //==============================================================================
+    // Message thread (single reader)
+
+    /** Drains the ring into the per-stage history. Call from one thread only. */
+    void collect();
+
+    Stats getStats (int stage) const;
+
+    /** One line per stage with calls, e.g. "Space  mean 12.3  p99 20.1  max 45.0 ns/smp". */
+    juce::String getSummary (const char* const* stageNames, int numStages) const;
+
+private:
+#if VOID_ENABLE_PROFILER
+    struct Record
+    {
+        int stage = 0;
+        int numSamples = 0;
+        juce::int64 cycles = 0;
+    };
+
+    static constexpr int RING_SIZE = 4096;
+    static constexpr int HISTORY_SIZE = 1024;
+
+    juce::AbstractFifo fifo { RING_SIZE };
+    std::array<Record, RING_SIZE> ring;
+
+    // Reader side
+    struct History
+    {
+        std::array<float, HISTORY_SIZE> nsPerSample {};
+        int writeIndex = 0;
+        int size = 0;
+    };
+
+    std::array<History, maxStages> history;
+    mutable std::vector<float> sortScratch;
+
+    // Частота счётчика циклов калибруется по juce::Time на лету, без ожидания в конструкторе
+    juce::int64 calibrationCycles = 0, calibrationTicks = 0;
+    double nanosecondsPerCycle = 1.0;
+#endif
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (StageProfiler)
+};
+
+//==============================================================================
+#if VOID_ENABLE_PROFILER
+ #define VOID_PROFILE_STAGE(profiler, stage, numSamples) \
+    const StageProfiler::ScopedTimer JUCE_JOIN_MACRO (stageTimer_, __LINE__) ((profiler), (stage), (numSamples))
+#else
+ #define VOID_PROFILE_STAGE(profiler, stage, numSamples)
+#endif
+
+#if ! VOID_ENABLE_PROFILER
+inline StageProfiler::StageProfiler() = default;
+inline juce::int64 StageProfiler::readCycleCounter() noexcept                   { return 0; }
+inline void StageProfiler::push (int, juce::int64, int) noexcept                {}
+inline void StageProfiler::collect()                                            {}
+inline StageProfiler::Stats StageProfiler::getStats (int) const                 { return {}; }
+inline juce::String StageProfiler::getSummary (const char* const*, int) const   { return {}; }
+#endif
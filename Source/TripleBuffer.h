@@ -0,0 +1,78 @@
+/*
+  ==============================================================================
+
+   TripleBuffer - передача последнего значения из аудио-потока в UI без блокировок
+   Один писатель, один читатель. Писатель никогда не ждёт и не теряет последнее
+   значение, читатель всегда получает последнюю законченную запись целиком
+
+   Подходит для любых копируемых данных: позиция плейхеда, метры, спектр
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <juce_core/juce_core.h>
+#include <array>
+#include <atomic>
+#include <type_traits>
+
+//==============================================================================
+/** Three slots: the writer owns one, the reader owns one, the third is the
+    hand-over slot. Both sides swap their slot with the hand-over slot in a
+    single atomic exchange, so neither side ever waits for the other.
+
+    Single producer, single consumer. Intermediate values the reader never
+    sees are overwritten - only the latest write matters.
+*/
+template <typename T>
+class TripleBuffer
+{
+public:
+    TripleBuffer() = default;
+
+    explicit TripleBuffer (const T& initialValue)
+    {
+        slots.fill (initialValue);
+    }
+
+    /** Writer thread only. Wait-free; the value is visible to the next read(). */
+    void write (const T& value) noexcept (std::is_nothrow_copy_assignable_v<T>)
+    {
+        slots[(size_t) writeIndex] = value;
+        const auto previous = handOver.exchange (writeIndex | freshFlag, std::memory_order_acq_rel);
+        writeIndex = previous & indexMask;
+    }
+
+    /** Reader thread only. Wait-free; returns the latest completed write.
+        The reference stays valid until the next call to read().
+    */
+    const T& read() noexcept
+    {
+        if ((handOver.load (std::memory_order_relaxed) & freshFlag) != 0)
+        {
+            const auto previous = handOver.exchange (readIndex, std::memory_order_acq_rel);
+            readIndex = previous & indexMask;
+        }
+
+        return slots[(size_t) readIndex];
+    }
+
+    /** True if a write happened since the last read(). Either thread. */
+    bool hasNewData() const noexcept
+    {
+        return (handOver.load (std::memory_order_relaxed) & freshFlag) != 0;
+    }
+
+private:
+    static constexpr int indexMask = 3, freshFlag = 4;
+
+    std::array<T, 3> slots {};
+
+    // Writer и reader держат свои индексы на разных кэш-линиях
+    alignas (64) int writeIndex = 0;
+    alignas (64) std::atomic<int> handOver { 1 };
+    alignas (64) int readIndex = 2;
+
+    JUCE_DECLARE_NON_COPYABLE (TripleBuffer)
+};
@@ -15,6 +15,30 @@
 #include "../Source/DSP/SpectralEngine.h"
 #include "../Source/DSP/SpaceEngine.h"
 #include "../Source/DSP/MotionMod.h"
+#include "../Source/DSP/GranularEngine.h"
+#include "../Source/DSP/DynamicLayer.h"
+#include "../Source/DSP/BinauralFlow.h"
+#include "../Source/DSP/HarmonicGlide.h"
+#include "../Source/DSP/StreamingSTFT.h"
+#include "../Source/DSP/BackgroundSTFT.h"
+#include "../Source/DSP/BinRemapTables.h"
+#include "../Source/DSP/BiquadCoefficientTable.h"
+#include "../Source/DSP/BiquadCascade.h"
+#include "../Source/DSP/SpectralAnalyzer.h"
+#include "../Source/DSP/FdnReverb.h"
+#include "../Source/DSP/PredelayLine.h"
+#include "../Source/DSP/FreeverbCore.h"
+#include "../Source/DSP/PartitionedConvolution.h"
+#include "../Source/DSP/ConvolutionReverb.h"
+#include "../Source/MixStage.h"
+#include "../Source/ParameterSnapshot.h"
+#include "../Source/StageGate.h"
+#include "../Source/StageProfiler.h"
+#include "../Source/TripleBuffer.h"
+#include "../Source/RealtimeSanitizer.h"
+#include <atomic>
+#include <chrono>
+#include <thread>
 
 // Простой ProcessSpec для тестов
 juce::dsp::ProcessSpec createTestSpec()
@@ -121,7 +145,7 @@ bool testSpectralClarity()
 {
     std::cout << "Тест 1: SpectralEngine - Clarity (high-shelf) работает...\n";
     
-    SpectralEngine engine;
+    SpectralEngine<float> engine;
     auto spec = createTestSpec();
     engine.prepare(spec);
     
@@ -159,7 +183,7 @@ bool testSpaceReverb()
 {
     std::cout << "\nТест 2: SpaceEngine - реверб работает...\n";
     
-    SpaceEngine engine;
+    SpaceEngine<float> engine;
     auto spec = createTestSpec();
     engine.prepare(spec);
     
@@ -197,7 +221,7 @@ bool testMotionModulation()
 {
     std::cout << "\nТест 3: MotionMod - движение работает...\n";
     
-    MotionMod engine;
+    MotionMod<float> engine;
     auto spec = createTestSpec();
     engine.prepare(spec);
     
@@ -235,9 +259,9 @@ bool testNoClips()
 {
     std::cout << "\nТест 4: Проверка клипов...\n";
     
-    SpectralEngine spectral;
-    SpaceEngine space;
-    MotionMod motion;
+    SpectralEngine<float> spectral;
+    SpaceEngine<float> space;
+    MotionMod<float> motion;
     
     auto spec = createTestSpec();
     spectral.prepare(spec);
@@ -283,9 +307,9 @@ bool testMonoCompatibility()
 {
     std::cout << "\nТест 5: Моно-совместимость...\n";
     
-    SpectralEngine spectral;
-    SpaceEngine space;
-    MotionMod motion;
+    SpectralEngine<float> spectral;
+    SpaceEngine<float> space;
+    MotionMod<float> motion;
     
     auto spec = createTestSpec();
     spectral.prepare(spec);
@@ -324,19 +348,23 @@ bool testParameterSmoothing()
 {
     std::cout << "\nТест 6: Сглаживание параметров...\n";
     
-    SpectralEngine engine;
+    SpectralEngine<float> engine;
     auto spec = createTestSpec();
     engine.prepare(spec);
     
-    auto signal = createTestSignal(4096, spec.sampleRate, 440.0f);
+    // Два последовательных блока одного непрерывного сигнала (у модуля есть задержка STFT,
+    // повторная обработка того же буфера сама дала бы скачок на стыке)
+    auto signal = createTestSignal(8192, spec.sampleRate, 440.0f);
+    juce::AudioBuffer<float> firstHalf(signal.getArrayOfWritePointers(), 2, 0, 4096);
+    juce::AudioBuffer<float> secondHalf(signal.getArrayOfWritePointers(), 2, 4096, 4096);
     
     // Резкое изменение параметра
     engine.setDepth(0.0f);
-    engine.process(signal);
+    engine.process(firstHalf);
     
     // Резко меняем на максимум
     engine.setDepth(1.0f);
-    engine.process(signal);
+    engine.process(secondHalf);
     
     // Проверяем на клики (резкие скачки)
     bool hasClicks = false;
@@ -363,6 +391,1910 @@ bool testParameterSmoothing()
     return true; // Не критично
 }
 
+// Тест 7: double путь даёт тот же результат, что и float
+bool testDoublePrecisionMatchesFloat()
+{
+    std::cout << "\nТест 7: Double precision совпадает с float...\n";
+    
+    SpaceEngine<float> spaceFloat;
+    SpaceEngine<double> spaceDouble;
+    MotionMod<float> motionFloat;
+    MotionMod<double> motionDouble;
+    
+    auto spec = createTestSpec();
+    spaceFloat.prepare(spec);
+    spaceDouble.prepare(spec);
+    motionFloat.prepare(spec);
+    motionDouble.prepare(spec);
+    
+    auto signal = createTestSignal(8192, spec.sampleRate, 440.0f);
+    juce::AudioBuffer<double> signalDouble(2, signal.getNumSamples());
+    for (int ch = 0; ch < 2; ++ch)
+        for (int i = 0; i < signal.getNumSamples(); ++i)
+            signalDouble.setSample(ch, i, signal.getSample(ch, i));
+    
+    // Блоками, как в процессоре (параметры выставляются на каждый блок)
+    const int blockSize = static_cast<int>(spec.maximumBlockSize);
+    for (int start = 0; start < signal.getNumSamples(); start += blockSize)
+    {
+        juce::AudioBuffer<float> blockFloat(signal.getArrayOfWritePointers(), 2, start, blockSize);
+        juce::AudioBuffer<double> blockDouble(signalDouble.getArrayOfWritePointers(), 2, start, blockSize);
+        
+        spaceFloat.setGhost(0.6f);
+        spaceFloat.setDepth(0.5f);
+        spaceFloat.setFlow(0.4f);
+        spaceDouble.setGhost(0.6f);
+        spaceDouble.setDepth(0.5f);
+        spaceDouble.setFlow(0.4f);
+        motionFloat.setFlow(0.5f);
+        motionFloat.setEnergy(0.4f);
+        motionDouble.setFlow(0.5f);
+        motionDouble.setEnergy(0.4f);
+        
+        spaceFloat.process(blockFloat);
+        spaceDouble.process(blockDouble);
+        motionFloat.process(blockFloat);
+        motionDouble.process(blockDouble);
+    }
+    
+    double maxDiff = 0.0;
+    for (int ch = 0; ch < 2; ++ch)
+        for (int i = 0; i < signal.getNumSamples(); ++i)
+            maxDiff = std::max(maxDiff, std::abs(signalDouble.getSample(ch, i) - (double) signal.getSample(ch, i)));
+    
+    // Реверб должен реально звучать, иначе сравнение ничего не проверяет
+    bool matches = calculateRMS(signal) > 0.001f && maxDiff < 1.0e-3;
+    
+    if (matches)
+        std::cout << "  ✅ Double совпадает с float (макс. разница: " << maxDiff << ")\n";
+    else
+        std::cout << "  ❌ Double расходится с float (макс. разница: " << maxDiff << ")\n";
+    
+    return matches;
+}
+
+// Тест 8: Планировщик ступеней - пропуск неактивных модулей и кроссфейд
+bool testStageGate()
+{
+    std::cout << "\nТест 8: Пропуск неактивных модулей (StageGate)...\n";
+    
+    auto spec = createTestSpec();
+    
+    SpaceEngine<float> space;
+    space.prepare(spec);
+    space.setGhost(0.0f);
+    bool idleWhenOff = ! space.isActive();
+    space.setGhost(0.5f);
+    bool activeWhenOn = space.isActive();
+    
+    StageGate gate;
+    gate.prepare(spec.sampleRate);
+    bool skipsWhenIdle = gate.next(false) == StageGate::Action::skip;
+    bool wakesWhenActive = gate.next(true) == StageGate::Action::wake;
+    
+    // Кроссфейд с "обработанного" (0) на bypass (1): без скачков, плавно к processed
+    auto bypass = createTestSignal(512, spec.sampleRate, 440.0f);
+    for (int ch = 0; ch < 2; ++ch)
+        std::fill(bypass.getWritePointer(ch), bypass.getWritePointer(ch) + 512, 1.0f);
+    juce::AudioBuffer<float> processed(2, 512);
+    processed.clear();
+    gate.crossfade(processed, bypass);
+    
+    bool smooth = true;
+    for (int i = 1; i < 512; ++i)
+        if (std::abs(processed.getSample(0, i) - processed.getSample(0, i - 1)) > 0.01f)
+            smooth = false;
+    
+    // 10 мс при 44.1 кГц < 512 семплов: к концу блока гейт полностью открыт
+    bool reachedProcessed = std::abs(processed.getSample(0, 511)) < 1.0e-6f;
+    bool processesWhenOpen = gate.next(true) == StageGate::Action::process;
+    
+    bool ok = idleWhenOff && activeWhenOn && skipsWhenIdle && wakesWhenActive
+           && smooth && reachedProcessed && processesWhenOpen;
+    
+    if (ok)
+        std::cout << "  ✅ Неактивные модули пропускаются, включение без щелчков\n";
+    else
+        std::cout << "  ❌ Ошибка планировщика ступеней\n";
+    
+    return ok;
+}
+
+// Тест 9: Хвост реверба - оценка затухания до -120 dBFS
+bool testSpaceTail()
+{
+    std::cout << "\nТест 9: Хвост SpaceEngine (sleep до -120 dBFS)...\n";
+    
+    SpaceEngine<float> engine;
+    auto spec = createTestSpec();
+    engine.prepare(spec);
+    
+    const int blockSize = static_cast<int>(spec.maximumBlockSize);
+    juce::AudioBuffer<float> block(2, blockSize);
+    
+    // 0.25 сек громкого сигнала, затем тишина до тех пор, пока хвост не затухнет
+    auto burst = createTestSignal(blockSize, spec.sampleRate, 440.0f);
+    int silentBlocks = 0;
+    float lastTailPeak = 0.0f;
+    const int maxBlocks = static_cast<int>(60.0 * spec.sampleRate / blockSize);
+    
+    for (int b = 0; b < maxBlocks; ++b)
+    {
+        bool loud = b < static_cast<int>(0.25 * spec.sampleRate / blockSize);
+        if (loud)
+            block.makeCopyOf(burst, true);
+        else
+            block.clear();
+        
+        engine.setGhost(0.8f);
+        engine.setDepth(1.0f);
+        engine.setFlow(0.0f);
+        engine.process(block);
+        
+        if (! loud)
+        {
+            ++silentBlocks;
+            lastTailPeak = block.getMagnitude(0, blockSize);
+            if (! engine.hasTail())
+                break;
+        }
+    }
+    
+    double tailSeconds = engine.getTailLengthSeconds();
+    double sleptAfter = silentBlocks * blockSize / spec.sampleRate;
+    
+    // Хвост затух до -120 dBFS к моменту сна, и это случилось не позже заявленной длины хвоста
+    bool ok = ! engine.hasTail() && lastTailPeak < 1.0e-6f && sleptAfter <= tailSeconds + 0.1;
+    
+    if (ok)
+        std::cout << "  ✅ Хвост затух за " << sleptAfter << " сек (заявлено " << tailSeconds << " сек)\n";
+    else
+        std::cout << "  ❌ Ошибка оценки хвоста (сон через " << sleptAfter << " сек, пик " << lastTailPeak
+                  << ", заявлено " << tailSeconds << " сек)\n";
+    
+    return ok;
+}
+
+bool testStageProfiler()
+{
+    std::cout << "\nТест 10: Профайлер модулей (кольцо замеров)...\n";
+    
+    if (! StageProfiler::enabled)
+    {
+        std::cout << "  ⏭  Профайлер выключен в этой сборке\n";
+        return true;
+    }
+    
+    StageProfiler profiler;
+    
+    // Больше замеров, чем помещается в кольцо: лишние теряются, push не блокирует
+    for (int i = 0; i < 10000; ++i)
+        profiler.push(1, 1000 + (i % 100), 100);
+    
+    profiler.collect();
+    auto stats = profiler.getStats(1);
+    bool collected = stats.numCalls > 0;
+    bool ordered = stats.meanNs > 0.0 && stats.meanNs <= stats.p99Ns + 1.0e-3 && stats.p99Ns <= stats.maxNs;
+    bool otherStagesEmpty = profiler.getStats(0).numCalls == 0;
+    
+    // После чтения кольцо снова принимает замеры
+    profiler.push(2, 500, 50);
+    profiler.collect();
+    bool refills = profiler.getStats(2).numCalls == 1;
+    
+    // ScopedTimer меряет реальную работу
+    {
+        const StageProfiler::ScopedTimer timer(profiler, 3, 64);
+        volatile double x = 0.0;
+        for (int i = 0; i < 10000; ++i)
+            x = x + std::sin((double) i);
+    }
+    profiler.collect();
+    bool timed = profiler.getStats(3).maxNs > 0.0;
+    
+    bool ok = collected && ordered && otherStagesEmpty && refills && timed;
+    
+    if (ok)
+        std::cout << "  ✅ mean " << stats.meanNs << " / p99 " << stats.p99Ns << " / max " << stats.maxNs << " ns/семпл\n";
+    else
+        std::cout << "  ❌ Ошибка профайлера\n";
+    
+    return ok;
+}
+
+bool testTripleBuffer()
+{
+    std::cout << "\nТест 11: Передача данных аудио -> UI (TripleBuffer)...\n";
+    
+    // Пара значений, которые должны всегда читаться согласованно (без "разорванных" чтений)
+    struct Pair { long long a = 0, b = 0; };
+    TripleBuffer<Pair> channel;
+    
+    const long long numWrites = 200000;
+    std::atomic<bool> done { false };
+    bool consistent = true, monotonic = true;
+    long long lastSeen = 0;
+    
+    std::thread reader ([&]
+    {
+        while (! done.load())
+        {
+            const auto& value = channel.read();
+            if (value.b != -value.a) consistent = false;
+            if (value.a < lastSeen) monotonic = false;
+            lastSeen = value.a;
+        }
+    });
+    
+    // Писатель никогда не ждёт читателя
+    for (long long i = 1; i <= numWrites; ++i)
+        channel.write ({ i, -i });
+    
+    done = true;
+    reader.join();
+    
+    // Последнее значение не теряется
+    bool latest = channel.read().a == numWrites && ! channel.hasNewData();
+    
+    bool ok = consistent && monotonic && latest;
+    
+    if (ok)
+        std::cout << "  ✅ Чтения согласованы, последнее значение доставлено\n";
+    else
+        std::cout << "  ❌ Ошибка TripleBuffer (consistent " << consistent << ", monotonic " << monotonic
+                  << ", latest " << latest << ")\n";
+    
+    return ok;
+}
+
+// Вся цепочка модулей в real-time контексте: возвращает число нарушений
+template <typename SampleType>
+int countRealtimeViolations()
+{
+    auto spec = createTestSpec();
+    
+    GranularEngine<SampleType> granular;
+    SpectralEngine<SampleType> spectral, spectralBackground;
+    BinauralFlow<SampleType> binaural;
+    HarmonicGlide<SampleType> glide;
+    SpaceEngine<SampleType> space, spaceConvolution;
+    DynamicLayer<SampleType> dynamic;
+    MotionMod<SampleType> motion;
+    
+    // IR для режима свёртки: грузится вне аудио-потока, забирается и заменяется в нём
+    juce::AudioBuffer<float> ir(2, 20000);
+    for (int ch = 0; ch < 2; ++ch)
+        for (int i = 0; i < ir.getNumSamples(); ++i)
+            ir.setSample(ch, i, std::sin(0.1f * (float) (i * (ch + 1))) * std::exp(-0.0003f * (float) i));
+    
+    granular.prepare(spec);
+    spectral.prepare(spec);
+    spectralBackground.setBackgroundProcessing(true);  // аудио-сторона фонового STFT: только FIFO
+    spectralBackground.prepare(spec);
+    binaural.prepare(spec);
+    glide.prepare(spec);
+    space.prepare(spec);
+    spaceConvolution.prepare(spec);
+    spaceConvolution.setConvolutionMode(true);
+    spaceConvolution.loadImpulseResponse(ir, 48000.0);
+    dynamic.prepare(spec);
+    motion.prepare(spec);
+    
+    juce::AudioBuffer<SampleType> buffer(2, 512);
+    RealtimeSanitizer::resetViolations();
+    
+    for (int block = 0; block < 200; ++block)
+    {
+        for (int ch = 0; ch < 2; ++ch)
+            for (int i = 0; i < 512; ++i)
+                buffer.setSample(ch, i, static_cast<SampleType> (0.5 * std::sin(0.03 * (block * 512 + i))));
+        
+        if (block == 100)
+            spaceConvolution.loadImpulseResponse(ir, spec.sampleRate);
+        
+        // Так же, как в processBlock: сеттеры и process() в аудио-потоке
+        const RealtimeSanitizer::ScopedRealtimeContext realtime;
+        
+        spectral.setClarity(0.3f);
+        spectral.setDepth(0.05f);
+        spectral.setFlow(0.8f);
+        spectralBackground.setClarity(0.3f);
+        binaural.setFlow(0.8f);
+        binaural.setDepth(0.6f);
+        binaural.setGhost(0.6f);
+        glide.setEnergy(0.7f);
+        glide.setFlow(0.8f);
+        space.setDepth(0.6f);
+        space.setFlow(0.8f);
+        space.setGhost(0.6f);
+        spaceConvolution.setDepth(0.6f);
+        spaceConvolution.setGhost(0.6f);
+        motion.setFlow(0.8f);
+        motion.setEnergy(0.7f);
+        
+        granular.process(buffer);
+        spectral.process(buffer);
+        spectralBackground.process(buffer);
+        binaural.process(buffer);
+        glide.process(buffer);
+        space.process(buffer);
+        spaceConvolution.process(buffer);
+        dynamic.process(buffer);
+        motion.process(buffer);
+    }
+    
+    return RealtimeSanitizer::getNumViolations();
+}
+
+bool testRealtimeSafety()
+{
+    std::cout << "\nТест 12: Real-time безопасность модулей (RT sanitizer)...\n";
+    
+    if (! RealtimeSanitizer::enabled)
+    {
+        std::cout << "  ⏭  Сборка без VOID_RT_SANITIZER\n";
+        return true;
+    }
+    
+    // Sanity check: сам перехват работает
+    int detected = 0;
+    {
+        const RealtimeSanitizer::ScopedRealtimeContext realtime;
+        RealtimeSanitizer::resetViolations();
+        std::vector<float> allocation(64);
+        detected = RealtimeSanitizer::getNumViolations();
+    }
+    
+    auto floatViolations = countRealtimeViolations<float>();
+    auto doubleViolations = countRealtimeViolations<double>();
+    
+    bool ok = detected > 0 && floatViolations == 0 && doubleViolations == 0;
+    
+    if (ok)
+        std::cout << "  ✅ Ни аллокаций, ни блокировок в process()\n";
+    else
+        std::cout << "  ❌ Нарушения real-time: float " << floatViolations << ", double " << doubleViolations
+                  << " (перехват " << (detected > 0 ? "работает" : "не работает") << ")\n";
+    
+    return ok;
+}
+
+// Тест 13: StreamingSTFT - overlap-add восстанавливает сигнал с задержкой fftSize
+struct IdentityFrameProcessor : StreamingSTFT<float>::FrameProcessor
+{
+    void processFrame (int, StreamingSTFT<float>::Complex*, int) noexcept override  { ++numFrames; }
+    int numFrames = 0;
+};
+
+// Прогон через STFT блоками неровного размера, возвращает макс. отклонение от задержанного входа
+template <typename SampleType>
+double measureSTFTReconstructionError (StreamingSTFT<SampleType>& stft, typename StreamingSTFT<SampleType>::FrameProcessor* processor)
+{
+    const int numSamples = 16384;
+    auto signal = createTestSignal(numSamples, 44100.0, 440.0f);
+    
+    juce::AudioBuffer<SampleType> buffer(2, numSamples);
+    for (int ch = 0; ch < 2; ++ch)
+        for (int i = 0; i < numSamples; ++i)
+            buffer.setSample(ch, i, static_cast<SampleType> (signal.getSample(ch, i) * (ch == 0 ? 1.0f : 0.5f)));
+    
+    // Размеры блоков не кратны hop - кадры попадают в середину блоков
+    const int blockSizes[] = { 1, 37, 512, 100, 255, 1000 };
+    for (int start = 0, index = 0; start < numSamples; ++index)
+    {
+        auto size = std::min(blockSizes[index % 6], numSamples - start);
+        juce::AudioBuffer<SampleType> block(buffer.getArrayOfWritePointers(), 2, start, size);
+        stft.process(block, processor);
+        start += size;
+    }
+    
+    // Первый fftSize выхода - установление overlap-add, дальше сигнал должен совпасть
+    const int latency = stft.getLatencySamples();
+    double maxError = 0.0;
+    for (int ch = 0; ch < 2; ++ch)
+        for (int i = 2 * latency; i < numSamples; ++i)
+        {
+            double expected = signal.getSample(ch, i - latency) * (ch == 0 ? 1.0f : 0.5f);
+            maxError = std::max(maxError, std::abs((double) buffer.getSample(ch, i) - expected));
+        }
+    
+    return maxError;
+}
+
+bool testStreamingSTFT()
+{
+    std::cout << "\nТест 13: StreamingSTFT - точная реконструкция overlap-add...\n";
+    
+    StreamingSTFT<float> stft;
+    stft.prepare(2, 10, 256);
+    
+    // Путь без FFT (processor == nullptr)
+    auto passThroughError = measureSTFTReconstructionError(stft, nullptr);
+    
+    // Полный путь FFT -> IFFT с нетронутым спектром
+    stft.reset();
+    IdentityFrameProcessor identity;
+    auto fftError = measureSTFTReconstructionError(stft, &identity);
+    bool framesOk = identity.numFrames == 2 * (16384 / 256);
+    
+    StreamingSTFT<double> stftDouble;
+    stftDouble.prepare(2, 10, 128);
+    auto doubleError = measureSTFTReconstructionError(stftDouble, nullptr);
+    
+    bool ok = passThroughError < 1.0e-5 && fftError < 1.0e-4 && doubleError < 1.0e-9 && framesOk;
+    
+    if (ok)
+        std::cout << "  ✅ Вход восстановлен с задержкой " << stft.getLatencySamples()
+                  << " (ошибка: без FFT " << passThroughError << ", с FFT " << fftError << ")\n";
+    else
+        std::cout << "  ❌ Ошибка реконструкции: без FFT " << passThroughError << ", с FFT " << fftError
+                  << ", double " << doubleError << ", кадров " << identity.numFrames << "\n";
+    
+    return ok;
+}
+
+// Тест 14: Таблицы перемаппирования бинов совпадают с прямым расчётом
+bool testBinRemapTables()
+{
+    std::cout << "\nТест 14: Таблицы перемаппирования бинов (формант-шифт)...\n";
+    
+    const int numBins = 513;
+    BinRemapTables tables;
+    tables.prepare(numBins, 3.15f, 0.125f);
+    
+    // Гладкий "спектр" + два нуля сверху, как у SpectralEngine
+    std::vector<float> source((size_t) tables.getSourceSize(), 0.0f);
+    for (int bin = 0; bin < numBins; ++bin)
+        source[(size_t) bin] = 1.0f + std::sin(0.05f * bin) * 0.5f + 0.001f * bin;
+    
+    // Прямой расчёт для сдвига в полутонах (как было в кадре до таблиц)
+    auto direct = [&](double semitones, int bin)
+    {
+        double sourceBin = bin / std::pow(2.0, semitones / 12.0);
+        int low = (int) sourceBin;
+        if (low >= numBins) return 0.0;
+        double fraction = sourceBin - low;
+        return source[(size_t) low] + (source[(size_t) low + 1] - source[(size_t) low]) * fraction;
+    };
+    
+    std::vector<float> dest((size_t) numBins), scratch((size_t) numBins);
+    double gridError = 0.0, blendError = 0.0;
+    
+    // Точки сетки: таблица = прямой расчёт
+    for (double semitones : { -3.125, -1.0, 0.0, 0.5, 3.125 })
+    {
+        tables.remap(source.data(), (float) semitones, dest.data(), scratch.data());
+        for (int bin = 0; bin < numBins; ++bin)
+            gridError = std::max(gridError, std::abs(dest[(size_t) bin] - direct(semitones, bin)));
+    }
+    
+    // Между точками: смесь двух соседних таблиц
+    tables.remap(source.data(), 1.0f + 0.125f * 0.25f, dest.data(), scratch.data());
+    for (int bin = 0; bin < numBins; ++bin)
+    {
+        double expected = direct(1.0, bin) * 0.75 + direct(1.125, bin) * 0.25;
+        blendError = std::max(blendError, std::abs(dest[(size_t) bin] - expected));
+    }
+    
+    // Нулевой сдвиг - тождество
+    tables.remap(source.data(), 0.0f, dest.data(), scratch.data());
+    bool identity = std::equal(dest.begin(), dest.end(), source.begin());
+    
+    // Ядро, выбранное по CPU, и переносимое (пары на стеке) - одно и то же, длина не кратна блокам
+    std::vector<int> indices((size_t) numBins);
+    std::vector<float> fractions((size_t) numBins), pairs((size_t) numBins);
+    for (int bin = 0; bin < numBins; ++bin)
+    {
+        indices[(size_t) bin] = (bin * 7) % numBins;
+        fractions[(size_t) bin] = (float) ((bin * 13) % 100) / 100.0f;
+    }
+    BinRemapTables::gatherLerp(source.data(), indices.data(), fractions.data(), dest.data(), numBins);
+    BinRemapTables::gatherLerpPairs(source.data(), indices.data(), fractions.data(), pairs.data(), numBins);
+    double kernelError = 0.0;
+    for (int bin = 0; bin < numBins; ++bin)
+        kernelError = std::max(kernelError, (double) std::abs(dest[(size_t) bin] - pairs[(size_t) bin]));
+    
+    bool ok = tables.getNumTables() == 53 && gridError < 1.0e-5 && blendError < 1.0e-5 && identity
+              && kernelError < 1.0e-6;
+    
+    if (ok)
+        std::cout << "  ✅ " << tables.getNumTables() << " таблиц, ошибка: сетка " << gridError
+                  << ", между точками " << blendError << ", ядра " << kernelError << "\n";
+    else
+        std::cout << "  ❌ Таблицы расходятся (таблиц " << tables.getNumTables() << ", сетка " << gridError
+                  << ", между точками " << blendError << ", тождество " << identity
+                  << ", ядра " << kernelError << ")\n";
+    
+    return ok;
+}
+
+// Тест 15: Упакованное стерео FFT совпадает с раздельным по каналам
+struct TiltFrameProcessor : StreamingSTFT<float>::FrameProcessor
+{
+    void processFrame (int channel, StreamingSTFT<float>::Complex* bins, int numBins) noexcept override
+    {
+        // Разная обработка каналов: перепутанные L/R сразу видны
+        for (int bin = 0; bin < numBins; ++bin)
+            bins[bin] *= 1.0f + 0.5f * std::sin(0.1f * bin + (float) channel);
+    }
+};
+
+bool testStereoPackedFFT()
+{
+    std::cout << "\nТест 15: Стерео в одном комплексном FFT совпадает с раздельным...\n";
+    
+    const int numSamples = 8192;
+    juce::AudioBuffer<float> perChannel(2, numSamples);
+    for (int i = 0; i < numSamples; ++i)
+    {
+        perChannel.setSample(0, i, 0.5f * std::sin(0.031f * i) + 0.2f * std::sin(0.4f * i));
+        perChannel.setSample(1, i, 0.4f * std::sin(0.017f * i + 1.0f) + 0.1f);  // с постоянной составляющей
+    }
+    auto packed = perChannel;
+    
+    StreamingSTFT<float> separate, stereo;
+    separate.prepare(2, 10, 256);
+    stereo.prepare(2, 10, 256);
+    stereo.setStereoPacking(true);
+    
+    TiltFrameProcessor tilt;
+    for (int start = 0; start < numSamples; start += 300)
+    {
+        auto size = std::min(300, numSamples - start);
+        juce::AudioBuffer<float> a(perChannel.getArrayOfWritePointers(), 2, start, size);
+        juce::AudioBuffer<float> b(packed.getArrayOfWritePointers(), 2, start, size);
+        separate.process(a, &tilt);
+        stereo.process(b, &tilt);
+    }
+    
+    float maxDiff = 0.0f;
+    for (int ch = 0; ch < 2; ++ch)
+        for (int i = 0; i < numSamples; ++i)
+            maxDiff = std::max(maxDiff, std::abs(perChannel.getSample(ch, i) - packed.getSample(ch, i)));
+    
+    bool ok = calculateRMS(packed) > 0.1f && maxDiff < 1.0e-5f;
+    
+    if (ok)
+        std::cout << "  ✅ Упакованное стерео совпадает (макс. разница: " << maxDiff << ")\n";
+    else
+        std::cout << "  ❌ Упакованное стерео расходится (макс. разница: " << maxDiff << ")\n";
+    
+    return ok;
+}
+
+// Тест 16: Тиры задержки SpectralEngine - отчёт о задержке совпадает с реальной
+bool testLatencyTiers()
+{
+    std::cout << "\nТест 16: Тиры задержки SpectralEngine (tracking / balanced / mixdown)...\n";
+    
+    const int expectedLatency[] = { 256, 1024, 4096 };
+    const int numSamples = 16384;
+    auto spec = createTestSpec();
+    auto signal = createTestSignal(numSamples, spec.sampleRate, 440.0f);
+    
+    bool ok = true;
+    for (int tier = 0; tier < SpectralEngine<float>::NUM_LATENCY_TIERS; ++tier)
+    {
+        SpectralEngine<float> engine;
+        engine.setLatencyTier(tier);
+        engine.prepare(spec);
+        
+        // Нейтральные параметры: ни EQ, ни формант-шифта - выход = вход с задержкой
+        engine.setDepth(0.0f);
+        engine.setClarity(0.0f);
+        engine.setFlow(0.0f);
+        
+        auto output = signal;
+        for (int start = 0; start < numSamples; start += (int) spec.maximumBlockSize)
+        {
+            auto size = std::min((int) spec.maximumBlockSize, numSamples - start);
+            juce::AudioBuffer<float> block(output.getArrayOfWritePointers(), output.getNumChannels(), start, size);
+            engine.process(block);
+        }
+        
+        const int latency = engine.getLatencySamples();
+        float maxError = 0.0f;
+        for (int ch = 0; ch < output.getNumChannels(); ++ch)
+            for (int i = 2 * latency; i < numSamples; ++i)
+                maxError = std::max(maxError, std::abs(output.getSample(ch, i) - signal.getSample(ch, i - latency)));
+        
+        bool tierOk = latency == expectedLatency[tier] && maxError < 1.0e-4f;
+        std::cout << "  " << (tierOk ? "✅" : "❌") << " Тир " << tier << ": задержка " << latency
+                  << " семплов (ошибка выравнивания: " << maxError << ")\n";
+        ok = ok && tierOk;
+    }
+    
+    return ok;
+}
+
+// Тест 17: Таблица коэффициентов EQ совпадает с прямым расчётом между точками сетки
+bool testBiquadCoefficientTable()
+{
+    std::cout << "\nТест 17: Таблица коэффициентов биквада (автоматизация EQ)...\n";
+    
+    const double sampleRate = 48000.0;
+    auto design = [sampleRate] (float clarity)
+    {
+        auto gain = juce::Decibels::decibelsToGain (clarity * 14.0f);
+        return juce::dsp::IIR::ArrayCoefficients<double>::makePeakFilter (sampleRate, 1900.0 * (1.0 + clarity * 0.7), 1.2, gain);
+    };
+    
+    BiquadCoefficientTable<double> table;
+    table.prepare(-0.5f, 0.5f, 257, design);
+    
+    // Значения между точками сетки и на краях (с выходом за диапазон)
+    double maxError = 0.0;
+    for (float clarity = -0.55f; clarity <= 0.55f; clarity += 0.00173f)
+    {
+        auto expected = design(juce::jlimit(-0.5f, 0.5f, clarity));
+        auto actual = table.lookup(clarity);
+        
+        for (size_t i = 0; i < 6; ++i)
+            maxError = std::max(maxError, std::abs(actual[i] - expected[i] / expected[3]));
+    }
+    
+    bool ok = table.getNumPoints() == 257 && maxError < 1.0e-4;
+    
+    if (ok)
+        std::cout << "  ✅ Интерполяция по сетке (макс. ошибка коэффициента: " << maxError << ")\n";
+    else
+        std::cout << "  ❌ Таблица расходится с прямым расчётом (макс. ошибка: " << maxError << ")\n";
+    
+    return ok;
+}
+
+// Тест 18: Слитный каскад биквадов совпадает с цепочкой IIR::Filter и быстрее её
+template <typename Chain, typename Cascade>
+double benchmarkEqNsPerSample (Chain& chain, Cascade& cascade, juce::AudioBuffer<float>& buffer, int blockSize, bool useCascade)
+{
+    const int numSamples = buffer.getNumSamples();
+    auto begin = std::chrono::steady_clock::now();
+    
+    for (int start = 0; start + blockSize <= numSamples; start += blockSize)
+    {
+        juce::dsp::AudioBlock<float> block(buffer.getArrayOfWritePointers(), 2, (size_t) start, (size_t) blockSize);
+        
+        if (useCascade)
+        {
+            cascade.process(block);
+        }
+        else
+        {
+            juce::dsp::ProcessContextReplacing<float> context(block);
+            chain.process(context);
+        }
+    }
+    
+    auto elapsed = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - begin).count();
+    return elapsed / (numSamples / blockSize * blockSize);
+}
+
+bool testBiquadCascade()
+{
+    std::cout << "\nТест 18: Слитный каскад биквадов (EQ SpectralEngine) vs цепочка IIR::Filter...\n";
+    
+    using Coeffs = juce::dsp::IIR::Coefficients<float>;
+    using ArrayCoeffs = juce::dsp::IIR::ArrayCoefficients<float>;
+    using Dup = juce::dsp::ProcessorDuplicator<juce::dsp::IIR::Filter<float>, Coeffs>;
+    
+    const double sampleRate = 48000.0;
+    std::array<float, 6> sections[] = {
+        ArrayCoeffs::makeHighShelf(sampleRate, 8000.0f, 0.7f, 2.0f),
+        ArrayCoeffs::makePeakFilter(sampleRate, 400.0f, 1.5f, 1.3f),
+        ArrayCoeffs::makePeakFilter(sampleRate, 600.0f, 1.2f, 1.2f),
+        ArrayCoeffs::makePeakFilter(sampleRate, 2200.0f, 1.2f, 0.7f),
+        ArrayCoeffs::makePeakFilter(sampleRate, 3500.0f, 1.0f, 1.5f)
+    };
+    
+    // a0 = 1 заранее: обе реализации получают одинаковые коэффициенты без округления нормировки
+    for (auto& section : sections)
+    {
+        const auto a0 = section[3];
+        for (auto& c : section)
+            c /= a0;
+    }
+    
+    juce::dsp::ProcessorChain<Dup, Dup, Dup, Dup, Dup> chain;
+    BiquadCascade<float, 5> cascade;
+    
+    juce::dsp::ProcessSpec spec { sampleRate, 4096, 2 };
+    chain.prepare(spec);
+    cascade.prepare(2);
+    
+    *chain.get<0>().state = sections[0];
+    *chain.get<1>().state = sections[1];
+    *chain.get<2>().state = sections[2];
+    *chain.get<3>().state = sections[3];
+    *chain.get<4>().state = sections[4];
+    for (int s = 0; s < 5; ++s)
+        cascade.setCoefficients(s, sections[s]);
+    
+    // Совпадение: одинаковые блоки разного размера, стерео с разными каналами
+    auto signal = createTestSignal(16384, sampleRate, 440.0f);
+    for (int i = 0; i < signal.getNumSamples(); ++i)
+        signal.setSample(1, i, signal.getSample(1, i) * 0.5f + 0.1f * std::sin(0.7f * i));
+    
+    auto viaChain = signal;
+    auto viaCascade = signal;
+    const int blockSizes[] = { 1, 64, 333, 512 };
+    for (int start = 0, index = 0; start < signal.getNumSamples(); ++index)
+    {
+        auto size = std::min(blockSizes[index % 4], signal.getNumSamples() - start);
+        juce::dsp::AudioBlock<float> a(viaChain.getArrayOfWritePointers(), 2, (size_t) start, (size_t) size);
+        juce::dsp::AudioBlock<float> b(viaCascade.getArrayOfWritePointers(), 2, (size_t) start, (size_t) size);
+        juce::dsp::ProcessContextReplacing<float> context(a);
+        chain.process(context);
+        cascade.process(b);
+        start += size;
+    }
+    
+    float maxDiff = 0.0f;
+    for (int ch = 0; ch < 2; ++ch)
+        for (int i = 0; i < signal.getNumSamples(); ++i)
+            maxDiff = std::max(maxDiff, std::abs(viaChain.getSample(ch, i) - viaCascade.getSample(ch, i)));
+    
+    bool ok = maxDiff < 1.0e-5f;
+    
+    if (ok)
+        std::cout << "  ✅ Каскад совпадает с цепочкой (макс. разница: " << maxDiff << ")\n";
+    else
+        std::cout << "  ❌ Каскад расходится с цепочкой (макс. разница: " << maxDiff << ")\n";
+    
+    // Бенчмарк по размерам блока (информативно, на результат теста не влияет)
+    auto benchBuffer = createTestSignal(1 << 17, sampleRate, 440.0f);
+    for (int blockSize : { 16, 64, 256, 1024, 4096 })
+    {
+        auto chainNs = benchmarkEqNsPerSample(chain, cascade, benchBuffer, blockSize, false);
+        auto cascadeNs = benchmarkEqNsPerSample(chain, cascade, benchBuffer, blockSize, true);
+        std::cout << "     блок " << blockSize << ": цепочка " << chainNs << " ns/семпл, каскад "
+                  << cascadeNs << " ns/семпл (x" << chainNs / cascadeNs << ")\n";
+    }
+    
+    return ok;
+}
+
+// Тест 19: STFT на фоновом потоке - задержка постоянна, опоздания уходят в выровненный dry
+struct SilenceFrameProcessor : StreamingSTFT<float>::FrameProcessor
+{
+    void processFrame (int, StreamingSTFT<float>::Complex* bins, int numBins) noexcept override
+    {
+        for (int bin = 0; bin < numBins; ++bin)
+            bins[bin] = {};
+    }
+};
+
+bool testBackgroundSTFT()
+{
+    std::cout << "\nТест 19: STFT в фоновом потоке (фиксированная задержка, dry при опоздании)...\n";
+    
+    const int numSamples = 32768;
+    const int blockSize = 256;
+    auto signal = createTestSignal(numSamples, 44100.0, 440.0f);
+    
+    StreamingSTFT<float> stft;
+    stft.prepare(2, 10, 256);
+    BackgroundSTFT<float> background;
+    background.prepare(stft, 2, blockSize, 44100.0);
+    
+    const int latency = background.getLatencySamples();
+    bool latencyOk = latency == stft.getLatencySamples() + background.getBudgetSamples()
+                  && background.getBudgetSamples() >= 2 * blockSize;
+    
+    // Реальное время, но блоки идут без пауз: worker опаздывает, dry подменяет wet.
+    // Без спектральной обработки wet и dry совпадают - выход обязан быть входом с задержкой
+    // и посреди опозданий, и после reset() посередине
+    auto output = signal;
+    const int resetAt = numSamples / 2;
+    for (int start = 0; start < numSamples; start += blockSize)
+    {
+        if (start == resetAt)
+            background.reset();
+        
+        juce::AudioBuffer<float> block(output.getArrayOfWritePointers(), 2, start, blockSize);
+        background.process(block, nullptr);
+    }
+    
+    float alignmentError = 0.0f;
+    for (int ch = 0; ch < 2; ++ch)
+    {
+        for (int i = 2 * latency; i < resetAt; ++i)
+            alignmentError = std::max(alignmentError, std::abs(output.getSample(ch, i) - signal.getSample(ch, i - latency)));
+        for (int i = resetAt + 2 * latency; i < numSamples; ++i)
+            alignmentError = std::max(alignmentError, std::abs(output.getSample(ch, i) - signal.getSample(ch, i - latency)));
+    }
+    
+    // Offline: срока нет, аудио-сторона ждёт worker - выход полностью wet (здесь тишина)
+    background.prepare(stft, 2, blockSize, 44100.0);
+    background.setNonRealtime(true);
+    background.reset();  // как prepareToPlay хоста: сброс ждёт worker, а не уходит в dry
+    SilenceFrameProcessor silence;
+    auto offline = signal;
+    for (int start = 0; start < numSamples; start += blockSize)
+    {
+        juce::AudioBuffer<float> block(offline.getArrayOfWritePointers(), 2, start, blockSize);
+        background.process(block, &silence);
+    }
+    
+    float wetLeak = 0.0f;
+    for (int ch = 0; ch < 2; ++ch)
+        for (int i = background.getBudgetSamples(); i < numSamples; ++i)
+            wetLeak = std::max(wetLeak, std::abs(offline.getSample(ch, i)));
+    
+    bool offlineOk = background.getNumMissedSamples() == 0 && wetLeak < 1.0e-6f;
+    background.release();
+    
+    bool ok = latencyOk && alignmentError < 1.0e-5f && offlineOk;
+    
+    if (ok)
+        std::cout << "  ✅ Задержка " << latency << " (STFT " << stft.getLatencySamples() << " + бюджет "
+                  << "worker-а), выравнивание при опозданиях: " << alignmentError << "\n";
+    else
+        std::cout << "  ❌ Задержка " << latency << ", ошибка выравнивания " << alignmentError
+                  << ", offline: пропущено " << background.getNumMissedSamples() << ", утечка dry " << wetLeak << "\n";
+    
+    return ok;
+}
+
+// Тест 20: Формант-шифт на нижней полосе с пониженной частотой (96 кГц)
+template <typename Signal>
+juce::AudioBuffer<float> renderSpectral(SpectralEngine<float>& engine, Signal signal, int numSamples, int blockSize)
+{
+    juce::AudioBuffer<float> buffer(2, numSamples);
+    for (int ch = 0; ch < 2; ++ch)
+        for (int i = 0; i < numSamples; ++i)
+            buffer.setSample(ch, i, signal(i));
+    
+    for (int start = 0; start < numSamples; start += blockSize)
+    {
+        juce::AudioBuffer<float> block(buffer.getArrayOfWritePointers(), 2, start, std::min(blockSize, numSamples - start));
+        engine.process(block);
+    }
+    
+    return buffer;
+}
+
+bool testSplitBandFormant()
+{
+    std::cout << "\nТест 20: Формант-шифт на пониженной частоте (полосы, 96 кГц)...\n";
+    
+    const double sampleRate = 96000.0;
+    const int numSamples = 65536;
+    const int blockSize = 480;
+    juce::dsp::ProcessSpec spec { sampleRate, (juce::uint32) blockSize, 2 };
+    const auto twoPi = juce::MathConstants<float>::twoPi;
+    
+    // Гармоники 220 Гц до 3 кГц (зона формант) плюс тон 15 кГц (верх, мимо нижней полосы)
+    auto voice = [=] (int i)
+    {
+        float sample = 0.0f;
+        for (int harmonic = 1; harmonic * 220 <= 3000; ++harmonic)
+            sample += 0.3f / (float) harmonic * std::sin(twoPi * 220.0f * (float) harmonic * (float) i / (float) sampleRate);
+        return sample;
+    };
+    auto air = [=] (int i) { return 0.3f * std::sin(twoPi * 15000.0f * (float) i / (float) sampleRate); };
+    
+    auto makeEngine = [&] (SpectralEngine<float>& engine, bool split, float clarity)
+    {
+        engine.setSplitBandProcessing(split);
+        engine.prepare(spec);
+        engine.setClarity(clarity);
+        engine.setDepth(0.5f);  // low-mid EQ выключен
+        engine.setFlow(0.0f);
+    };
+    
+    // Нейтральные параметры: выход = вход с заявленной задержкой
+    SpectralEngine<float> neutral;
+    makeEngine(neutral, true, 0.0f);
+    const int latency = neutral.getLatencySamples();
+    auto neutralOut = renderSpectral(neutral, [&] (int i) { return voice(i) + air(i); }, numSamples, blockSize);
+    
+    float neutralError = 0.0f;
+    for (int i = 2 * latency; i < numSamples; ++i)
+        neutralError = std::max(neutralError, std::abs(neutralOut.getSample(0, i) - voice(i - latency) - air(i - latency)));
+    
+    // Форманты вверх на 3 полутона: уровни гармоник те же, что в полном диапазоне (то же
+    // разрешение по частоте и времени, другой только FFT). Форма волны не сравнивается -
+    // сетка кадров сдвинута на задержку FIR, а шифт по амплитудам от неё зависит
+    SpectralEngine<float> split, full;
+    makeEngine(split, true, 0.5f);
+    makeEngine(full, false, 0.5f);
+    auto splitVoice = renderSpectral(split, voice, numSamples, blockSize);
+    auto fullVoice = renderSpectral(full, voice, numSamples, blockSize);
+    
+    auto harmonicLevelDb = [&] (const juce::AudioBuffer<float>& buffer, double frequency)
+    {
+        double re = 0.0, im = 0.0;
+        for (int i = numSamples / 4; i < numSamples; ++i)
+        {
+            re += buffer.getSample(0, i) * std::cos(2.0 * juce::MathConstants<double>::pi * frequency * i / sampleRate);
+            im += buffer.getSample(0, i) * std::sin(2.0 * juce::MathConstants<double>::pi * frequency * i / sampleRate);
+        }
+        return juce::Decibels::gainToDecibels(std::hypot(re, im) * 2.0 / (0.75 * numSamples), -120.0);
+    };
+    
+    double levelDifferenceDb = 0.0, shiftEffectDb = 0.0;
+    for (int harmonic = 1; harmonic * 220 <= 3000; ++harmonic)
+    {
+        auto splitLevel = harmonicLevelDb(splitVoice, 220.0 * harmonic);
+        levelDifferenceDb = std::max(levelDifferenceDb, std::abs(splitLevel - harmonicLevelDb(fullVoice, 220.0 * harmonic)));
+        shiftEffectDb = std::max(shiftEffectDb, std::abs(splitLevel - harmonicLevelDb(neutralOut, 220.0 * harmonic)));
+    }
+    
+    bool ok = neutral.getSplitBandFactor() == 4 && full.getSplitBandFactor() == 1
+           && neutralError < 1.0e-4f && levelDifferenceDb < 0.5 && shiftEffectDb > 1.0;
+    
+    std::cout << "  " << (ok ? "✅" : "❌") << " Понижение x" << neutral.getSplitBandFactor() << ", задержка " << latency
+              << " (полный диапазон " << full.getLatencySamples() << "), ошибка без обработки " << neutralError
+              << ", уровни гармоник: отличие от полного диапазона " << levelDifferenceDb
+              << " дБ, эффект Clarity " << shiftEffectDb << " дБ\n";
+    
+    // Бенчмарк (информативно): формант-шифт всегда включён
+    for (bool splitBand : { false, true })
+    {
+        SpectralEngine<float> engine;
+        makeEngine(engine, splitBand, 0.5f);
+        auto start = std::chrono::steady_clock::now();
+        renderSpectral(engine, voice, numSamples, blockSize);
+        auto ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / numSamples;
+        std::cout << "     " << (splitBand ? "полосы:" : "полный диапазон:") << " " << ns << " ns/семпл\n";
+    }
+    
+    return ok;
+}
+
+// Тест 21: Формант-шифт огибающей (кепстр) - гармоники на месте, хватает FFT 256
+bool testEnvelopeFormantShift()
+{
+    std::cout << "\nТест 21: Формант-шифт спектральной огибающей (кепстр)...\n";
+    
+    auto spec = createTestSpec();
+    const int numSamples = 65536;
+    const auto sampleRate = spec.sampleRate;
+    const auto twoPi = juce::MathConstants<double>::twoPi;
+    
+    // Гармоники 220 Гц с формантой около 1 кГц
+    auto voice = [=] (int i)
+    {
+        double sample = 0.0;
+        for (int harmonic = 1; harmonic * 220 <= 8000; ++harmonic)
+        {
+            auto frequency = 220.0 * harmonic;
+            auto amplitude = 0.05 + std::exp(-std::pow((frequency - 1000.0) / 300.0, 2.0));
+            sample += 0.1 * amplitude * std::sin(twoPi * frequency * i / sampleRate);
+        }
+        return (float) sample;
+    };
+    
+    struct Analysis { double harmonicFraction, centroid, nsPerSample; };
+    
+    // Доля энергии на частотах гармоник и центроид огибающей (амплитуды гармоник до 2.5 кГц)
+    auto analyse = [&] (int tier, SpectralEngine<float>::FormantMode mode, float clarity)
+    {
+        SpectralEngine<float> engine;
+        engine.setLatencyTier(tier);
+        engine.prepare(spec);
+        engine.setFormantMode(mode);
+        engine.setClarity(clarity);
+        engine.setDepth(0.5f);
+        engine.setFlow(0.0f);
+        
+        juce::AudioBuffer<float> buffer(2, numSamples);
+        for (int ch = 0; ch < 2; ++ch)
+            for (int i = 0; i < numSamples; ++i)
+                buffer.setSample(ch, i, voice(i));
+        
+        auto start = std::chrono::steady_clock::now();
+        for (int offset = 0; offset < numSamples; offset += (int) spec.maximumBlockSize)
+        {
+            juce::AudioBuffer<float> block(buffer.getArrayOfWritePointers(), 2, offset,
+                                           std::min((int) spec.maximumBlockSize, numSamples - offset));
+            engine.process(block);
+        }
+        auto ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / numSamples;
+        
+        const int first = numSamples / 4;
+        const double length = numSamples - first;
+        double total = 0.0, harmonicEnergy = 0.0, weightedFrequency = 0.0, amplitudeSum = 0.0;
+        
+        for (int i = first; i < numSamples; ++i)
+            total += std::pow(buffer.getSample(0, i), 2.0) * 2.0 / length;
+        
+        for (int harmonic = 1; harmonic * 220 <= 8000; ++harmonic)
+        {
+            double re = 0.0, im = 0.0;
+            for (int i = first; i < numSamples; ++i)
+            {
+                re += buffer.getSample(0, i) * std::cos(twoPi * 220.0 * harmonic * i / sampleRate);
+                im += buffer.getSample(0, i) * std::sin(twoPi * 220.0 * harmonic * i / sampleRate);
+            }
+            auto amplitude = 2.0 * std::hypot(re, im) / length;
+            harmonicEnergy += amplitude * amplitude;
+            
+            if (harmonic * 220 < 2500)
+            {
+                weightedFrequency += 220.0 * harmonic * amplitude;
+                amplitudeSum += amplitude;
+            }
+        }
+        
+        return Analysis { harmonicEnergy / total, weightedFrequency / amplitudeSum, ns };
+    };
+    
+    using Mode = SpectralEngine<float>::FormantMode;
+    const auto neutral = analyse(0, Mode::spectralEnvelope, 0.0f);
+    const auto envelopeSmall = analyse(0, Mode::spectralEnvelope, 0.5f);
+    const auto envelopeLarge = analyse(2, Mode::spectralEnvelope, 0.5f);
+    const auto binsLarge = analyse(2, Mode::binRemap, 0.5f);
+    
+    // Огибающая: гармоники остаются гармониками (перенос бинов на FFT 4096 их двигает),
+    // на FFT 256 форманта сдвигается так же, как на FFT 4096
+    bool harmonicsKept = envelopeLarge.harmonicFraction > 0.99 && envelopeSmall.harmonicFraction > 0.98
+                      && binsLarge.harmonicFraction < envelopeLarge.harmonicFraction;
+    bool formantMoved = envelopeSmall.centroid > neutral.centroid * 1.05
+                     && std::abs(envelopeSmall.centroid / envelopeLarge.centroid - 1.0) < 0.03;
+    bool ok = harmonicsKept && formantMoved;
+    
+    std::cout << "  " << (ok ? "✅" : "❌") << " Доля гармоник: огибающая FFT 256 " << envelopeSmall.harmonicFraction
+              << ", FFT 4096 " << envelopeLarge.harmonicFraction << ", перенос бинов FFT 4096 " << binsLarge.harmonicFraction << "\n";
+    std::cout << "     Центроид форманты: " << neutral.centroid << " Гц -> " << envelopeSmall.centroid
+              << " Гц (FFT 256), " << envelopeLarge.centroid << " Гц (FFT 4096)\n";
+    std::cout << "     Огибающая FFT 256: " << envelopeSmall.nsPerSample << " ns/семпл, перенос бинов FFT 4096: "
+              << binsLarge.nsPerSample << " ns/семпл\n";
+    
+    return ok;
+}
+
+// Тест 22: Общий спектральный анализ - амплитуда, центроид, flatness, полосы
+bool testSpectralAnalyzer()
+{
+    std::cout << "\nТест 22: Общий спектральный анализ входа...\n";
+    
+    auto spec = createTestSpec();
+    const int numSamples = 8192;
+    const int blockSize = 100;  // не кратно hop: кадры должны идти ровно раз в HOP_SIZE
+    const auto twoPi = juce::MathConstants<double>::twoPi;
+    
+    SpectralAnalyzer<float> analyzer;
+    analyzer.prepare(spec);
+    const auto& analysis = analyzer.getAnalysis();
+    
+    auto feed = [&] (auto generator)
+    {
+        juce::AudioBuffer<float> buffer(2, numSamples);
+        for (int i = 0; i < numSamples; ++i)
+            for (int ch = 0; ch < 2; ++ch)
+                buffer.setSample(ch, i, generator(i));
+        
+        juce::AudioBuffer<float> copy;
+        copy.makeCopyOf(buffer);
+        
+        for (int offset = 0; offset < numSamples; offset += blockSize)
+        {
+            juce::AudioBuffer<float> block(buffer.getArrayOfWritePointers(), 2, offset, std::min(blockSize, numSamples - offset));
+            analyzer.process(block);
+        }
+        
+        bool unchanged = true;
+        for (int ch = 0; ch < 2; ++ch)
+            for (int i = 0; i < numSamples; ++i)
+                unchanged = unchanged && buffer.getSample(ch, i) == copy.getSample(ch, i);
+        return unchanged;
+    };
+    
+    // Синус точно в бине 35 (~1507 Гц, вместе с соседними бинами Hann внутри полосы 1-2 кГц), амплитуда 0.5
+    const int toneBin = 35;
+    const auto toneHz = analysis.getBinFrequency(toneBin);
+    const auto firstFrame = analysis.frameIndex;
+    bool unchanged = feed([&] (int i) { return (float) (0.5 * std::sin(twoPi * toneHz * i / spec.sampleRate)); });
+    
+    const auto frames = analysis.frameIndex - firstFrame;
+    const auto peak = analysis.magnitudes[(size_t) toneBin];
+    const auto toneCentroid = analysis.centroidHz;
+    const auto toneFlatness = analysis.flatness;
+    
+    float totalEnergy = 0.0f;
+    for (auto energy : analysis.bandEnergies)
+        totalEnergy += energy;
+    const auto toneBandShare = analysis.bandEnergies[4] / totalEnergy;  // 1-2 кГц
+    
+    bool toneOk = unchanged && frames == (juce::uint32) (numSamples / SpectralAnalysis::HOP_SIZE)
+               && std::abs(peak - 0.5f) < 0.005f
+               && std::abs(toneCentroid - toneHz) < 1.0f
+               && toneFlatness < 0.01f
+               && toneBandShare > 0.99f;
+    
+    // Белый шум: спектр плоский
+    juce::Random random(42);
+    feed([&] (int) { return random.nextFloat() - 0.5f; });
+    const auto noiseFlatness = analysis.flatness;
+    const auto noiseCentroid = analysis.centroidHz;
+    bool noiseOk = noiseFlatness > 0.4f && noiseCentroid > 0.35f * (float) spec.sampleRate / 2.0f;
+    
+    // Тишина: без NaN, центроид и flatness - 0
+    feed([] (int) { return 0.0f; });
+    bool silenceOk = analysis.centroidHz == 0.0f && analysis.flatness == 0.0f && analysis.magnitudes[(size_t) toneBin] == 0.0f;
+    
+    bool ok = toneOk && noiseOk && silenceOk;
+    
+    std::cout << "  " << (ok ? "✅" : "❌") << " Тон " << toneHz << " Гц: пик " << peak << ", центроид " << toneCentroid
+              << " Гц, flatness " << toneFlatness << ", доля полосы 1-2 кГц " << toneBandShare << ", кадров " << frames << "\n";
+    std::cout << "     Шум: flatness " << noiseFlatness << ", центроид " << noiseCentroid << " Гц; тишина: "
+              << (silenceOk ? "OK" : "FAIL") << (unchanged ? "" : "; буфер изменён!") << "\n";
+    
+    return ok;
+}
+
+// Тест 23: FDN реверб - заданное время спада (до 20 сек), стерео, сравнение с Freeverb
+bool testFdnReverb()
+{
+    std::cout << "\nТест 23: FDN реверб (16 линий, Hadamard x Householder)...\n";
+    
+    auto spec = createTestSpec();
+    const auto sampleRate = spec.sampleRate;
+    
+    // Спад энергии между двумя окнами после импульса, дБ
+    auto measureDecay = [&] (float decaySeconds, double firstSec, double secondSec, double& correlation)
+    {
+        FdnReverb<float> reverb;
+        reverb.prepare(spec);
+        FdnReverb<float>::Parameters params;
+        params.decaySeconds = decaySeconds;
+        params.damping = 0.0f;      // без ФНЧ спад одинаков на всех частотах
+        params.wetLevel = 1.0f / 3.0f;
+        params.dryLevel = 0.0f;
+        params.width = 1.0f;
+        reverb.setParameters(params);
+        
+        const auto window = (int) (0.25 * sampleRate);
+        const auto numSamples = (int) (secondSec * sampleRate) + window;
+        std::vector<float> left((size_t) numSamples, 0.0f), right((size_t) numSamples, 0.0f);
+        left[0] = right[0] = 1.0f;  // моно импульс
+        
+        for (int offset = 0; offset < numSamples; offset += (int) spec.maximumBlockSize)
+            reverb.processStereo(left.data() + offset, right.data() + offset,
+                                 std::min((int) spec.maximumBlockSize, numSamples - offset));
+        
+        auto energy = [&] (double startSec)
+        {
+            double sum = 0.0;
+            for (int i = (int) (startSec * sampleRate); i < (int) (startSec * sampleRate) + window; ++i)
+                sum += (double) left[(size_t) i] * left[(size_t) i];
+            return sum;
+        };
+        
+        double lr = 0.0, ll = 0.0, rr = 0.0;
+        for (int i = (int) (firstSec * sampleRate); i < numSamples; ++i)
+        {
+            lr += (double) left[(size_t) i] * right[(size_t) i];
+            ll += (double) left[(size_t) i] * left[(size_t) i];
+            rr += (double) right[(size_t) i] * right[(size_t) i];
+        }
+        correlation = lr / std::sqrt(ll * rr + 1.0e-30);
+        
+        return 10.0 * std::log10(energy(secondSec) / energy(firstSec));
+    };
+    
+    // -60 дБ за decaySeconds: 20 сек - 6 дБ за 2 сек, 2 сек - 15 дБ за 0.5 сек
+    double correlationLong = 0.0, correlationShort = 0.0;
+    const auto decayLong = measureDecay(20.0f, 1.0, 3.0, correlationLong);
+    const auto decayShort = measureDecay(2.0f, 0.5, 1.0, correlationShort);
+    
+    bool decayOk = std::abs(decayLong + 6.0) < 1.0 && std::abs(decayShort + 15.0) < 1.5;
+    bool stereoOk = std::abs(correlationLong) < 0.3 && std::abs(correlationShort) < 0.3;
+    bool ok = decayOk && stereoOk;
+    
+    // Freeverb на максимуме roomSize - предел прежнего SpaceEngine
+    FreeverbCore<float> freeverb;
+    freeverb.prepare(spec);
+    FreeverbCore<float>::Parameters freeverbParams;
+    freeverbParams.roomSize = 0.95f;
+    freeverbParams.dryLevel = 0.0f;
+    freeverb.setParameters(freeverbParams);
+    const auto freeverbDecay = freeverb.getDecayTimeSeconds(60.0);
+    
+    std::cout << "  " << (ok ? "✅" : "❌") << " Спад: " << decayLong << " дБ за 2 сек (RT60 20 сек), "
+              << decayShort << " дБ за 0.5 сек (RT60 2 сек); корреляция L/R хвоста "
+              << correlationLong << ", " << correlationShort << "\n";
+    std::cout << "     Freeverb (roomSize 0.95): RT60 " << freeverbDecay << " сек\n";
+    
+    // Бенчмарк при одинаковом времени спада (информативно, не проверяется)
+    FdnReverb<float> fdn;
+    fdn.prepare(spec);
+    FdnReverb<float>::Parameters fdnParams;
+    fdnParams.decaySeconds = (float) freeverbDecay;
+    fdnParams.dryLevel = 0.0f;
+    fdn.setParameters(fdnParams);
+    
+    const int numSamples = 1 << 18;
+    const int blockSize = (int) spec.maximumBlockSize;
+    juce::Random random(7);
+    std::vector<float> left((size_t) numSamples), right((size_t) numSamples);
+    
+    auto bench = [&] (auto& reverb)
+    {
+        for (int i = 0; i < numSamples; ++i)
+            left[(size_t) i] = right[(size_t) i] = random.nextFloat() - 0.5f;
+        
+        auto start = std::chrono::steady_clock::now();
+        for (int offset = 0; offset < numSamples; offset += blockSize)
+            reverb.processStereo(left.data() + offset, right.data() + offset, blockSize);
+        return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / numSamples;
+    };
+    
+    const auto freeverbNs = bench(freeverb);
+    const auto fdnNs = bench(fdn);
+    std::cout << "     Стерео, RT60 " << freeverbDecay << " сек: Freeverb " << freeverbNs << " ns/семпл, FDN "
+              << fdnNs << " ns/семпл\n";
+    
+    return ok;
+}
+
+bool testConvolutionReverb()
+{
+    std::cout << "\nТест 24: Свёртка с неравномерными разбиениями (FIR 64 + 64 / 512 / 4096)...\n";
+    
+    auto spec = createTestSpec();
+    juce::Random random(11);
+    
+    // Стерео IR на все уровни разбиений, вход - блоками разной длины
+    const int irLength = 10000;
+    juce::AudioBuffer<float> ir(2, irLength);
+    for (int ch = 0; ch < 2; ++ch)
+        for (int i = 0; i < irLength; ++i)
+            ir.setSample(ch, i, (random.nextFloat() - 0.5f) * std::exp(-3.0f * (float) i / irLength));
+    
+    const int numSamples = 3 * irLength;
+    std::vector<float> inputL((size_t) numSamples), inputR((size_t) numSamples);
+    for (int i = 0; i < numSamples; ++i)
+    {
+        inputL[(size_t) i] = random.nextFloat() - 0.5f;
+        inputR[(size_t) i] = random.nextFloat() - 0.5f;
+    }
+    
+    PartitionedConvolution<double> convolution(ir);
+    convolution.setNonRealtime(true);  // поздний хвост (worker) без пропусков - сравниваем точно
+    std::vector<double> left(inputL.begin(), inputL.end()), right(inputR.begin(), inputR.end());
+    for (int offset = 0; offset < numSamples;)
+    {
+        const int length = std::min(1 + random.nextInt(700), numSamples - offset);
+        convolution.processStereo(left.data() + offset, right.data() + offset, length);
+        offset += length;
+    }
+    
+    // Прямая свёртка в double - эталон
+    double maxError = 0.0, maxReference = 0.0;
+    for (int n = 0; n < numSamples; n += 7)
+    {
+        double expectedL = 0.0, expectedR = 0.0;
+        for (int k = 0; k < irLength && k <= n; ++k)
+        {
+            expectedL += (double) ir.getSample(0, k) * inputL[(size_t) (n - k)];
+            expectedR += (double) ir.getSample(1, k) * inputR[(size_t) (n - k)];
+        }
+        maxError = std::max({ maxError, std::abs(left[(size_t) n] - expectedL), std::abs(right[(size_t) n] - expectedR) });
+        maxReference = std::max({ maxReference, std::abs(expectedL), std::abs(expectedR) });
+    }
+    
+    // Без задержки: импульс на входе - сама IR с первого же семпла
+    convolution.reset();
+    std::vector<double> impulseL((size_t) irLength, 0.0), impulseR((size_t) irLength, 0.0);
+    impulseL[0] = impulseR[0] = 1.0;
+    convolution.processStereo(impulseL.data(), impulseR.data(), irLength);
+    double impulseError = 0.0;
+    for (int i = 0; i < irLength; ++i)
+        impulseError = std::max(impulseError, std::abs(impulseL[(size_t) i] - ir.getSample(0, i)));
+    
+    bool accurate = maxError < 1.0e-4 * maxReference;
+    bool zeroLatency = impulseError < 1.0e-5;
+    
+    // Замена IR без блокировок: дельта -> задержанная дельта, после кроссфейда выход = задержанный вход
+    ConvolutionReverb<float> reverb;
+    ConvolutionReverb<float>::Parameters params;
+    params.wetLevel = 1.0f / 3.0f;  // wet 1, как у FdnReverb
+    params.width = 1.0f;
+    reverb.setParameters(params);
+    reverb.prepare(spec);
+    
+    const int blockSize = (int) spec.maximumBlockSize;
+    const int delay = 100;
+    juce::AudioBuffer<float> delta(1, delay + 1);
+    delta.clear();
+    delta.setSample(0, 0, 1.0f);
+    reverb.loadImpulseResponse(delta, spec.sampleRate);
+    
+    bool swapOk = reverb.hasImpulseResponse();
+    std::vector<float> blockL((size_t) blockSize), blockR((size_t) blockSize), history;
+    auto runBlock = [&]
+    {
+        for (int i = 0; i < blockSize; ++i)
+        {
+            blockL[(size_t) i] = blockR[(size_t) i] = random.nextFloat() - 0.5f;
+            history.push_back(blockL[(size_t) i]);
+        }
+        reverb.processStereo(blockL.data(), blockR.data(), blockSize);
+    };
+    
+    runBlock();
+    for (int i = 0; i < blockSize; ++i)
+        swapOk = swapOk && std::abs(blockL[(size_t) i] - history[history.size() - (size_t) (blockSize - i)]) < 1.0e-5f;
+    
+    delta.clear();
+    delta.setSample(0, delay, 1.0f);
+    reverb.loadImpulseResponse(delta, spec.sampleRate);
+    for (int b = 0; b < (int) (0.1 * spec.sampleRate) / blockSize + 1; ++b)
+        runBlock();
+    
+    for (int i = 0; i < blockSize; ++i)
+        swapOk = swapOk && std::abs(blockL[(size_t) i] - history[history.size() - (size_t) (blockSize - i + delay)]) < 1.0e-5f;
+    
+    // Отыгравшую свёртку удаляет таймер процессора; следующая замена идёт как обычно
+    reverb.releaseRetired();
+    delta.clear();
+    delta.setSample(0, 0, 1.0f);
+    reverb.loadImpulseResponse(delta, spec.sampleRate);
+    for (int b = 0; b < (int) (0.1 * spec.sampleRate) / blockSize + 1; ++b)
+        runBlock();
+    
+    for (int i = 0; i < blockSize; ++i)
+        swapOk = swapOk && std::abs(blockL[(size_t) i] - history[history.size() - (size_t) (blockSize - i)]) < 1.0e-5f;
+    
+    // release() (набор другой точности): свёртки нет, новая IR только хранится - до prepare()
+    reverb.release();
+    bool releaseOk = ! reverb.hasImpulseResponse();
+    reverb.loadImpulseResponse(delta, spec.sampleRate);
+    releaseOk = releaseOk && ! reverb.hasImpulseResponse();
+    reverb.prepare(spec);
+    releaseOk = releaseOk && reverb.hasImpulseResponse();
+    
+    bool ok = accurate && zeroLatency && swapOk && releaseOk;
+    std::cout << "  " << (ok ? "✅" : "❌") << " Ошибка против прямой свёртки " << maxError / maxReference
+              << " (от пика), импульс -> IR с семпла 0: " << impulseError
+              << ", замена IR: " << (swapOk ? "OK" : "FAIL")
+              << ", release: " << (releaseOk ? "OK" : "FAIL") << "\n";
+    
+    return ok;
+}
+
+bool testLateConvolutionWorker()
+{
+    std::cout << "\nТест 25: Поздний хвост свёртки на worker-е (разбиения 4096 с отступа 8192)...\n";
+    
+    auto spec = createTestSpec();
+    const int blockSize = (int) spec.maximumBlockSize;
+    juce::Random random(23);
+    
+    // Несколько поздних разбиений; offline - worker ждут, результат точный
+    const int irLength = 30000;
+    juce::AudioBuffer<float> ir(2, irLength);
+    for (int ch = 0; ch < 2; ++ch)
+        for (int i = 0; i < irLength; ++i)
+            ir.setSample(ch, i, (random.nextFloat() - 0.5f) * std::exp(-2.0f * (float) i / irLength));
+    
+    const int numSamples = 2 * irLength;
+    std::vector<float> input((size_t) numSamples);
+    for (auto& sample : input)
+        sample = random.nextFloat() - 0.5f;
+    
+    PartitionedConvolution<float> convolution(ir);
+    convolution.setNonRealtime(true);
+    std::vector<float> left(input), right(input);
+    for (int offset = 0; offset < numSamples; offset += blockSize)
+        convolution.processStereo(left.data() + offset, right.data() + offset, std::min(blockSize, numSamples - offset));
+    
+    double maxError = 0.0, maxReference = 0.0;
+    for (int n = 0; n < numSamples; n += 11)
+    {
+        double expected = 0.0;
+        for (int k = 0; k < irLength && k <= n; ++k)
+            expected += (double) ir.getSample(1, k) * input[(size_t) (n - k)];
+        maxError = std::max(maxError, std::abs(right[(size_t) n] - expected));
+        maxReference = std::max(maxReference, std::abs(expected));
+    }
+    
+    // reset() из аудио-потока: поздний уровень сбрасывает worker, после него - снова точная IR
+    convolution.reset();
+    std::vector<float> impulseL((size_t) irLength, 0.0f), impulseR((size_t) irLength, 0.0f);
+    impulseL[0] = impulseR[0] = 1.0f;
+    for (int offset = 0; offset < irLength; offset += blockSize)
+        convolution.processStereo(impulseL.data() + offset, impulseR.data() + offset, std::min(blockSize, irLength - offset));
+    double impulseError = 0.0;
+    for (int i = 0; i < irLength; ++i)
+        impulseError = std::max(impulseError, (double) std::abs(impulseL[(size_t) i] - ir.getSample(0, i)));
+    
+    bool ok = maxError < 1.0e-4 * maxReference && impulseError < 1.0e-5 && convolution.getNumMissedSamples() == 0;
+    std::cout << "  " << (ok ? "✅" : "❌") << " Ошибка против прямой свёртки " << maxError / maxReference
+              << " (от пика), импульс после reset(): " << impulseError
+              << ", пропущено " << convolution.getNumMissedSamples() << " семплов\n";
+    
+    // Бенчмарк, блоки по 512 в темпе реального времени (информативно): callback с IR 10 сек
+    // должен стоить столько же, сколько с IR из одних ранних разбиений (8192)
+    juce::AudioBuffer<float> longIR(2, (int) (10.0 * spec.sampleRate));
+    for (int ch = 0; ch < 2; ++ch)
+        for (int i = 0; i < longIR.getNumSamples(); ++i)
+            longIR.setSample(ch, i, (random.nextFloat() - 0.5f) * std::exp(-7.0f * (float) i / longIR.getNumSamples()));
+    
+    const int numBlocks = 96;
+    const auto blockDuration = std::chrono::duration<double>(blockSize / spec.sampleRate);
+    std::vector<float> benchL((size_t) blockSize), benchR((size_t) blockSize);
+    
+    juce::AudioBuffer<float> earlyIR(2, PartitionedConvolution<float>::getLevelOffset(PartitionedConvolution<float>::LATE_LEVEL));
+    for (int ch = 0; ch < 2; ++ch)
+        earlyIR.copyFrom(ch, 0, longIR, ch, 0, earlyIR.getNumSamples());
+    
+    auto bench = [&] (const juce::AudioBuffer<float>& benchIR, double& worstBlockNs, int& missed)
+    {
+        PartitionedConvolution<float> longConvolution(benchIR);
+        
+        double totalNs = 0.0;
+        worstBlockNs = 0.0;
+        auto deadline = std::chrono::steady_clock::now();
+        for (int block = 0; block < numBlocks; ++block)
+        {
+            for (int i = 0; i < blockSize; ++i)
+                benchL[(size_t) i] = benchR[(size_t) i] = random.nextFloat() - 0.5f;
+            
+            auto start = std::chrono::steady_clock::now();
+            longConvolution.processStereo(benchL.data(), benchR.data(), blockSize);
+            const auto blockNs = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+            totalNs += blockNs;
+            worstBlockNs = std::max(worstBlockNs, blockNs / blockSize);
+            
+            deadline += std::chrono::duration_cast<std::chrono::steady_clock::duration>(blockDuration);
+            std::this_thread::sleep_until(deadline);
+        }
+        missed = longConvolution.getNumMissedSamples();
+        return totalNs / (numBlocks * blockSize);
+    };
+    
+    double worstLong = 0.0, worstEarly = 0.0;
+    int missedLong = 0, missedEarly = 0;
+    const auto longNs = bench(longIR, worstLong, missedLong);
+    const auto earlyNs = bench(earlyIR, worstEarly, missedEarly);
+    std::cout << "     Стерео, callback ns/семпл (среднее / худший блок): IR 10 сек " << longNs << " / " << worstLong
+              << " (пропущено " << missedLong << "), IR 8192 " << earlyNs << " / " << worstEarly << "\n";
+    
+    return ok;
+}
+
+// Тест 26: Автоматизация SpaceEngine - параметры ревербов меняются по семплу, а не по блоку
+bool testSpaceParameterMorphing()
+{
+    std::cout << "\nТест 26: Посемпловая автоматизация SpaceEngine (сеттеры только ставят цели)...\n";
+    
+    auto spec = createTestSpec();
+    juce::Random random(26);
+    
+    // FdnReverb, рампа 64: параметры каждые 64 семпла складываются в одну линейную кривую
+    // (wet = 0 - на выходе ровно dry * вход)
+    FdnReverb<float> reverb;
+    reverb.setRampLength(64);
+    FdnReverb<float>::Parameters params;
+    params.wetLevel = 0.0f;
+    params.dryLevel = 0.0f;
+    reverb.setParameters(params);
+    reverb.prepare(spec);  // рампы стартуют с заданных значений
+    
+    const int rampLength = 4096;
+    std::vector<float> left((size_t) rampLength, 1.0f), right((size_t) rampLength, 1.0f);
+    double rampError = 0.0;
+    for (int start = 0; start < rampLength; start += 64)
+    {
+        params.dryLevel = 0.5f * (float) (start + 64) / rampLength;
+        reverb.setParameters(params);
+        reverb.processStereo(left.data() + start, right.data() + start, 64);
+    }
+    for (int i = 0; i < rampLength; ++i)
+        rampError = std::max(rampError, std::abs(left[(size_t) i] - (double) (i + 1) / rampLength));
+    
+    // Сеттеры ничего не пересчитывают: параметры ревербов меняются только в process()
+    SpaceEngine<float> engine;
+    engine.prepare(spec);
+    engine.setGhost(0.6f);
+    engine.setDepth(0.3f);
+    auto block = createTestSignal((int) spec.maximumBlockSize, spec.sampleRate, 440.0f);
+    engine.process(block);
+    const auto tailBefore = engine.getTailLengthSeconds();
+    engine.setDepth(1.0f);
+    engine.setDepth(0.9f);
+    const auto tailAfterSetters = engine.getTailLengthSeconds();
+    engine.process(block);
+    const auto tailAfterProcess = engine.getTailLengthSeconds();
+    bool settersDeferred = tailAfterSetters == tailBefore && tailAfterProcess > tailBefore;
+    
+    // Автоматизация Ghost / Flow на границах 512: блоки по 512 и по 128 дают одно и то же -
+    // параметры идут по семплу, а не раз в блок хоста
+    SpaceEngine<float> large, small;
+    large.prepare(spec);
+    small.prepare(spec);
+    const int numSamples = 16384;
+    juce::AudioBuffer<float> largeBuffer(2, numSamples);
+    for (int ch = 0; ch < 2; ++ch)
+        for (int i = 0; i < numSamples; ++i)
+            largeBuffer.setSample(ch, i, random.nextFloat() - 0.5f);
+    juce::AudioBuffer<float> smallBuffer(largeBuffer);
+    
+    for (int start = 0; start < numSamples; start += 512)
+    {
+        const auto ghost = 0.2f + 0.7f * (float) ((start / 512) % 5) / 4.0f;
+        const auto flow = (float) ((start / 512) % 3) / 2.0f;
+        for (auto* space : { &large, &small })
+        {
+            space->setDepth(0.5f);
+            space->setGhost(ghost);
+            space->setFlow(flow);
+        }
+        
+        juce::AudioBuffer<float> largeBlock(largeBuffer.getArrayOfWritePointers(), 2, start, 512);
+        large.process(largeBlock);
+        for (int offset = start; offset < start + 512; offset += 128)
+        {
+            juce::AudioBuffer<float> smallBlock(smallBuffer.getArrayOfWritePointers(), 2, offset, 128);
+            small.process(smallBlock);
+        }
+    }
+    
+    double blockSizeError = 0.0;
+    for (int ch = 0; ch < 2; ++ch)
+        for (int i = 0; i < numSamples; ++i)
+            blockSizeError = std::max(blockSizeError, (double) std::abs(largeBuffer.getSample(ch, i) - smallBuffer.getSample(ch, i)));
+    
+    bool ok = rampError < 1.0e-5 && settersDeferred && blockSizeError < 1.0e-5;
+    std::cout << "  " << (ok ? "✅" : "❌") << " Отклонение рампы dry от прямой " << rampError
+              << ", сеттеры отложены: " << (settersDeferred ? "да" : "нет")
+              << ", разница блоков 512 / 128: " << blockSizeError << "\n";
+    
+    return ok;
+}
+
+// Тест 27: Предзадержка - кольцо под частоту, дробный глайд, неподвижная задержка точна
+bool testPredelayLine()
+{
+    std::cout << "\nТест 27: Предзадержка SpaceEngine при 192 кГц (маска, глайд, копирование блоком)...\n";
+    
+    const double sampleRate = 192000.0;
+    const int maxBlockSize = 512;
+    juce::Random random(27);
+    
+    // 120 мс при 192 кГц = 23040 семплов, блоки случайной длины (и длиннее обещанных)
+    PredelayLine<float> predelay;
+    const int longDelay = 23040;
+    predelay.prepare(sampleRate, 0.12, maxBlockSize);
+    predelay.setDelay(longDelay);
+    predelay.reset();  // без глайда
+    
+    const int numSamples = 3 * longDelay;
+    std::vector<float> input((size_t) numSamples);
+    for (auto& sample : input)
+        sample = random.nextFloat() - 0.5f;
+    
+    std::vector<float> left(input), right(input);
+    for (int offset = 0; offset < numSamples;)
+    {
+        const int length = std::min(1 + random.nextInt(2 * maxBlockSize), numSamples - offset);
+        predelay.processStereo(left.data() + offset, right.data() + offset, length);
+        offset += length;
+    }
+    
+    double staticError = 0.0;
+    for (int i = 0; i < numSamples; ++i)
+    {
+        const float expected = i >= longDelay ? input[(size_t) (i - longDelay)] : 0.0f;
+        staticError = std::max(staticError, (double) std::abs(left[(size_t) i] - expected));
+        staticError = std::max(staticError, (double) std::abs(right[(size_t) i] - expected));
+    }
+    
+    // Глайд 23040 -> 4000 на синусе 200 Гц: скорость чтения не выше 1 + MAX_GLIDE_RATE
+    // (шаг не больше, чем у так ускоренного синуса), длина глайда - по величине изменения,
+    // после глайда - снова точная целая задержка
+    const int shortDelay = 4000;
+    const double glideRate = PredelayLine<float>::MAX_GLIDE_RATE;
+    const int glideLength = (int) std::ceil((longDelay - shortDelay) / glideRate);
+    const int glideSamples = glideLength + 4 * maxBlockSize;
+    const double omega = 2.0 * juce::MathConstants<double>::pi * 200.0 / sampleRate;
+    std::vector<float> sine((size_t) glideSamples), delayed((size_t) glideSamples), dummy((size_t) glideSamples);
+    for (int i = 0; i < glideSamples; ++i)
+        sine[(size_t) i] = (float) std::sin(omega * (numSamples + i));
+    
+    predelay.reset();
+    std::vector<float> warmL((size_t) numSamples), warmR((size_t) numSamples);
+    for (int i = 0; i < numSamples; ++i)
+        warmL[(size_t) i] = warmR[(size_t) i] = (float) std::sin(omega * i);
+    for (int offset = 0; offset < numSamples; offset += maxBlockSize)
+        predelay.processStereo(warmL.data() + offset, warmR.data() + offset, std::min(maxBlockSize, numSamples - offset));
+    
+    predelay.setDelay(shortDelay);
+    delayed = sine;
+    dummy = sine;
+    for (int offset = 0; offset < glideSamples; offset += maxBlockSize)
+        predelay.processStereo(delayed.data() + offset, dummy.data() + offset, std::min(maxBlockSize, glideSamples - offset));
+    
+    const double speedUp = 1.0 + glideRate;
+    double maxStep = 0.0;
+    for (int i = 1; i < glideSamples; ++i)
+        maxStep = std::max(maxStep, (double) std::abs(delayed[(size_t) i] - delayed[(size_t) (i - 1)]));
+    const bool smoothGlide = maxStep < 1.05 * omega * speedUp;
+    
+    double settledError = 0.0;
+    for (int i = glideLength + 1; i < glideSamples; ++i)
+        settledError = std::max(settledError, std::abs(delayed[(size_t) i] - std::sin(omega * (numSamples + i - shortDelay))));
+    
+    // SpaceEngine при 192 кГц, Depth = 1: вход доходит до реверба ровно через 120 мс
+    // (плюс самая короткая линия FDN, 23 мс)
+    SpaceEngine<float> space;
+    juce::dsp::ProcessSpec spec { sampleRate, (juce::uint32) maxBlockSize, 2 };
+    space.setGhost(0.5f);
+    space.setDepth(1.0f);
+    space.prepare(spec);
+    
+    const int responseLength = (int) (0.2 * sampleRate);
+    juce::AudioBuffer<float> response(2, responseLength);
+    response.clear();
+    response.setSample(0, 0, 1.0f);
+    response.setSample(1, 0, 1.0f);
+    for (int offset = 0; offset < responseLength; offset += maxBlockSize)
+    {
+        juce::AudioBuffer<float> block(response.getArrayOfWritePointers(), 2, offset, std::min(maxBlockSize, responseLength - offset));
+        space.process(block);
+    }
+    
+    int firstOutput = -1;
+    for (int i = 0; i < responseLength && firstOutput < 0; ++i)
+        if (response.getSample(0, i) != 0.0f || response.getSample(1, i) != 0.0f)
+            firstOutput = i;
+    const double arrivalMs = 1000.0 * firstOutput / sampleRate;
+    const bool spaceDelayed = arrivalMs >= 143.0 && arrivalMs < 144.0;
+    
+    bool ok = staticError == 0.0 && smoothGlide && settledError < 1.0e-5 && spaceDelayed;
+    std::cout << "  " << (ok ? "✅" : "❌") << " Ошибка неподвижной задержки " << staticError
+              << ", шаг в глайде " << maxStep << " (предел " << 1.05 * omega * speedUp << ")"
+              << ", после глайда " << settledError << ", реверб вступает через " << arrivalMs << " мс\n";
+    
+    return ok;
+}
+
+// Тест 28: MixStage - векторное сведение против посемплового (dry * (1 - mix) + wet * mix) * output
+bool testMixStage()
+{
+    std::cout << "\nТест 28: MixStage против посемплового dry/wet и задержка dry...\n";
+    
+    auto spec = createTestSpec();
+    const int blockSize = (int) spec.maximumBlockSize;
+    juce::Random random(28);
+    
+    auto fillRandom = [&random](juce::AudioBuffer<float>& buffer)
+    {
+        for (int ch = 0; ch < buffer.getNumChannels(); ++ch)
+            for (int i = 0; i < buffer.getNumSamples(); ++i)
+                buffer.setSample(ch, i, random.nextFloat() * 2.0f - 1.0f);
+    };
+    
+    // Рампа mix / output внутри блоков, затем постоянные коэффициенты (быстрый путь)
+    auto compareMix = [&](float mixFrom, float outputFrom, float mixTo, float outputTo, bool& usedFastPath)
+    {
+        MixStage<float> stage;
+        stage.prepare(spec, 0);
+        stage.reset(mixFrom, outputFrom);
+        stage.setTargets(mixTo, outputTo);
+        
+        juce::LinearSmoothedValue<float> mixReference, outputReference;
+        mixReference.reset(spec.sampleRate, 0.03);
+        outputReference.reset(spec.sampleRate, 0.03);
+        mixReference.setCurrentAndTargetValue(mixFrom);
+        outputReference.setCurrentAndTargetValue(outputFrom);
+        mixReference.setTargetValue(mixTo);
+        outputReference.setTargetValue(outputTo);
+        
+        double maxError = 0.0;
+        usedFastPath = false;
+        juce::AudioBuffer<float> wet(2, blockSize), dry(2, blockSize);
+        
+        for (int block = 0; block < 6; ++block)
+        {
+            fillRandom(wet);
+            fillRandom(dry);
+            juce::AudioBuffer<float> expected(wet);
+            usedFastPath = usedFastPath || ! mixReference.isSmoothing();
+            
+            for (int i = 0; i < blockSize; ++i)
+            {
+                const auto mix = mixReference.getNextValue();
+                const auto output = outputReference.getNextValue();
+                for (int ch = 0; ch < 2; ++ch)
+                    expected.setSample(ch, i, (dry.getSample(ch, i) * (1.0f - mix) + wet.getSample(ch, i) * mix) * output);
+            }
+            
+            stage.process(wet, dry);
+            for (int ch = 0; ch < 2; ++ch)
+                for (int i = 0; i < blockSize; ++i)
+                    maxError = std::max(maxError, (double) std::abs(wet.getSample(ch, i) - expected.getSample(ch, i)));
+        }
+        
+        return maxError;
+    };
+    
+    bool rampReachedFastPath = false, constantFastPath = false;
+    const auto rampError = compareMix(0.2f, 1.0f, 0.8f, 0.5f, rampReachedFastPath);
+    const auto constantError = compareMix(0.3f, 1.2f, 0.3f, 1.2f, constantFastPath);
+    
+    // Задержка dry = задержке wet-цепочки; блоки короче и длиннее задержки, вперемешку
+    // delayDry (dry слышен) и pushDry (не слышен) - кольцо не теряет позицию
+    const int latency = 300;
+    MixStage<float> stage;
+    stage.prepare(spec, latency);
+    
+    const int numSamples = 8192;
+    std::vector<float> input((size_t) numSamples);
+    for (auto& sample : input)
+        sample = random.nextFloat() - 0.5f;
+    
+    double delayError = 0.0;
+    const int blockSizes[] = { 64, 512, 300, 17, 1000, 128 };
+    for (int offset = 0, index = 0; offset < numSamples; ++index)
+    {
+        const int length = std::min(blockSizes[index % 6], numSamples - offset);
+        juce::AudioBuffer<float> dry(2, length);
+        for (int ch = 0; ch < 2; ++ch)
+            std::copy(input.begin() + offset, input.begin() + offset + length, dry.getWritePointer(ch));
+        
+        if (index % 4 == 3)
+        {
+            stage.pushDry(dry);
+        }
+        else
+        {
+            stage.delayDry(dry);
+            for (int ch = 0; ch < 2; ++ch)
+                for (int i = 0; i < length; ++i)
+                {
+                    const int source = offset + i - latency;
+                    const float expected = source >= 0 ? input[(size_t) source] : 0.0f;
+                    delayError = std::max(delayError, (double) std::abs(dry.getSample(ch, i) - expected));
+                }
+        }
+        offset += length;
+    }
+    
+    bool ok = rampError < 1.0e-6 && rampReachedFastPath && constantError < 1.0e-6 && constantFastPath
+           && delayError == 0.0 && stage.getLatencySamples() == latency;
+    std::cout << "  " << (ok ? "✅" : "❌") << " Рампа: ошибка " << rampError << ", постоянные коэффициенты: "
+              << constantError << ", задержка dry " << latency << " семплов: ошибка " << delayError << "\n";
+    
+    return ok;
+}
+
+// Тест 29: Автоматизация на суб-блоках - интерполяция снимка параметров и разбиение блока хоста
+bool testAutomationSubBlocks()
+{
+    std::cout << "\nТест 29: Автоматизация: интерполяция ParameterSnapshot и суб-блоки...\n";
+    
+    // Clarity (-0.5..0.5) и Output (0..2) в снимке нормированы - интерполируются в 0..1,
+    // что для линейных диапазонов совпадает с интерполяцией в их единицах
+    juce::NormalisableRange<float> clarityRange(-0.5f, 0.5f), outputRange(0.0f, 2.0f);
+    ParameterSnapshot from, to;
+    from.flow = 0.1f;  from.melt = 0.2f;  from.ghost = 0.3f;  from.depth = 0.4f;  from.gravity = 0.5f;
+    from.energy = 0.6f;  from.mix = 0.7f;
+    from.clarity = clarityRange.convertTo0to1(-0.4f);
+    from.output = outputRange.convertTo0to1(0.5f);
+    to.flow = 0.9f;  to.melt = 0.0f;  to.ghost = 1.0f;  to.depth = 0.2f;  to.gravity = 0.5f;
+    to.energy = 0.0f;  to.mix = 1.0f;
+    to.clarity = clarityRange.convertTo0to1(0.2f);
+    to.output = outputRange.convertTo0to1(1.5f);
+    
+    const auto start = from.interpolatedTowards(to, 0.0f);
+    const auto middle = from.interpolatedTowards(to, 0.5f);
+    const auto end = from.interpolatedTowards(to, 1.0f);
+    
+    auto near = [](float a, float b) { return std::abs(a - b) < 1.0e-6f; };
+    bool interpolates = start == from && end == to
+        && near(middle.flow, 0.5f) && near(middle.melt, 0.1f) && near(middle.ghost, 0.65f)
+        && near(middle.depth, 0.3f) && near(middle.gravity, 0.5f) && near(middle.energy, 0.3f)
+        && near(middle.mix, 0.85f)
+        && near(clarityRange.convertFrom0to1(middle.clarity), -0.1f)
+        && near(outputRange.convertFrom0to1(middle.output), 1.0f)
+        && from != to && middle != to;
+    
+    // Блок хоста с изменившимися параметрами: numSamples / MIN суб-блоков, равные шаги целей
+    const int minSubBlock = ParameterSnapshot::MIN_AUTOMATION_SUB_BLOCK;
+    bool splits = true;
+    
+    for (int numSamples : { 512, 500, 1000, 97, 31 })
+    {
+        const int numSubBlocks = ParameterSnapshot::getNumSubBlocks(numSamples, 512, true);
+        splits = splits && numSubBlocks == std::max(numSamples / minSubBlock, (numSamples + 511) / 512);
+        
+        int previousEnd = 0, shortest = numSamples, longest = 0;
+        float previousDepth = from.depth;
+        double firstStep = 0.0, worstStepError = 0.0;
+        
+        for (int index = 0; index < numSubBlocks; ++index)
+        {
+            const int subBlockEnd = ParameterSnapshot::getSubBlockEnd(numSamples, numSubBlocks, index);
+            shortest = std::min(shortest, subBlockEnd - previousEnd);
+            longest = std::max(longest, subBlockEnd - previousEnd);
+            
+            // Цель суб-блока - значение автоматизации на его конце
+            const auto target = from.interpolatedTowards(to, (float) subBlockEnd / (float) numSamples);
+            const double step = (double) (target.depth - previousDepth) / (subBlockEnd - previousEnd);
+            if (index == 0)
+                firstStep = step;
+            worstStepError = std::max(worstStepError, std::abs(step - firstStep));
+            
+            previousDepth = target.depth;
+            previousEnd = subBlockEnd;
+        }
+        
+        // Последний суб-блок доходит до новых значений; куски не короче минимума (если блок не короче)
+        splits = splits && previousEnd == numSamples && near(previousDepth, to.depth)
+              && longest - shortest <= 1 && (numSamples < minSubBlock || shortest >= minSubBlock)
+              && worstStepError < 1.0e-6;
+    }
+    
+    // Без автоматизации - только по размеру scratch-буферов
+    splits = splits && ParameterSnapshot::getNumSubBlocks(512, 512, false) == 1
+                    && ParameterSnapshot::getNumSubBlocks(1000, 256, false) == 4
+                    && ParameterSnapshot::getNumSubBlocks(512, 512, true) == 512 / minSubBlock;
+    
+    bool ok = interpolates && splits;
+    std::cout << "  " << (ok ? "✅" : "❌") << " Интерполяция 0 / 0.5 / 1: " << (interpolates ? "да" : "нет")
+              << ", суб-блоки по " << minSubBlock << "+ с равными шагами: " << (splits ? "да" : "нет") << "\n";
+    
+    return ok;
+}
+
+// Тест 30: Рампа Depth к нулю не щёлкает в блоке, где она заканчивается
+bool testSpectralEqRampToUnity()
+{
+    std::cout << "\nТест 30: SpectralEngine - Depth 0.099 -> 0 без скачка в конце рампы...\n";
+    
+    SpectralEngine<float> engine;
+    auto spec = createTestSpec();
+    engine.setClarity(0.0f);
+    engine.setFlow(0.0f);
+    engine.setDepth(0.099f);  // low-mid bell включён, всё остальное - единичное
+    engine.prepare(spec);
+    
+    const int blockSize = (int) spec.maximumBlockSize;
+    const int settleSamples = 64 * blockSize;
+    const int rampSamples = 16 * blockSize;  // рампа 30 мс кончается посреди блока
+    auto signal = createTestSignal(settleSamples + rampSamples, spec.sampleRate, 400.0f);
+    
+    for (int offset = 0; offset < signal.getNumSamples(); offset += blockSize)
+    {
+        if (offset == settleSamples)
+            engine.setDepth(0.0f);
+        
+        juce::AudioBuffer<float> block(signal.getArrayOfWritePointers(), 2, offset, blockSize);
+        engine.process(block);
+    }
+    
+    // Вторая разность синуса амплитуды A - A * omega^2; запас на bell (меньше 1 дБ) и шаги
+    // коэффициентов каждые EQ_SUB_BLOCK_SIZE. Сброс ненулевого TDF2 даёт в десятки раз больше
+    const double omega = 2.0 * juce::MathConstants<double>::pi * 400.0 / spec.sampleRate;
+    const double limit = 2.0 * 0.5 * omega * omega;
+    double maxSecondDifference = 0.0;
+    int worstSample = 0;
+    
+    for (int ch = 0; ch < 2; ++ch)
+    {
+        const auto* data = signal.getReadPointer(ch);
+        for (int i = settleSamples / 2; i < signal.getNumSamples(); ++i)
+        {
+            const double secondDifference = std::abs(data[i] - 2.0 * data[i - 1] + data[i - 2]);
+            if (secondDifference > maxSecondDifference)
+            {
+                maxSecondDifference = secondDifference;
+                worstSample = i;
+            }
+        }
+    }
+    
+    bool ok = maxSecondDifference < limit;
+    std::cout << "  " << (ok ? "✅" : "❌") << " Наибольшая вторая разность " << maxSecondDifference
+              << " (семпл " << worstSample << ", предел " << limit << ")\n";
+    
+    return ok;
+}
+
 int main()
 {
     std::cout << "========================================\n";
@@ -370,7 +2302,7 @@ int main()
     std::cout << "========================================\n\n";
     
     int passed = 0;
-    int total = 6;
+    int total = 30;
     
     if (testSpectralClarity()) passed++;
     if (testSpaceReverb()) passed++;
@@ -378,6 +2310,30 @@ int main()
     if (testNoClips()) passed++;
     if (testMonoCompatibility()) passed++;
     if (testParameterSmoothing()) passed++;
+    if (testDoublePrecisionMatchesFloat()) passed++;
+    if (testStageGate()) passed++;
+    if (testSpaceTail()) passed++;
+    if (testStageProfiler()) passed++;
+    if (testTripleBuffer()) passed++;
+    if (testRealtimeSafety()) passed++;
+    if (testStreamingSTFT()) passed++;
+    if (testBinRemapTables()) passed++;
+    if (testStereoPackedFFT()) passed++;
+    if (testLatencyTiers()) passed++;
+    if (testBiquadCoefficientTable()) passed++;
+    if (testBiquadCascade()) passed++;
+    if (testBackgroundSTFT()) passed++;
+    if (testSplitBandFormant()) passed++;
+    if (testEnvelopeFormantShift()) passed++;
+    if (testSpectralAnalyzer()) passed++;
+    if (testFdnReverb()) passed++;
+    if (testConvolutionReverb()) passed++;
+    if (testLateConvolutionWorker()) passed++;
+    if (testSpaceParameterMorphing()) passed++;
+    if (testPredelayLine()) passed++;
+    if (testMixStage()) passed++;
+    if (testAutomationSubBlocks()) passed++;
+    if (testSpectralEqRampToUnity()) passed++;
     
     std::cout << "\n========================================\n";
     std::cout << "Результаты: " << passed << "/" << total << " тестов пройдено\n";